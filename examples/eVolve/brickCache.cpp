@@ -0,0 +1,232 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "brickCache.h"
+
+#include <lunchbox/debug.h>
+#include <lunchbox/scopedMutex.h>
+
+#include <cstring>
+
+namespace eVolve
+{
+namespace
+{
+const uint32_t STOP = LB_UNDEFINED_UINT32; // prefetcher exit request
+}
+
+BrickCache::BrickCache( const std::string& filename, const size_t maxSize )
+        : _bricks( 0 )
+        , _brickBytes( 0 )
+        , _nX( 0 )
+        , _nY( 0 )
+        , _nZ( 0 )
+        , _size( 0 )
+        , _maxSize( maxSize )
+        , _hits( 0 )
+        , _misses( 0 )
+        , _prefetcher( *this )
+{
+    ::memset( &_header, 0, sizeof( _header ));
+
+    const uint8_t* addr = static_cast< const uint8_t* >( _map.map( filename ));
+    if( !addr || _map.getSize() < BRICK_DATA_OFFSET )
+        return;
+
+    BrickHeader header;
+    ::memcpy( &header, addr, sizeof( header ));
+    if( ::memcmp( header.magic, BRICK_MAGIC, sizeof( BRICK_MAGIC )) != 0 ||
+        header.version != BRICK_VERSION || header.brickSize == 0 )
+    {
+        LBWARN << "Not a bricked volume: " << filename << std::endl;
+        _map.unmap();
+        return;
+    }
+
+    const uint32_t size = header.brickSize;
+    _nX = ( header.w + size - 1 ) / size;
+    _nY = ( header.h + size - 1 ) / size;
+    _nZ = ( header.d + size - 1 ) / size;
+    _brickBytes = size_t( size ) * size * size * header.bytes;
+
+    if( _map.getSize() < BRICK_DATA_OFFSET +
+                         size_t( _nX ) * _nY * _nZ * _brickBytes )
+    {
+        LBWARN << "Truncated bricked volume: " << filename << std::endl;
+        _map.unmap();
+        return;
+    }
+
+    _header = header;
+    _bricks = addr + BRICK_DATA_OFFSET;
+    _prefetcher.start();
+}
+
+BrickCache::~BrickCache()
+{
+    if( isValid( ))
+    {
+        _requests.push( STOP );
+        _prefetcher.join();
+    }
+    _map.unmap();
+}
+
+void BrickCache::readSlab( const uint32_t start, const uint32_t depth,
+                           const uint32_t tW, const uint32_t tH,
+                           uint8_t* data )
+{
+    LBASSERT( isValid( ));
+    LBASSERT( tW >= _header.w && tH >= _header.h );
+    LBASSERT( start + depth <= _header.d );
+    if( depth == 0 )
+        return;
+
+    const uint32_t size = _header.brickSize;
+    const uint32_t bytes = _header.bytes;
+    const uint32_t end = start + depth;
+    const size_t rowBytes = size_t( tW ) * bytes;
+    const size_t sliceBytes = rowBytes * tH;
+
+    lunchbox::ScopedMutex<> mutex( _lock );
+    for( uint32_t bz = start / size; bz <= ( end - 1 ) / size; ++bz )
+    {
+        const uint32_t z0 = LB_MAX( start, bz * size );
+        const uint32_t z1 = LB_MIN( end, ( bz + 1 ) * size );
+
+        for( uint32_t by = 0; by < _nY; ++by )
+        {
+            const uint32_t y0 = by * size;
+            const uint32_t y1 = LB_MIN( _header.h, y0 + size );
+
+            for( uint32_t bx = 0; bx < _nX; ++bx )
+            {
+                const uint32_t x0 = bx * size;
+                const size_t width =
+                    size_t( LB_MIN( _header.w, x0 + size ) - x0 ) * bytes;
+                const uint8_t* brick = _getBrick( ( bz * _nY + by ) * _nX +
+                                                  bx );
+                for( uint32_t z = z0; z < z1; ++z )
+                    for( uint32_t y = y0; y < y1; ++y )
+                    {
+                        const size_t offset = (( z - bz * size ) * size +
+                                               ( y - y0 )) * size;
+                        ::memcpy( data + ( z - start ) * sliceBytes +
+                                  y * rowBytes + size_t( x0 ) * bytes,
+                                  brick + offset * bytes, width );
+                    }
+            }
+        }
+    }
+}
+
+void BrickCache::prefetch( const uint32_t start, const uint32_t depth )
+{
+    LBASSERT( isValid( ));
+    if( depth == 0 || start >= _header.d )
+        return;
+
+    const uint32_t size = _header.brickSize;
+    const uint32_t end = LB_MIN( start + depth, _header.d );
+    const uint32_t layer = _nX * _nY;
+
+    for( uint32_t bz = start / size; bz <= ( end - 1 ) / size; ++bz )
+        for( uint32_t i = 0; i < layer; ++i )
+            _requests.push( bz * layer + i );
+}
+
+const uint8_t* BrickCache::_getBrick( const uint32_t index )
+{
+    BricksIter i = _cache.find( index );
+    if( i == _cache.end( ))
+    {
+        ++_misses;
+        std::vector< uint8_t > data;
+        _load( index, data );
+        i = _insert( index, data );
+    }
+    else
+    {
+        ++_hits;
+        _lru.splice( _lru.begin(), _lru, i->second.lru );
+    }
+    return &i->second.data.front();
+}
+
+BrickCache::BricksIter BrickCache::_insert( const uint32_t index,
+                                            std::vector< uint8_t >& data )
+{
+    while( _size + data.size() > _maxSize && !_lru.empty( ))
+    {
+        BricksIter lru = _cache.find( _lru.back( ));
+        LBASSERT( lru != _cache.end( ));
+        _size -= lru->second.data.size();
+        _cache.erase( lru );
+        _lru.pop_back();
+    }
+
+    BricksIter i = _cache.insert( std::make_pair( index, Brick( ))).first;
+    i->second.data.swap( data );
+    _lru.push_front( index );
+    i->second.lru = _lru.begin();
+    _size += i->second.data.size();
+    return i;
+}
+
+void BrickCache::_load( const uint32_t index,
+                        std::vector< uint8_t >& data ) const
+{
+    const uint8_t* brick = _bricks + size_t( index ) * _brickBytes;
+    data.assign( brick, brick + _brickBytes );
+}
+
+void BrickCache::Prefetcher::run()
+{
+    for( ;; )
+    {
+        const uint32_t index = _cache._requests.pop();
+        if( index == STOP )
+            return;
+
+        {
+            lunchbox::ScopedMutex<> mutex( _cache._lock );
+            if( _cache._cache.find( index ) != _cache._cache.end( ))
+                continue;
+        }
+
+        // page in the brick without blocking readSlab
+        std::vector< uint8_t > data;
+        _cache._load( index, data );
+
+        lunchbox::ScopedMutex<> mutex( _cache._lock );
+        if( _cache._cache.find( index ) == _cache._cache.end( ))
+            _cache._insert( index, data );
+    }
+}
+
+}
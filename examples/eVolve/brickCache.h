@@ -0,0 +1,146 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVOLVE_BRICK_CACHE_H
+#define EVOLVE_BRICK_CACHE_H
+
+#include "brickFile.h"
+
+#include <lunchbox/lock.h>
+#include <lunchbox/memoryMap.h>
+#include <lunchbox/mtQueue.h>
+#include <lunchbox/referenced.h>
+#include <lunchbox/refPtr.h>
+#include <lunchbox/thread.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace eVolve
+{
+    /**
+     * Out-of-core access to a bricked volume file.
+     *
+     * The file is memory-mapped and the bricks used to assemble depth slabs
+     * are kept in a LRU cache of a fixed byte size. Bricks adjacent to an
+     * assembled slab may be prefetched by a background thread.
+     */
+    class BrickCache : public lunchbox::Referenced
+    {
+    public:
+        /** Open the given bricked volume, caching up to maxSize bytes. */
+        BrickCache( const std::string& filename, const size_t maxSize );
+
+        /** @return true if the bricked volume file was opened successfully */
+        bool isValid() const { return _header.brickSize != 0; }
+
+        const BrickHeader& getHeader() const { return _header; }
+
+        /**
+         * Copy the slices [start, start+depth) of the volume into data.
+         *
+         * The destination slab has a width and height of tW and tH voxels,
+         * the volume is placed at its origin. Bricks not in the cache are
+         * loaded synchronously.
+         */
+        void readSlab( const uint32_t start, const uint32_t depth,
+                       const uint32_t tW, const uint32_t tH, uint8_t* data );
+
+        /** Load the bricks of the given slices asynchronously. */
+        void prefetch( const uint32_t start, const uint32_t depth );
+
+        /** @return the number of bricks found in the cache by readSlab. */
+        size_t getHits() const { return _hits; }
+
+        /** @return the number of bricks loaded synchronously by readSlab. */
+        size_t getMisses() const { return _misses; }
+
+        /** @return the number of bytes currently cached. */
+        size_t getSize() const { return _size; }
+
+    protected:
+        virtual ~BrickCache();
+
+    private:
+        typedef std::list< uint32_t > LRU;
+        typedef LRU::iterator LRUIter;
+
+        struct Brick
+        {
+            std::vector< uint8_t > data;
+            LRUIter lru; //!< position in the LRU list
+        };
+        typedef std::map< uint32_t, Brick > Bricks;
+        typedef Bricks::iterator BricksIter;
+
+        class Prefetcher : public lunchbox::Thread
+        {
+        public:
+            Prefetcher( BrickCache& cache ) : _cache( cache ) {}
+            virtual void run();
+
+        private:
+            BrickCache& _cache;
+        };
+
+        lunchbox::MemoryMap _map;
+        BrickHeader _header;
+        const uint8_t* _bricks; //!< mapped brick data
+        size_t _brickBytes;
+        uint32_t _nX;
+        uint32_t _nY;
+        uint32_t _nZ;
+
+        lunchbox::Lock _lock; //!< protects the members below
+        Bricks _cache;
+        LRU _lru; //!< most recently used first
+        size_t _size;
+        const size_t _maxSize;
+        size_t _hits;
+        size_t _misses;
+
+        Prefetcher _prefetcher;
+        lunchbox::MTQueue< uint32_t > _requests; //!< bricks to prefetch
+
+        /** @return the cached brick, loading it if needed. Needs _lock. */
+        const uint8_t* _getBrick( const uint32_t index );
+
+        /** Insert a loaded brick into the cache, evicting LRU bricks. */
+        BricksIter _insert( const uint32_t index,
+                            std::vector< uint8_t >& data );
+
+        /** Copy a brick from the mapped file. */
+        void _load( const uint32_t index, std::vector< uint8_t >& data ) const;
+    };
+
+    typedef lunchbox::RefPtr< BrickCache > BrickCachePtr;
+}
+
+#endif // EVOLVE_BRICK_CACHE_H
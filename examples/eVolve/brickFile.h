@@ -0,0 +1,59 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVOLVE_BRICK_FILE_H
+#define EVOLVE_BRICK_FILE_H
+
+#include <lunchbox/types.h>
+
+namespace eVolve
+{
+    /** Header of a bricked volume file (<model>.raw.bricks).
+     *
+     * The header is followed, at BRICK_DATA_OFFSET, by cubic bricks of
+     * brickSize^3 voxels with 'bytes' bytes each. The bricks are stored in
+     * z, y, x order, voxels outside of the volume are zero.
+     */
+    struct BrickHeader
+    {
+        char     magic[4];  //!< BRICK_MAGIC
+        uint32_t version;   //!< BRICK_VERSION
+        uint32_t w;         //!< volume width
+        uint32_t h;         //!< volume height
+        uint32_t d;         //!< volume depth
+        uint32_t bytes;     //!< bytes per voxel, 4 for raw+derivatives
+        uint32_t brickSize; //!< edge length of a brick in voxels
+    };
+
+    static const char     BRICK_MAGIC[4] = { 'E', 'V', 'B', 'R' };
+    static const uint32_t BRICK_VERSION = 1;
+    static const uint32_t BRICK_SIZE = 64;
+    static const size_t   BRICK_DATA_OFFSET = 4096; //!< page-aligned bricks
+}
+
+#endif // EVOLVE_BRICK_FILE_H
@@ -36,6 +36,7 @@ namespace eVolve
 using hlpFuncs::clip;
 using hlpFuncs::hFile;
 
+static const size_t BRICK_CACHE_SIZE = 512 * LB_1MB;
 
 static GLuint createPreintegrationTable( const uint8_t* Table );
 
@@ -91,6 +92,23 @@ bool RawVolumeModel::loadHeader( const float brightness, const float alpha )
 
     _resolution = LB_MAX( _w, LB_MAX( _h, _d ) );
 
+    // use the bricked volume written by eVolveConverter --bricks, if present
+    const std::string bricksName = _filename + ".bricks";
+    if( hFile( fopen( bricksName.c_str(), "rb" )).f )
+    {
+        _bricks = new BrickCache( bricksName, BRICK_CACHE_SIZE );
+        const BrickHeader& bricks = _bricks->getHeader();
+        if( !_bricks->isValid() || bricks.w != _w || bricks.h != _h ||
+            bricks.d != _d || bricks.bytes != ( _hasDerivatives ? 4u : 1u ))
+        {
+            LBWARN << "Ignoring incompatible bricked volume " << bricksName
+                   << std::endl;
+            _bricks = 0;
+        }
+        else
+            LBLOG( eq::LOG_CUSTOM ) << "Using " << bricksName << std::endl;
+    }
+
     if( !readTransferFunction( header.f, _TF ))
         return false;
 
@@ -249,40 +267,53 @@ bool RawVolumeModel::_createVolumeTexture(        GLuint&    volume,
 
     // Reading of requested part of a volume
     std::vector<uint8_t> data( _tW*_tH*_tD*bytes, 0 );
-    const uint32_t  wh4 =   w *   h * bytes;
-    const uint32_t tWH4 = _tW * _tH * bytes;
-
-    std::ifstream file ( _filename.c_str(), std::ifstream::in |
-                         std::ifstream::binary | std::ifstream::ate );
-
-    if( !file.is_open() )
+    if( _bricks )
     {
-        LBERROR << "Can't open model data file";
-        return false;
-    }
+        _bricks->readSlab( start, depth, _tW, _tH, &data[0] );
 
-    file.seekg( wh4*start, std::ios::beg );
-
-    if( w==_tW && h==_tH ) // width and height are power of 2
-    {
-        file.read( (char*)( &data[0] ), wh4*depth );
-    }
-    else if( w==_tW )     // only width is power of 2
-    {
-        for( uint32_t i=0; i<depth; i++ )
-            file.read( (char*)( &data[i*tWH4] ), wh4 );
+        // prefetch the neighbouring slices for small range changes
+        const uint32_t size = _bricks->getHeader().brickSize;
+        _bricks->prefetch( start > size ? start - size : 0,
+                           LB_MIN( start, size ));
+        _bricks->prefetch( end + 1, size );
     }
     else
-    {               // nor width nor heigh is power of 2
-        const uint32_t   w4 =   w * bytes;
-        const uint32_t  tW4 = _tW * bytes;
+    {
+        const uint32_t  wh4 =   w *   h * bytes;
+        const uint32_t tWH4 = _tW * _tH * bytes;
 
-        for( uint32_t i=0; i<depth; i++ )
-            for( uint32_t j=0; j<h; j++ )
-                file.read( (char*)( &data[ i*tWH4 + j*tW4] ), w4 );
-    }
+        std::ifstream file ( _filename.c_str(), std::ifstream::in |
+                             std::ifstream::binary | std::ifstream::ate );
 
-    file.close();
+        if( !file.is_open() )
+        {
+            LBERROR << "Can't open model data file";
+            return false;
+        }
+
+        file.seekg( wh4*start, std::ios::beg );
+
+        if( w==_tW && h==_tH ) // width and height are power of 2
+        {
+            file.read( (char*)( &data[0] ), wh4*depth );
+        }
+        else if( w==_tW )     // only width is power of 2
+        {
+            for( uint32_t i=0; i<depth; i++ )
+                file.read( (char*)( &data[i*tWH4] ), wh4 );
+        }
+        else
+        {               // nor width nor heigh is power of 2
+            const uint32_t   w4 =   w * bytes;
+            const uint32_t  tW4 = _tW * bytes;
+
+            for( uint32_t i=0; i<depth; i++ )
+                for( uint32_t j=0; j<h; j++ )
+                    file.read( (char*)( &data[ i*tWH4 + j*tW4] ), w4 );
+        }
+
+        file.close();
+    }
 
     LBASSERT( _glewContext );
     // create 3D texture
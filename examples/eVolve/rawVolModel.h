@@ -29,6 +29,8 @@
 #ifndef EVOLVE_RAW_VOL_MODEL_H
 #define EVOLVE_RAW_VOL_MODEL_H
 
+#include "brickCache.h"
+
 #include <eq/eq.h>
 
 namespace eVolve
@@ -135,6 +137,8 @@ namespace eVolve
 
         bool _hasDerivatives;           //!< true if raw+der used
 
+        BrickCachePtr _bricks;          //!< bricked volume, if available
+
         const GLEWContext*   _glewContext;    //!< OpenGL function table
     };
 
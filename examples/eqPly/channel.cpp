@@ -139,7 +139,12 @@ void Channel::frameDraw( const eq::uint128_t& frameID )
         state.setFrustumCulling( false ); // create all display lists/VBOs
 
     if( model )
+    {
+        Config* config = static_cast< Config* >( getConfig( ));
+        config->loadModelRange( _modelID, getRange(),
+                                getPipe()->getCurrentFrame( ));
         _updateNearFar( model->getBoundingSphere( ));
+    }
 
     // Setup OpenGL state
     eq::Channel::frameDraw( frameID );
@@ -166,6 +166,8 @@ void Config::_loadModels()
 
             if( _initData.useInvertedFaces() )
                 model->useInvertedFaces();
+            if( _initData.useOptimizedData( ))
+                model->useOptimizedData();
         
             if( !model->readFromFile( filename.c_str( )))
             {
@@ -282,15 +284,44 @@ const Model* Config::getModel( const eq::uint128_t& modelID )
             return _models[ i ];
     }
     
-    _modelDist.push_back( new ModelDist );
-    Model* model = _modelDist.back()->loadModel( getApplicationNode(),
-                                                 getClient(), modelID );
+    ModelDist* dist = new ModelDist;
+    _modelDist.push_back( dist );
+    Model* model = dist->loadModel( getApplicationNode(), getClient(), modelID);
     LBASSERT( model );
     _models.push_back( model );
 
+    // load all data now, otherwise the channels load their range on demand
+    if( model && !_initData.useRangeLoading( ))
+        dist->loadRange( getApplicationNode(), getClient(), eq::Range::ALL, 0 );
+
     return model;
 }
 
+void Config::loadModelRange( const eq::uint128_t& modelID,
+                             const eq::Range& range, const uint32_t frame )
+{
+    if( modelID == eq::UUID::ZERO || !_initData.useRangeLoading( ))
+        return;
+
+    // Protect against the pipe threads and the node thread evicting data
+    lunchbox::ScopedMutex<> _mutex( &_modelLock );
+
+    // no-op on the application node, which has all data loaded
+    for( ModelDistsCIter i = _modelDist.begin(); i != _modelDist.end(); ++i )
+        if( (*i)->getID() == modelID )
+            (*i)->loadRange( getApplicationNode(), getClient(), range, frame );
+}
+
+void Config::evictModelData( const uint32_t frame )
+{
+    if( !_initData.useRangeLoading( ))
+        return;
+
+    lunchbox::ScopedMutex<> _mutex( &_modelLock );
+    for( ModelDistsCIter i = _modelDist.begin(); i != _modelDist.end(); ++i )
+        (*i)->evict( frame );
+}
+
 uint32_t Config::startFrame()
 {
     _updateData();
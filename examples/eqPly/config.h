@@ -72,6 +72,13 @@ namespace eqPly
         /** @return the requested, default model or 0. */
         const Model* getModel( const eq::uint128_t& id );
 
+        /** Load the data of the given model drawn for the given range. */
+        void loadModelRange( const eq::uint128_t& id, const eq::Range& range,
+                             const uint32_t frame );
+
+        /** Evict unused model data after all pipes finished the frame. */
+        void evictModelData( const uint32_t frame );
+
         /** @sa eq::Config::handleEvent */
         virtual bool handleEvent( const eq::ConfigEvent* event );
 
@@ -56,6 +56,8 @@ InitData::InitData()
         , _invFaces( false )
         , _logo( true )
         , _roi ( true )
+        , _rangeLoading( false )
+        , _optimizeData( false )
 {}
 
 InitData::~InitData()
@@ -66,13 +68,13 @@ InitData::~InitData()
 void InitData::getInstanceData( co::DataOStream& os )
 {
     os << _frameDataID << _windowSystem << _renderMode << _useGLSL << _invFaces
-       << _logo << _roi;
+       << _logo << _roi << _rangeLoading << _optimizeData;
 }
 
 void InitData::applyInstanceData( co::DataIStream& is )
 {
     is >> _frameDataID >> _windowSystem >> _renderMode >> _useGLSL >> _invFaces
-       >> _logo >> _roi;
+       >> _logo >> _roi >> _rangeLoading >> _optimizeData;
     LBASSERT( _frameDataID != eq::UUID::ZERO );
 }
 
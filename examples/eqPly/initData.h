@@ -50,6 +50,8 @@ namespace eqPly
         bool               useInvertedFaces() const { return _invFaces; }
         bool               showLogo() const         { return _logo; }
         bool               useROI() const           { return _roi; }
+        bool               useRangeLoading() const  { return _rangeLoading; }
+        bool               useOptimizedData() const { return _optimizeData; }
 
     protected:
         virtual void getInstanceData( co::DataOStream& os );
@@ -63,6 +65,8 @@ namespace eqPly
         void enableInvertedFaces() { _invFaces = true; }
         void disableLogo()         { _logo     = false; }
         void disableROI()          { _roi      = false; }
+        void enableRangeLoading()  { _rangeLoading = true; }
+        void enableOptimizedData() { _optimizeData = true; }
 
     private:
         eq::uint128_t    _frameDataID;
@@ -72,6 +76,8 @@ namespace eqPly
         bool             _invFaces;
         bool             _logo;
         bool             _roi;
+        bool             _rangeLoading;
+        bool             _optimizeData;
     };
 }
 
@@ -77,6 +77,10 @@ const LocalInitData& LocalInitData::operator = ( const LocalInitData& from )
         disableLogo();
     if( !from.useROI( ))
         disableROI();
+    if( from.useRangeLoading( ))
+        enableRangeLoading();
+    if( from.useOptimizedData( ))
+        enableOptimizedData();
 
     return *this;
 }
@@ -141,6 +145,12 @@ void LocalInitData::parseArguments( const int argc, char** argv )
                         command );
         TCLAP::SwitchArg roiArg( "d", "disableROI", "Disable ROI", command,
                                  false );
+        TCLAP::SwitchArg rangeArg( "l", "rangeLoading",
+                 "Load only the model data of the DB range on render clients",
+                                   command, false );
+        TCLAP::SwitchArg optimizeArg( "q", "optimizeData",
+    "Optimize and quantize vertex data (valid during binary file creation)",
+                                      command, false );
 
         command.parse( argc, argv );
 
@@ -193,6 +203,10 @@ void LocalInitData::parseArguments( const int argc, char** argv )
             disableLogo();
         if( roiArg.isSet( ))
             disableROI();
+        if( rangeArg.isSet( ))
+            enableRangeLoading();
+        if( optimizeArg.isSet( ))
+            enableOptimizedData();
     }
     catch( const TCLAP::ArgException& exception )
     {
@@ -51,4 +51,14 @@ bool Node::configInit( const eq::uint128_t& initID )
     return true;
 }
 
+void Node::frameFinish( const eq::uint128_t& frameID,
+                        const uint32_t frameNumber )
+{
+    // all pipes have finished the frame, their older model data is unused
+    Config* config = static_cast< Config* >( getConfig( ));
+    config->evictModelData( frameNumber );
+
+    eq::Node::frameFinish( frameID, frameNumber );
+}
+
 }
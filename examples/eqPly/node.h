@@ -51,6 +51,8 @@ namespace eqPly
         virtual ~Node(){}
 
         virtual bool configInit( const eq::uint128_t& initID );
+        virtual void frameFinish( const eq::uint128_t& frameID,
+                                  const uint32_t frameNumber );
 
     private:
     };
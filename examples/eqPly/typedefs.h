@@ -71,6 +71,9 @@ namespace mesh
     typedef vmml::vector< 3, GLfloat >    Vertex;
     typedef vmml::vector< 4, GLubyte >    Color;
     typedef vmml::vector< 3, GLfloat >    Normal;
+    typedef vmml::vector< 3, GLushort >   QuantizedVertex; // in leaf bounds
+    typedef vmml::vector< 2, GLshort >    PackedNormal; // octahedral encoded
+    typedef vmml::vector< 3, GLubyte >    PackedColor; // without alpha
     typedef vmml::matrix< 4, 4, float >   Matrix4f;
     typedef vmml::vector< 4, float >      Vector4f;
     typedef size_t                        Index;
@@ -130,9 +133,12 @@ namespace mesh
     // different vertices per leaf must stay below ShortIndex range; usually
     // #vertices ~ #triangles/2, but max #vertices = #triangles * 3)
     const Index             LEAF_SIZE( 21845 );
+
+    // LRU post-transform vertex cache size used by the optimized data
+    const size_t            VERTEX_CACHE_SIZE( 32 );
     
     // binary mesh file version, increment if changing the file format
-    const unsigned short    FILE_VERSION ( 0x0116 );
+    const unsigned short    FILE_VERSION ( 0x0119 );
 
     // enumeration for the sort axis
     enum Axis
@@ -37,6 +37,7 @@
 
 #include "typedefs.h"
 #include <fstream>
+#include <vector>
 
 namespace eqPly
 {
@@ -48,6 +49,7 @@ namespace mesh
     // defined elsewhere
     class VertexData;
     class VertexBufferData;
+    class VertexBufferLeaf;
     class VertexBufferState;
         
     /*  The abstract base class for all kinds of kd-tree nodes.  */
@@ -96,6 +98,8 @@ namespace mesh
                                 const Index length, const Axis axis,
                                 const size_t depth,
                                 VertexBufferData& globalData ) = 0;
+        virtual void collectLeaves( std::vector< VertexBufferLeaf* >& leaves )
+            = 0;
         
         virtual void updateRange() = 0;
         
@@ -0,0 +1,197 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "vertexBufferCuller.h"
+#include <cmath>
+
+namespace mesh
+{
+namespace
+{
+/*  Minimum number of nodes to classify using multiple threads.  */
+static const ssize_t _parallelSize = 4096;
+
+/*  Classification of a node for the draw list.  */
+enum Cull
+{
+    CULL_SKIP,   // neither the node nor its subtree is drawn
+    CULL_DRAW,   // the node and its subtree are drawn
+    CULL_DESCEND // the children are classified on the next level
+};
+}
+
+size_t VertexBufferCuller::getParallelSize()
+{
+    return size_t( _parallelSize );
+}
+
+/*  Flatten the tree in breadth-first order.  */
+void VertexBufferCuller::setup( const VertexBufferBase* root )
+{
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    _radius.clear();
+    _start.clear();
+    _end.clear();
+    _left.clear();
+    _nodes.clear();
+
+    if( root )
+        _nodes.push_back( root );
+
+    // the nodes array doubles as the queue of the traversal
+    for( size_t i = 0; i < _nodes.size(); ++i )
+    {
+        const VertexBufferBase* node = _nodes[i];
+        const BoundingSphere& sphere = node->getBoundingSphere();
+        _x.push_back( sphere.x( ));
+        _y.push_back( sphere.y( ));
+        _z.push_back( sphere.z( ));
+        _radius.push_back( sphere.w( ));
+        _start.push_back( node->getRange()[0] );
+        _end.push_back( node->getRange()[1] );
+
+        const VertexBufferBase* left = node->getLeft();
+        const VertexBufferBase* right = node->getRight();
+        MESHASSERT( ( left && right ) || ( !left && !right ));
+        if( left )
+        {
+            _left.push_back( uint32_t( _nodes.size( )));
+            _nodes.push_back( left );
+            _nodes.push_back( right );
+        }
+        else
+            _left.push_back( 0 );
+    }
+}
+
+/*  Classify the nodes level by level, starting with the root. The criteria
+    are the ones of the former depth-first traversal: nodes outside of the
+    range or the frustum are skipped, fully visible nodes within the range
+    are drawn with their subtree and partially visible leaves are drawn if
+    their range starts within the range.  */
+void VertexBufferCuller::cull( const Matrix4f& pmv, const Range& range,
+                               const bool frustumCulling,
+                               DrawList& drawList ) const
+{
+    drawList.clear();
+    if( _nodes.empty( ))
+        return;
+
+    // left, right, bottom, top, near and far planes, normalized
+    float planes[6][4];
+    for( size_t i = 0; i < 6; ++i )
+    {
+        const size_t row = i / 2;
+        const float sign = ( i % 2 ) ? -1.f : 1.f;
+        for( size_t j = 0; j < 4; ++j )
+            planes[i][j] = pmv( 3, j ) + sign * pmv( row, j );
+
+        const float length = sqrtf( planes[i][0] * planes[i][0] +
+                                    planes[i][1] * planes[i][1] +
+                                    planes[i][2] * planes[i][2] );
+        for( size_t j = 0; j < 4; ++j )
+            planes[i][j] /= length;
+    }
+
+    const float rangeStart = range[0];
+    const float rangeEnd = range[1];
+    const float* x = &_x[0];
+    const float* y = &_y[0];
+    const float* z = &_z[0];
+    const float* radius = &_radius[0];
+    const float* start = &_start[0];
+    const float* end = &_end[0];
+    const uint32_t* left = &_left[0];
+
+    std::vector< uint32_t > level( 1, 0 );
+    std::vector< uint32_t > nextLevel;
+    std::vector< uint8_t > cull;
+
+    while( !level.empty( ))
+    {
+        const ssize_t nNodes = ssize_t( level.size( ));
+        cull.resize( nNodes );
+        const uint32_t* nodes = &level[0];
+        uint8_t* result = &cull[0];
+
+#pragma omp parallel for if( nNodes > _parallelSize )
+        for( ssize_t i = 0; i < nNodes; ++i )
+        {
+            const uint32_t n = nodes[i];
+
+            // smallest signed distance of the sphere center to a plane
+            float distance = planes[0][0] * x[n] + planes[0][1] * y[n] +
+                             planes[0][2] * z[n] + planes[0][3];
+            for( size_t j = 1; j < 6; ++j )
+            {
+                const float d = planes[j][0] * x[n] + planes[j][1] * y[n] +
+                                planes[j][2] * z[n] + planes[j][3];
+                distance = d < distance ? d : distance;
+            }
+
+            const bool invisible = frustumCulling && distance <= -radius[n];
+            const bool full = !frustumCulling || distance >= radius[n];
+            const bool inRange = start[n] < rangeEnd && end[n] >= rangeStart;
+            const bool inside = start[n] >= rangeStart && end[n] < rangeEnd;
+
+            uint8_t value = CULL_DESCEND;
+            if( invisible || !inRange )
+                value = CULL_SKIP;
+            else if( full && inside )
+                value = CULL_DRAW;
+            else if( left[n] == 0 ) // leaf
+                value = start[n] >= rangeStart ? CULL_DRAW : CULL_SKIP;
+            result[i] = value;
+        }
+
+        nextLevel.clear();
+        for( ssize_t i = 0; i < nNodes; ++i )
+        {
+            const uint32_t n = nodes[i];
+            switch( result[i] )
+            {
+            case CULL_DRAW:
+                drawList.push_back( _nodes[n] );
+                break;
+            case CULL_DESCEND:
+                nextLevel.push_back( left[n] );
+                nextLevel.push_back( left[n] + 1 );
+                break;
+            case CULL_SKIP:
+            default:
+                break;
+            }
+        }
+        level.swap( nextLevel );
+    }
+}
+
+}
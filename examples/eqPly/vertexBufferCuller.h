@@ -0,0 +1,81 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ * - Neither the name of Eyescale Software GmbH nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+
+    
+    Header file of the VertexBufferCuller class.
+*/
+
+
+#ifndef MESH_VERTEXBUFFERCULLER_H
+#define MESH_VERTEXBUFFERCULLER_H
+
+
+#include "vertexBufferBase.h"
+
+namespace mesh 
+{
+    /*  The nodes to draw for one frame.  */
+    typedef std::vector< const VertexBufferBase* > DrawList;
+
+    /*  View frustum and range culling of a kd-tree flattened into arrays.
+
+        The nodes are stored level by level with their bounding spheres and
+        ranges in separate arrays, the children of a node are adjacent. The
+        tree is culled one level at a time, the nodes of a level whose parents
+        are partially visible are classified in a data-parallel loop.  */
+    class VertexBufferCuller
+    {
+    public:
+        /*  Flatten the given tree, which has to stay valid while in use.  */
+        void setup( const VertexBufferBase* root );
+
+        size_t getNumberOfNodes() const { return _nodes.size(); }
+
+        /*  @return the number of nodes of one level above which they are
+            classified using multiple threads.  */
+        static size_t getParallelSize();
+
+        /*  Collect the nodes to draw for the given culling matrix and range,
+            using the same criteria as a depth-first traversal. The nodes
+            are sorted by level.  */
+        void cull( const Matrix4f& pmv, const Range& range,
+                   const bool frustumCulling, DrawList& drawList ) const;
+
+    private:
+        std::vector< float >    _x;      // bounding sphere centers
+        std::vector< float >    _y;
+        std::vector< float >    _z;
+        std::vector< float >    _radius; // bounding sphere radii
+        std::vector< float >    _start;  // range starts
+        std::vector< float >    _end;    // range ends
+        std::vector< uint32_t > _left;   // left child, 0 for leaves
+        std::vector< const VertexBufferBase* > _nodes;
+    };
+}
+
+
+#endif // MESH_VERTEXBUFFERCULLER_H
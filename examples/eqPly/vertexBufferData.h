@@ -38,6 +38,90 @@
 
 namespace mesh 
 {    
+    /*  Alignment of the arrays in the binary kd-tree file.  */
+    static const size_t DATA_ALIGNMENT = 16;
+
+    /*  An array of kd-tree data, owning its memory or referencing (read-only)
+        memory of a mapped binary kd-tree file.  */
+    template< class T > class DataArray
+    {
+    public:
+        DataArray() : _data( 0 ), _size( 0 ) {}
+        DataArray( const DataArray& from ) : _data( 0 ), _size( 0 )
+            { *this = from; }
+
+        DataArray& operator = ( const DataArray& from )
+        {
+            if( this == &from )
+                return *this;
+
+            _vector = from._vector;
+            if( from.isView( ))
+                setView( from._data, from._size );
+            else
+                _update();
+            return *this;
+        }
+
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        /*  Writable access copies referenced data first, the mapping is
+            read-only.  */
+        T& operator [] ( const size_t i ) { _detach(); return _data[i]; }
+        const T& operator [] ( const size_t i ) const { return _data[i]; }
+
+        /*  Resize the owned storage, copying referenced data first.  */
+        void resize( const size_t size )
+        {
+            _detach();
+            _vector.resize( size );
+            _update();
+        }
+
+        void clear()
+        {
+            std::vector< T >().swap( _vector );
+            _update();
+        }
+
+        /*  Take over the given vector's contents.  */
+        void swap( std::vector< T >& from )
+        {
+            _vector.swap( from );
+            _update();
+        }
+
+        /*  Reference external memory which has to stay valid until cleared. */
+        void setView( const T* data, const size_t size )
+        {
+            std::vector< T >().swap( _vector );
+            _data = const_cast< T* >( data );
+            _size = size;
+        }
+
+        bool isView() const { return _size > 0 && _vector.empty(); }
+
+    private:
+        std::vector< T > _vector;
+        T*               _data;
+        size_t           _size;
+
+        void _update()
+        {
+            _data = _vector.empty() ? 0 : &_vector[0];
+            _size = _vector.size();
+        }
+
+        void _detach()
+        {
+            if( !isView( ))
+                return;
+            _vector.assign( _data, _data + _size );
+            _update();
+        }
+    };
+
     /** Holds the final kd-tree data, sorted and reindexed.  */
     class VertexBufferData
     {
@@ -48,57 +132,103 @@ namespace mesh
             colors.clear();
             normals.clear();
             indices.clear();
+            quantizedVertices.clear();
+            packedNormals.clear();
+            packedColors.clear();
+            packedIndices.clear();
+        }
+
+        /*  @return true if the vertices and normals are stored quantized. */
+        bool isQuantized() const { return !quantizedVertices.empty(); }
+
+        /*  @return true if the indices are stored variable-length encoded. */
+        bool isPacked() const { return !packedIndices.empty(); }
+
+        /*  @return the size of all arrays in bytes.  */
+        size_t getSize() const
+        {
+            return vertices.size() * sizeof( Vertex ) +
+                   colors.size() * sizeof( Color ) +
+                   normals.size() * sizeof( Normal ) +
+                   indices.size() * sizeof( ShortIndex ) +
+                   quantizedVertices.size() * sizeof( QuantizedVertex ) +
+                   packedNormals.size() * sizeof( PackedNormal ) +
+                   packedColors.size() * sizeof( PackedColor ) +
+                   packedIndices.size();
         }
         
-        /*  Write the vectors' sizes and contents to the given stream.  */
-        void toStream( std::ostream& os )
+        /*  Write the arrays' sizes and aligned contents to the given stream. */
+        void toStream( std::ostream& os ) const
         {
-            writeVector( os, vertices );
-            writeVector( os, colors );
-            writeVector( os, normals );
-            writeVector( os, indices );
+            writeArray( os, vertices );
+            writeArray( os, colors );
+            writeArray( os, normals );
+            writeArray( os, indices );
+            writeArray( os, quantizedVertices );
+            writeArray( os, packedNormals );
+            writeArray( os, packedColors );
+            writeArray( os, packedIndices );
         }
         
-        /*  Read the vectors' sizes and contents from the given MMF address.  */
+        /*  Reference the arrays' contents at the given MMF address, which
+            has to stay mapped while the data is in use.  */
         void fromMemory( char** addr )
         {
             clear();
-            readVector( addr, vertices );
-            readVector( addr, colors );
-            readVector( addr, normals );
-            readVector( addr, indices );
+            readArray( addr, vertices );
+            readArray( addr, colors );
+            readArray( addr, normals );
+            readArray( addr, indices );
+            readArray( addr, quantizedVertices );
+            readArray( addr, packedNormals );
+            readArray( addr, packedColors );
+            readArray( addr, packedIndices );
         }
         
-        std::vector< Vertex >       vertices;
-        std::vector< Color >        colors;
-        std::vector< Normal >       normals;
-        std::vector< ShortIndex >   indices;
+        DataArray< Vertex >       vertices;
+        DataArray< Color >        colors;
+        DataArray< Normal >       normals;
+        DataArray< ShortIndex >   indices;
+        DataArray< QuantizedVertex > quantizedVertices; // replace vertices
+        DataArray< PackedNormal > packedNormals; // replace normals
+        DataArray< PackedColor >  packedColors; // replace colors
+        DataArray< uint8_t >      packedIndices; // replace indices
         
     private:
-        /*  Helper function to write a vector to output stream.  */
+        /*  Helper function to write an array to output stream.  */
         template< class T >
-        void writeVector( std::ostream& os, std::vector< T >& v )
+        void writeArray( std::ostream& os, const DataArray< T >& array ) const
         {
-            size_t length = v.size();
+            size_t length = array.size();
             os.write( reinterpret_cast< char* >( &length ), 
                       sizeof( size_t ) );
+
+            static const char padding[ DATA_ALIGNMENT ] = { 0 };
+            const size_t offset = size_t( os.tellp( )) % DATA_ALIGNMENT;
+            if( offset > 0 )
+                os.write( padding, DATA_ALIGNMENT - offset );
+
             if( length > 0 )
-                os.write( reinterpret_cast< char* >( &v[0] ), 
+                os.write( reinterpret_cast< const char* >( &array[0] ), 
                           length * sizeof( T ) );
         }
         
-        /*  Helper function to read a vector from the MMF address.  */
+        /*  Helper function to reference an array at the MMF address.  */
         template< class T >
-        void readVector( char** addr, std::vector< T >& v )
+        void readArray( char** addr, DataArray< T >& array )
         {
             size_t length;
             memRead( reinterpret_cast< char* >( &length ), addr, 
                      sizeof( size_t ) );
+
+            const size_t offset = size_t( *addr ) % DATA_ALIGNMENT;
+            if( offset > 0 )
+                *addr += DATA_ALIGNMENT - offset;
+
             if( length > 0 )
             {
-                v.resize( length );
-                memRead( reinterpret_cast< char* >( &v[0] ), addr, 
-                         length * sizeof( T ) );
+                array.setView( reinterpret_cast< T* >( *addr ), length );
+                *addr += length * sizeof( T );
             }
         }
     };
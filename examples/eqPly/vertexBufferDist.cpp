@@ -27,7 +27,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
   
  *
- * co::Object to distribute a model. Has a VertexBufferBase node.
+ * co::Object to distribute a model. Holds the kd-tree skeleton and the data
+ * chunks.
  */
 
 #include "vertexBufferDist.h"
@@ -36,65 +37,168 @@
 
 namespace eqPly 
 {
+namespace
+{
+/*  Number of frames after which the data of unused chunks is evicted.  */
+static const uint32_t _evictionDelay = 16;
 
-VertexBufferDist::VertexBufferDist()
-        : _root( 0 )
-        , _node( 0 )
-        , _left( 0 )
-        , _right( 0 )
-        , _isRoot( false )
-{}
+/*  Minimum amount of vertex data distributed by one chunk.  */
+static const size_t _chunkSize = LB_1MB * 4;
 
-VertexBufferDist::VertexBufferDist( const mesh::VertexBufferRoot* root )
-        : _root( root )
-        , _node( root )
-        , _left( 0 )
-        , _right( 0 )
-        , _isRoot( true )
+/*  Serialize a slice of a data array in the std::vector wire format.  */
+template< class T >
+void _write( co::DataOStream& os, const mesh::DataArray< T >& array,
+             const size_t start, const size_t length )
 {
-    if( root->getLeft( ))
-        _left = new VertexBufferDist( root, root->getLeft( ));
+    const uint64_t nElems = array.empty() ? 0 : length;
+    os << nElems;
+    if( nElems > 0 )
+        os.write( &array[ start ], nElems * sizeof( T ));
+}
 
-    if( root->getRight( ))
-        _right = new VertexBufferDist( root, root->getRight( ));
+template< class T >
+void _read( co::DataIStream& is, mesh::DataArray< T >& array )
+{
+    std::vector< T > vector;
+    is >> vector;
+    array.swap( vector );
 }
 
-VertexBufferDist::VertexBufferDist( const mesh::VertexBufferRoot* root, 
-                                    const mesh::VertexBufferBase* node )
-        : _root( root )
-        , _node( node )
-        , _left( 0 )
-        , _right( 0 )
-        , _isRoot( false )
+/*  Collect the leaves of the given subtree in depth-first order.  */
+void _collectLeaves( const mesh::VertexBufferBase* node,
+                     std::vector< const mesh::VertexBufferLeaf* >& leaves )
 {
-    if( !node )
+    if( !node->getLeft() && !node->getRight( ))
+    {
+        LBASSERT( dynamic_cast< const mesh::VertexBufferLeaf* >( node ));
+        leaves.push_back( static_cast< const mesh::VertexBufferLeaf* >( node ));
         return;
+    }
 
-    if( node->getLeft( ))
-        _left = new VertexBufferDist( root, node->getLeft( ));
+    _collectLeaves( node->getLeft(), leaves );
+    _collectLeaves( node->getRight(), leaves );
+}
+}
+
+/*  Distributes the vertex data of consecutive leaves. The leaves' data is
+    stored contiguously, a chunk covers one slice of each data array.  */
+class VertexBufferDist::Chunk : public co::Object
+{
+public:
+    Chunk() : source( 0 ), vertexStart( 0 ), vertexLength( 0 ),
+              indexStart( 0 ), indexLength( 0 ), packedStart( 0 ),
+              packedLength( 0 ), nLeaves( 0 ),
+              start( 0.f ), end( 0.f ), lastUsed( 0 ) {}
+
+    const mesh::VertexBufferData* source; // model data on the master
+    mesh::VertexBufferData data; // chunk data on render clients
+
+    size_t vertexStart;
+    size_t vertexLength;
+    size_t indexStart;
+    size_t indexLength;
+    size_t packedStart; // in bytes of packed indices
+    size_t packedLength;
+    size_t nLeaves;
+
+    eq::uint128_t id;
+    float start; // range start of the first leaf
+    float end;   // range start of the last leaf
+    uint32_t lastUsed;
+
+    bool isLoaded() const
+        { return !data.indices.empty() || !data.packedIndices.empty(); }
+
+protected:
+    virtual void getInstanceData( co::DataOStream& os )
+    {
+        LBASSERT( source );
+        _write( os, source->vertices, vertexStart, vertexLength );
+        _write( os, source->colors, vertexStart, vertexLength );
+        _write( os, source->normals, vertexStart, vertexLength );
+        _write( os, source->indices, indexStart, indexLength );
+        _write( os, source->quantizedVertices, vertexStart, vertexLength );
+        _write( os, source->packedNormals, vertexStart, vertexLength );
+        _write( os, source->packedColors, vertexStart, vertexLength );
+        _write( os, source->packedIndices, packedStart, packedLength );
+    }
 
-    if( node->getRight( ))
-        _right = new VertexBufferDist( root, node->getRight( ));
+    virtual void applyInstanceData( co::DataIStream& is )
+    {
+        _read( is, data.vertices );
+        _read( is, data.colors );
+        _read( is, data.normals );
+        _read( is, data.indices );
+        _read( is, data.quantizedVertices );
+        _read( is, data.packedNormals );
+        _read( is, data.packedColors );
+        _read( is, data.packedIndices );
+    }
+};
+
+VertexBufferDist::VertexBufferDist()
+        : _root( 0 )
+{}
+
+VertexBufferDist::VertexBufferDist( const mesh::VertexBufferRoot* root )
+        : _root( root )
+{
+    std::vector< const mesh::VertexBufferLeaf* > leaves;
+    _collectLeaves( root, leaves );
+
+    // group consecutive leaves into chunks of at least _chunkSize bytes
+    const mesh::VertexBufferData& data = root->_data;
+    const size_t vertexSize = data.isQuantized() ?
+        sizeof( mesh::QuantizedVertex ) + sizeof( mesh::PackedNormal ) :
+        sizeof( mesh::Vertex ) + sizeof( mesh::Normal );
+    const size_t indexSize = data.isPacked() ? 0 : sizeof( mesh::ShortIndex );
+    Chunk* chunk = 0;
+    size_t size = 0;
+    for( size_t i = 0; i < leaves.size(); ++i )
+    {
+        const mesh::VertexBufferLeaf* leaf = leaves[i];
+        if( !chunk )
+        {
+            chunk = new Chunk;
+            chunk->source = &data;
+            chunk->vertexStart = leaf->_vertexStart;
+            chunk->indexStart = leaf->_indexStart;
+            chunk->packedStart = leaf->_packedStart;
+            _chunks.push_back( chunk );
+            size = 0;
+        }
+
+        LBASSERT( leaf->_vertexStart == chunk->vertexStart +
+                                        chunk->vertexLength );
+        LBASSERT( leaf->_indexStart == chunk->indexStart + chunk->indexLength );
+        chunk->vertexLength += leaf->_vertexLength;
+        LBASSERT( leaf->_packedStart == chunk->packedStart +
+                                        chunk->packedLength );
+        chunk->indexLength += leaf->_indexLength;
+        chunk->packedLength += leaf->_packedLength;
+        ++chunk->nLeaves;
+
+        size += leaf->_vertexLength * vertexSize +
+                leaf->_indexLength * indexSize + leaf->_packedLength;
+        if( size >= _chunkSize )
+            chunk = 0;
+    }
 }
 
 VertexBufferDist::~VertexBufferDist()
 {
-    delete _left;
-    _left = 0;
-    delete _right;
-    _right = 0;
+    for( ChunksCIter i = _chunks.begin(); i != _chunks.end(); ++i )
+        delete *i;
+    _chunks.clear();
 }
 
 void VertexBufferDist::registerTree( co::LocalNodePtr node )
 {
     LBASSERT( !isAttached() );
-    LBCHECK( node->registerObject( this ));
 
-    if( _left )
-        _left->registerTree( node );
-    
-    if( _right )
-        _right->registerTree( node );
+    for( ChunksCIter i = _chunks.begin(); i != _chunks.end(); ++i )
+        LBCHECK( node->registerObject( *i ));
+    LBCHECK( node->registerObject( this ));
 }
 
 void VertexBufferDist::deregisterTree()
@@ -102,19 +206,17 @@ void VertexBufferDist::deregisterTree()
     LBASSERT( isAttached() );
     LBASSERT( isMaster( ));
 
-    getLocalNode()->deregisterObject( this );
-
-    if( _left )
-        _left->deregisterTree();
-    if( _right )
-        _right->deregisterTree();
+    co::LocalNodePtr node = getLocalNode();
+    node->deregisterObject( this );
+    for( ChunksCIter i = _chunks.begin(); i != _chunks.end(); ++i )
+        node->deregisterObject( *i );
 }
 
 mesh::VertexBufferRoot* VertexBufferDist::loadModel( co::NodePtr master,
                                                      co::LocalNodePtr localNode,
                                                   const eq::uint128_t& modelID )
 {
-    LBASSERT( !_root && !_node );
+    LBASSERT( !_root );
 
     const uint32_t req = localNode->mapObjectNB( this, modelID,
                                                  co::VERSION_OLDEST, master );
@@ -124,123 +226,176 @@ mesh::VertexBufferRoot* VertexBufferDist::loadModel( co::NodePtr master,
         return 0;
     }
 
-    _unmapTree();
+    localNode->unmapObject( this );
     return const_cast< mesh::VertexBufferRoot* >( _root );
 }
 
-void VertexBufferDist::_unmapTree()
+void VertexBufferDist::loadRange( co::NodePtr master,
+                                  co::LocalNodePtr localNode,
+                                  const eq::Range& range, const uint32_t frame )
 {
-    LBASSERT( isAttached() );
-    LBASSERT( !isMaster( ));
+    Chunks chunks;
+    for( ChunksCIter i = _chunks.begin(); i != _chunks.end(); ++i )
+    {
+        Chunk* chunk = *i;
+        if( chunk->source ) // master
+            return;
+
+        // a chunk is needed if one of its leaves is drawn, using the same
+        // criterion as VertexBufferRoot::cullDraw()
+        if( chunk->start < range.end && chunk->end >= range.start )
+        {
+            // pipes may draw different frames, keep the most recent use
+            if( chunk->lastUsed < frame )
+                chunk->lastUsed = frame;
+            if( !chunk->isLoaded( ))
+                chunks.push_back( chunk );
+        }
+    }
 
-    getLocalNode()->unmapObject( this );
+    // map all missing chunks concurrently, their data is kept after unmapping
+    std::vector< uint32_t > requests;
+    for( ChunksCIter i = chunks.begin(); i != chunks.end(); ++i )
+        requests.push_back( localNode->mapObjectNB( *i, (*i)->id,
+                                                    co::VERSION_OLDEST,
+                                                    master ));
 
-    if( _left )
-        _left->_unmapTree();
-    if( _right )
-        _right->_unmapTree();
+    for( size_t i = 0; i < chunks.size(); ++i )
+    {
+        if( localNode->mapObjectSync( requests[i] ))
+            localNode->unmapObject( chunks[i] );
+        else
+            LBWARN << "Mapping of model data failed" << std::endl;
+    }
 }
 
-void VertexBufferDist::getInstanceData( co::DataOStream& os )
+void VertexBufferDist::evict( const uint32_t frame )
 {
-    LBASSERT( _node );
-    os << _isRoot;
-
-    if( _left && _right )
+    for( ChunksCIter i = _chunks.begin(); i != _chunks.end(); ++i )
     {
-        os << _left->getID() << _right->getID();
+        Chunk* chunk = *i;
+        if( chunk->source ) // master
+            return;
 
-        if( _isRoot )
-        {
-            LBASSERT( _root );
-            const mesh::VertexBufferData& data = _root->_data;
-            
-            os << data.vertices << data.colors << data.normals << data.indices 
-               << _root->_name;
-        }
+        if( chunk->isLoaded() && frame > chunk->lastUsed + _evictionDelay )
+            chunk->data.clear();
     }
-    else
-    {
-        os << lunchbox::UUID::ZERO << lunchbox::UUID::ZERO;
+}
 
-        LBASSERT( dynamic_cast< const mesh::VertexBufferLeaf* >( _node ));
-        const mesh::VertexBufferLeaf* leaf = 
-            static_cast< const mesh::VertexBufferLeaf* >( _node );
+void VertexBufferDist::_writeTree( co::DataOStream& os,
+                                   const mesh::VertexBufferBase* node ) const
+{
+    const bool isLeaf = !node->getLeft() && !node->getRight();
+    os << isLeaf << node->_boundingSphere << node->_range;
 
+    if( isLeaf )
+    {
+        const mesh::VertexBufferLeaf* leaf = 
+            static_cast< const mesh::VertexBufferLeaf* >( node );
         os << leaf->_boundingBox[0] << leaf->_boundingBox[1]
            << uint64_t( leaf->_vertexStart ) << uint64_t( leaf->_indexStart )
-           << uint64_t( leaf->_indexLength ) << leaf->_vertexLength;
+           << uint64_t( leaf->_indexLength ) << uint64_t( leaf->_packedStart )
+           << uint64_t( leaf->_packedLength ) << leaf->_vertexLength;
+        return;
     }
 
-    os << _node->_boundingSphere << _node->_range;
+    _writeTree( os, node->getLeft( ));
+    _writeTree( os, node->getRight( ));
 }
 
-void VertexBufferDist::applyInstanceData( co::DataIStream& is )
+mesh::VertexBufferBase* VertexBufferDist::_readTree( co::DataIStream& is,
+                                                 mesh::VertexBufferNode* node,
+                                                 const Chunks& leafChunks,
+                                                 size_t& nLeaves )
 {
-    LBASSERT( !_node );
+    bool isLeaf = false;
+    mesh::BoundingSphere boundingSphere;
+    mesh::Range range;
+    is >> isLeaf >> boundingSphere >> range;
 
-    mesh::VertexBufferNode* node = 0;
-    mesh::VertexBufferBase* base = 0;
-
-    lunchbox::UUID leftID, rightID;
-    is >> _isRoot >> leftID >> rightID;
-
-    if( leftID != lunchbox::UUID::ZERO && rightID != lunchbox::UUID::ZERO )
+    mesh::VertexBufferBase* base = node;
+    if( isLeaf )
     {
-        if( _isRoot )
-        {
-            mesh::VertexBufferRoot* root = new mesh::VertexBufferRoot;
-            mesh::VertexBufferData& data = root->_data;
+        LBASSERT( !node );
+        LBASSERT( nLeaves < leafChunks.size( ));
 
-            is >> data.vertices >> data.colors >> data.normals >> data.indices
-               >> root->_name;
+        // leaves reference the data of their chunk, mapped on demand
+        Chunk* chunk = leafChunks[ nLeaves++ ];
+        mesh::VertexBufferLeaf* leaf = new mesh::VertexBufferLeaf(chunk->data);
 
-            node  = root;
-            _root = root;
-        }
-        else
-        {
-            LBASSERT( _root );
-            node = new mesh::VertexBufferNode;
-        }
+        uint64_t i1, i2, i3, i4, i5;
+        is >> leaf->_boundingBox[0] >> leaf->_boundingBox[1]
+           >> i1 >> i2 >> i3 >> i4 >> i5 >> leaf->_vertexLength;
+        leaf->_vertexStart = size_t( i1 ) - chunk->vertexStart;
+        leaf->_indexStart = size_t( i2 ) - chunk->indexStart;
+        leaf->_indexLength = size_t( i3 );
+        leaf->_packedStart = size_t( i4 ) - chunk->packedStart;
+        leaf->_packedLength = size_t( i5 );
 
-        base   = node;
-        _left  = new VertexBufferDist( _root, 0 );
-        _right = new VertexBufferDist( _root, 0 );
-        co::LocalNodePtr to = getLocalNode();
-        co::NodePtr from = is.getMaster();
-        const uint32_t sync1 = to->mapObjectNB( _left, leftID,
-                                                co::VERSION_OLDEST, from );
-        const uint32_t sync2 = to->mapObjectNB( _right, rightID,
-                                                co::VERSION_OLDEST, from );
-
-        LBCHECK( to->mapObjectSync( sync1 ));
-        LBCHECK( to->mapObjectSync( sync2 ));
-
-        node->_left  = const_cast< mesh::VertexBufferBase* >( _left->_node );
-        node->_right = const_cast< mesh::VertexBufferBase* >( _right->_node );
+        if( leaf->_vertexStart == 0 )
+            chunk->start = range[0];
+        chunk->end = range[0];
+        base = leaf;
     }
     else
     {
-        LBASSERT( !_isRoot );
-        mesh::VertexBufferData& data = 
-            const_cast< mesh::VertexBufferData& >( _root->_data );
-        mesh::VertexBufferLeaf* leaf = new mesh::VertexBufferLeaf( data );
+        if( !node )
+            node = new mesh::VertexBufferNode;
+        node->_left = _readTree( is, 0, leafChunks, nLeaves );
+        node->_right = _readTree( is, 0, leafChunks, nLeaves );
+        base = node;
+    }
 
-        uint64_t i1, i2, i3;
-        is >> leaf->_boundingBox[0] >> leaf->_boundingBox[1]
-           >> i1 >> i2 >> i3 >> leaf->_vertexLength;
-        leaf->_vertexStart = size_t( i1 );
-        leaf->_indexStart = size_t( i2 );
-        leaf->_indexLength = size_t( i3 );
+    base->_boundingSphere = boundingSphere;
+    base->_range[0] = range[0];
+    base->_range[1] = range[1];
+    return base;
+}
 
-        base = leaf;
+void VertexBufferDist::getInstanceData( co::DataOStream& os )
+{
+    LBASSERT( _root );
+    os << _root->hasColors() << _root->_name << uint64_t( _chunks.size( ));
+
+    for( ChunksCIter i = _chunks.begin(); i != _chunks.end(); ++i )
+    {
+        const Chunk* chunk = *i;
+        os << chunk->getID() << uint64_t( chunk->vertexStart )
+           << uint64_t( chunk->indexStart ) << uint64_t( chunk->packedStart )
+           << uint64_t( chunk->nLeaves );
     }
 
-    LBASSERT( base );
-    is >> base->_boundingSphere >> base->_range;
+    _writeTree( os, _root );
+}
+
+void VertexBufferDist::applyInstanceData( co::DataIStream& is )
+{
+    LBASSERT( !_root );
+
+    mesh::VertexBufferRoot* root = new mesh::VertexBufferRoot;
+    uint64_t nChunks;
+    is >> root->_hasColors >> root->_name >> nChunks;
+
+    Chunks leafChunks;
+    for( uint64_t i = 0; i < nChunks; ++i )
+    {
+        Chunk* chunk = new Chunk;
+        uint64_t vertexStart, indexStart, packedStart, nLeaves;
+        is >> chunk->id >> vertexStart >> indexStart >> packedStart >> nLeaves;
+        chunk->vertexStart = size_t( vertexStart );
+        chunk->indexStart = size_t( indexStart );
+        chunk->packedStart = size_t( packedStart );
+        chunk->nLeaves = size_t( nLeaves );
+
+        _chunks.push_back( chunk );
+        leafChunks.insert( leafChunks.end(), chunk->nLeaves, chunk );
+    }
 
-    _node = base;
+    size_t nLeaves = 0;
+    _readTree( is, root, leafChunks, nLeaves );
+    LBASSERT( nLeaves == leafChunks.size( ));
+    root->_culler.setup( root );
+    _root = root;
 }
 
 }
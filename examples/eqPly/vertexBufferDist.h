@@ -37,7 +37,12 @@
 
 namespace eqPly 
 {
-    /** co::Object to distribute a model, holds a VertexBufferBase node. */
+    /**
+     * co::Object to distribute a model.
+     *
+     * The object holds the kd-tree skeleton, the vertex data is split into
+     * chunks of consecutive leaves, each distributed by a separate object.
+     */
     class VertexBufferDist : public co::Object
     {
     public:
@@ -52,21 +57,36 @@ namespace eqPly
                                            co::LocalNodePtr localNode,
                                            const eq::uint128_t& modelID );
 
-    protected:
-        VertexBufferDist( const mesh::VertexBufferRoot* root,
-                          const mesh::VertexBufferBase* node );
+        /** Map the data chunks drawn for the given range on a render client. */
+        void loadRange( co::NodePtr master, co::LocalNodePtr localNode,
+                        const eq::Range& range, const uint32_t frame );
+
+        /**
+         * Evict the data of chunks unused for a number of frames.
+         *
+         * All pipes have to have finished the given frame, since they use the
+         * chunk data of their current frame without locking.
+         */
+        void evict( const uint32_t frame );
 
+    protected:
         virtual void getInstanceData( co::DataOStream& os );
         virtual void applyInstanceData( co::DataIStream& is );
 
     private:
+        class Chunk;
+        typedef std::vector< Chunk* > Chunks;
+        typedef Chunks::const_iterator ChunksCIter;
+
         const mesh::VertexBufferRoot* _root;
-        const mesh::VertexBufferBase* _node;
-        VertexBufferDist* _left;
-        VertexBufferDist* _right;
-        bool _isRoot;
+        Chunks _chunks;
 
-        void _unmapTree();
+        void _writeTree( co::DataOStream& os,
+                         const mesh::VertexBufferBase* node ) const;
+        mesh::VertexBufferBase* _readTree( co::DataIStream& is,
+                                           mesh::VertexBufferNode* node,
+                                           const Chunks& leafChunks,
+                                           size_t& nLeaves );
     };
 }
 
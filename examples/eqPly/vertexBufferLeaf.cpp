@@ -32,48 +32,353 @@
 #include "vertexBufferData.h"
 #include "vertexBufferState.h"
 #include "vertexData.h"
-#include <map>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace mesh
 {
+namespace
+{
+/*  Open addressing hash map from model to leaf-local vertex indices.  */
+class IndexMap
+{
+public:
+    IndexMap( const Index nIndices )
+    {
+        size_t size = 1;
+        while( size < nIndices * 2 )
+            size <<= 1;
+
+        _mask = size - 1;
+        _keys.resize( size, std::numeric_limits< Index >::max( ));
+        _values.resize( size );
+    }
+
+    /*  @return the local index of i, inserting value if i is new.  */
+    ShortIndex insert( const Index i, const ShortIndex value, bool& inserted )
+    {
+        size_t pos = ( i * 2654435761u ) & _mask;
+        while( _keys[ pos ] != std::numeric_limits< Index >::max( ))
+        {
+            if( _keys[ pos ] == i )
+            {
+                inserted = false;
+                return _values[ pos ];
+            }
+            pos = ( pos + 1 ) & _mask;
+        }
+
+        _keys[ pos ] = i;
+        _values[ pos ] = value;
+        inserted = true;
+        return value;
+    }
+
+private:
+    std::vector< Index > _keys;
+    std::vector< ShortIndex > _values;
+    size_t _mask;
+};
+
+/*  Size of the LRU post-transform vertex cache modelled by the optimizer.  */
+static const int _cacheSize = int( VERTEX_CACHE_SIZE );
+
+/*  Score of a vertex, favoring vertices recently used and vertices with few
+    remaining triangles (T. Forsyth, Linear-Speed Vertex Cache Optimisation).*/
+float _getVertexScore( const int cachePosition, const uint32_t nTriangles )
+{
+    if( nTriangles == 0 )
+        return -1.f;
+
+    float score = 0.f;
+    if( cachePosition >= 3 )
+        score = powf( 1.f - float( cachePosition - 3 ) / ( _cacheSize - 3 ),
+                      1.5f );
+    else if( cachePosition >= 0 ) // last triangle, score independent of order
+        score = 0.75f;
+
+    return score + 2.f / sqrtf( float( nTriangles ));
+}
+
+/*  Reorder the triangles, given by their model vertex indices, to reuse the
+    vertices in the post-transform vertex cache.  */
+void _optimizeVertexCache( std::vector< Index >& corners )
+{
+    const size_t nCorners = corners.size();
+    const size_t nTriangles = nCorners / 3;
+
+    // dense per-leaf vertex ids
+    IndexMap idMap( nCorners );
+    std::vector< ShortIndex > ids( nCorners );
+    size_t nVertices = 0;
+    for( size_t i = 0; i < nCorners; ++i )
+    {
+        bool inserted = false;
+        ids[i] = idMap.insert( corners[i], ShortIndex( nVertices ), inserted );
+        if( inserted )
+            ++nVertices;
+    }
+
+    // the triangles of each vertex
+    std::vector< uint32_t > offsets( nVertices + 1, 0 );
+    for( size_t i = 0; i < nCorners; ++i )
+        ++offsets[ ids[i] + 1 ];
+    for( size_t i = 0; i < nVertices; ++i )
+        offsets[ i + 1 ] += offsets[i];
+
+    std::vector< uint32_t > triangles( nCorners );
+    std::vector< uint32_t > next( offsets.begin(), offsets.end() - 1 );
+    for( size_t i = 0; i < nCorners; ++i )
+        triangles[ next[ ids[i] ]++ ] = uint32_t( i / 3 );
+
+    std::vector< uint32_t > nRemaining( nVertices );
+    std::vector< int > cachePosition( nVertices, -1 );
+    std::vector< float > vertexScore( nVertices );
+    for( size_t i = 0; i < nVertices; ++i )
+    {
+        nRemaining[i] = offsets[ i + 1 ] - offsets[i];
+        vertexScore[i] = _getVertexScore( -1, nRemaining[i] );
+    }
 
-/*  Finish partial setup - sort, reindex and merge into global data.  */
+    std::vector< float > triangleScore( nTriangles );
+    std::vector< bool > emitted( nTriangles, false );
+    for( size_t t = 0; t < nTriangles; ++t )
+        triangleScore[t] = vertexScore[ ids[ t*3 ]] +
+                           vertexScore[ ids[ t*3 + 1 ]] +
+                           vertexScore[ ids[ t*3 + 2 ]];
+
+    std::vector< Index > result;
+    result.reserve( nCorners );
+    std::vector< ShortIndex > cache;
+    std::vector< ShortIndex > newCache;
+    size_t scan = 0; // next triangle in input order if the cache is cold
+
+    while( result.size() < nCorners )
+    {
+        // pick the best triangle using a cached vertex, or the next one
+        int64_t best = -1;
+        float bestScore = -1.f;
+        for( size_t i = 0; i < cache.size(); ++i )
+        {
+            const ShortIndex v = cache[i];
+            for( uint32_t j = offsets[v]; j < offsets[ v + 1 ]; ++j )
+            {
+                const uint32_t t = triangles[j];
+                if( !emitted[t] && triangleScore[t] > bestScore )
+                {
+                    best = t;
+                    bestScore = triangleScore[t];
+                }
+            }
+        }
+        if( best < 0 )
+        {
+            while( emitted[ scan ] )
+                ++scan;
+            best = scan;
+        }
+
+        emitted[ best ] = true;
+        newCache.clear();
+        for( size_t k = 0; k < 3; ++k )
+        {
+            const ShortIndex v = ids[ best*3 + k ];
+            result.push_back( corners[ best*3 + k ] );
+            --nRemaining[v];
+            if( std::find( newCache.begin(), newCache.end(), v ) ==
+                newCache.end( ))
+            {
+                newCache.push_back( v );
+            }
+        }
+        for( size_t i = 0; i < cache.size(); ++i )
+            if( std::find( newCache.begin(), newCache.end(), cache[i] ) ==
+                newCache.end( ))
+            {
+                newCache.push_back( cache[i] );
+            }
+
+        // update the scores of the vertices in and evicted from the cache
+        for( size_t i = 0; i < newCache.size(); ++i )
+        {
+            const ShortIndex v = newCache[i];
+            cachePosition[v] = int( i ) < _cacheSize ? int( i ) : -1;
+            vertexScore[v] = _getVertexScore( cachePosition[v],
+                                              nRemaining[v] );
+        }
+        for( size_t i = 0; i < newCache.size(); ++i )
+        {
+            const ShortIndex v = newCache[i];
+            for( uint32_t j = offsets[v]; j < offsets[ v + 1 ]; ++j )
+            {
+                const uint32_t t = triangles[j];
+                triangleScore[t] = vertexScore[ ids[ t*3 ]] +
+                                   vertexScore[ ids[ t*3 + 1 ]] +
+                                   vertexScore[ ids[ t*3 + 2 ]];
+            }
+        }
+
+        if( newCache.size() > size_t( _cacheSize ))
+            newCache.resize( _cacheSize );
+        cache.swap( newCache );
+    }
+
+    corners.swap( result );
+}
+
+/*  Map a float in [-1, 1] to a signed 16 bit integer.  */
+GLshort _packSnorm( const float value )
+{
+    const float clamped = LB_MAX( -1.f, LB_MIN( 1.f, value ));
+    return GLshort( floorf( clamped * 32767.f + .5f ));
+}
+
+/*  Encode a unit normal as its projection onto the octahedron unfolded into
+    the unit square.  */
+PackedNormal _packNormal( const Normal& normal )
+{
+    const float sum = fabsf( normal.x( )) + fabsf( normal.y( )) +
+                      fabsf( normal.z( ));
+    if( sum == 0.f )
+        return PackedNormal( 0, 0 );
+
+    float x = normal.x() / sum;
+    float y = normal.y() / sum;
+    if( normal.z() < 0.f )
+    {
+        const float foldedX = ( 1.f - fabsf( y )) * ( x < 0.f ? -1.f : 1.f );
+        y = ( 1.f - fabsf( x )) * ( y < 0.f ? -1.f : 1.f );
+        x = foldedX;
+    }
+    return PackedNormal( _packSnorm( x ), _packSnorm( y ));
+}
+
+/*  Append a leaf-local vertex index as its distance to the next new vertex,
+    zero for a new vertex, with seven bits per byte. The vertices are stored
+    in the order of their first use, and after vertex cache optimization most
+    distances fit into one byte.  */
+void _packIndex( const ShortIndex index, ShortIndex& next,
+                 std::vector< uint8_t >& data )
+{
+    MESHASSERT( index <= next );
+    uint32_t distance = 0;
+    if( index == next )
+        ++next;
+    else
+        distance = next - index;
+
+    while( distance >= 0x80 )
+    {
+        data.push_back( uint8_t( distance | 0x80 ));
+        distance >>= 7;
+    }
+    data.push_back( uint8_t( distance ));
+}
+
+ShortIndex _unpackIndex( const uint8_t*& data, ShortIndex& next )
+{
+    uint32_t distance = 0;
+    for( uint32_t shift = 0; ; shift += 7 )
+    {
+        const uint8_t byte = *data++;
+        distance |= uint32_t( byte & 0x7f ) << shift;
+        if( !( byte & 0x80 ))
+            break;
+    }
+    return distance == 0 ? next++ : ShortIndex( next - distance );
+}
+
+Normal _unpackNormal( const PackedNormal& packed )
+{
+    float x = packed.x() / 32767.f;
+    float y = packed.y() / 32767.f;
+    const float z = 1.f - fabsf( x ) - fabsf( y );
+    if( z < 0.f )
+    {
+        const float unfoldedX = ( 1.f - fabsf( y )) * ( x < 0.f ? -1.f : 1.f );
+        y = ( 1.f - fabsf( x )) * ( y < 0.f ? -1.f : 1.f );
+        x = unfoldedX;
+    }
+    Normal normal( x, y, z );
+    normal.normalize();
+    return normal;
+}
+}
+
+/*  Finish partial setup - sort and count the vertices, the data is merged
+    into the global data by setupData() once all leaves are known.  */
 void VertexBufferLeaf::setupTree( VertexData& data, const Index start,
                                   const Index length, const Axis axis,
                                   const size_t depth,
                                   VertexBufferData& globalData )
 {
     data.sort( start, length, axis );
-    _vertexStart = globalData.vertices.size();
+
+    // the global data holds three indices per triangle in leaf order
+    _vertexStart = 0;
     _vertexLength = 0;
-    _indexStart = globalData.indices.size();
-    _indexLength = 0;
-    
-    const bool hasColors = ( data.colors.size() > 0 ); 
-    
-    // stores the new indices (relative to _start)
-    std::map< Index, ShortIndex > newIndex;
-    
+    _indexStart = start * 3;
+    _indexLength = length * 3;
+
+    IndexMap newIndex( _indexLength );
     for( Index t = 0; t < length; ++t )
     {
         for( Index v = 0; v < 3; ++v )
         {
-            Index i = data.triangles[start + t][v];
-            if( newIndex.find( i ) == newIndex.end() )
+            bool inserted = false;
+            newIndex.insert( data.triangles[start + t][v], _vertexLength,
+                             inserted );
+            if( inserted )
             {
-                newIndex[i] = _vertexLength++;
+                ++_vertexLength;
                 // assert number of vertices does not exceed SmallIndex range
                 MESHASSERT( _vertexLength );
-                globalData.vertices.push_back( data.vertices[i] );
-                if( hasColors )
-                    globalData.colors.push_back( data.colors[i] );
-                globalData.normals.push_back( data.normals[i] );
             }
-            globalData.indices.push_back( newIndex[i] );
-            ++_indexLength; 
         }
     }
-    
+}
+
+
+/*  Reindex and copy the leaf's vertex data into its global data ranges,
+    optionally reordering the triangles for the vertex cache first.  */
+void VertexBufferLeaf::setupData( const VertexData& data,
+                                  const Index vertexStart, const bool optimize )
+{
+    _vertexStart = vertexStart;
+
+    const bool hasColors = ( data.colors.size() > 0 ); 
+    const Index start = _indexStart / 3;
+
+    // the model vertex index of each triangle corner in drawing order
+    std::vector< Index > corners( _indexLength );
+    for( Index i = 0; i < _indexLength; ++i )
+        corners[i] = data.triangles[ start + i / 3 ][ i % 3 ];
+    if( optimize )
+        _optimizeVertexCache( corners );
+
+    // stores the new indices (relative to _vertexStart), the vertices are
+    // stored in the order of their first use
+    IndexMap newIndex( _indexLength );
+    ShortIndex nVertices = 0;
+
+    for( Index offset = 0; offset < _indexLength; ++offset )
+    {
+        const Index i = corners[ offset ];
+        bool inserted = false;
+        const ShortIndex index = newIndex.insert( i, nVertices, inserted );
+        if( inserted )
+        {
+            const Index vertex = _vertexStart + nVertices++;
+            _globalData.vertices[ vertex ] = data.vertices[i];
+            if( hasColors )
+                _globalData.colors[ vertex ] = data.colors[i];
+            _globalData.normals[ vertex ] = data.normals[i];
+        }
+        _globalData.indices[ _indexStart + offset ] = index;
+    }
+    MESHASSERT( nVertices == _vertexLength );
+
 #ifndef NDEBUG
     MESHINFO << "setupTree" << "( " << _indexStart << ", " << _indexLength
              << "; start " << _vertexStart << ", " << _vertexLength
@@ -82,6 +387,125 @@ void VertexBufferLeaf::setupTree( VertexData& data, const Index start,
 }
 
 
+/*  Store the vertices relative to the bounding box with 16 bits per
+    coordinate, the normals octahedral encoded, the colors without alpha and
+    append the variable-length encoded indices to the given data.  */
+void VertexBufferLeaf::quantize( std::vector< uint8_t >& packedIndices )
+{
+    const bool hasColors = !_globalData.colors.empty();
+    const Vertex extent = _boundingBox[1] - _boundingBox[0];
+    Vertex scale;
+    for( size_t i = 0; i < 3; ++i )
+        scale[i] = extent[i] > 0.f ? 65535.f / extent[i] : 0.f;
+
+    for( Index i = _vertexStart; i < _vertexStart + _vertexLength; ++i )
+    {
+        const Vertex offset = _globalData.vertices[i] - _boundingBox[0];
+        for( size_t j = 0; j < 3; ++j )
+            _globalData.quantizedVertices[i][j] = GLushort(
+                LB_MIN( 65535.f, LB_MAX( 0.f, offset[j] * scale[j] + .5f )));
+
+        _globalData.packedNormals[i] = _packNormal( _globalData.normals[i] );
+        if( hasColors )
+        {
+            const Color& color = _globalData.colors[i];
+            _globalData.packedColors[i] = PackedColor( color[0], color[1],
+                                                       color[2] );
+        }
+    }
+
+    ShortIndex next = 0;
+    for( Index i = _indexStart; i < _indexStart + _indexLength; ++i )
+        _packIndex( _globalData.indices[i], next, packedIndices );
+    MESHASSERT( next == _vertexLength );
+}
+
+
+/*  @return the vertex at the given index of the global data.  */
+Vertex VertexBufferLeaf::getVertex( const Index i ) const
+{
+    const VertexBufferData& data = _globalData;
+    if( !data.isQuantized( ))
+        return data.vertices[i];
+
+    const QuantizedVertex& quantized = data.quantizedVertices[i];
+    const Vertex extent = _boundingBox[1] - _boundingBox[0];
+    return Vertex( _boundingBox[0].x() + quantized.x() * extent.x() / 65535.f,
+                   _boundingBox[0].y() + quantized.y() * extent.y() / 65535.f,
+                   _boundingBox[0].z() + quantized.z() * extent.z() / 65535.f);
+}
+
+
+/*  @return the normal at the given index of the global data.  */
+Normal VertexBufferLeaf::getNormal( const Index i ) const
+{
+    const VertexBufferData& data = _globalData;
+    if( !data.isQuantized( ))
+        return data.normals[i];
+    return _unpackNormal( data.packedNormals[i] );
+}
+
+
+/*  @return the color at the given index of the global data.  */
+Color VertexBufferLeaf::getColor( const Index i ) const
+{
+    const VertexBufferData& data = _globalData;
+    if( data.packedColors.empty( ))
+        return data.colors[i];
+
+    const PackedColor& color = data.packedColors[i];
+    return Color( color[0], color[1], color[2], 0 );
+}
+
+
+/*  Decode the leaf's indices, relative to _vertexStart.  */
+void VertexBufferLeaf::getIndices( std::vector< ShortIndex >& indices ) const
+{
+    const VertexBufferData& data = _globalData;
+    indices.resize( _indexLength );
+    if( !data.isPacked( ))
+    {
+        for( Index i = 0; i < _indexLength; ++i )
+            indices[i] = data.indices[ _indexStart + i ];
+        return;
+    }
+
+    const uint8_t* const start = &data.packedIndices[ _packedStart ];
+    const uint8_t* packed = start;
+    ShortIndex next = 0;
+    for( Index i = 0; i < _indexLength; ++i )
+        indices[i] = _unpackIndex( packed, next );
+    MESHASSERT( packed == start + _packedLength );
+}
+
+
+/*  Simulate an LRU vertex cache drawing the leaf's triangles.  */
+size_t VertexBufferLeaf::simulateVertexCache( const size_t cacheSize ) const
+{
+    std::vector< ShortIndex > indices;
+    getIndices( indices );
+
+    std::vector< ShortIndex > cache; // most recently used first
+    size_t nMisses = 0;
+    for( Index i = 0; i < _indexLength; ++i )
+    {
+        const ShortIndex index = indices[i];
+        std::vector< ShortIndex >::iterator j = std::find( cache.begin(),
+                                                           cache.end(), index );
+        if( j == cache.end( ))
+        {
+            ++nMisses;
+            if( cache.size() == cacheSize )
+                cache.pop_back();
+            cache.insert( cache.begin(), index );
+        }
+        else
+            std::rotate( cache.begin(), j, j + 1 );
+    }
+    return nMisses;
+}
+
+
 /*  Compute the bounding sphere of the leaf's indexed vertices.  */
 const BoundingSphere& VertexBufferLeaf::updateBoundingSphere()
 {
@@ -212,17 +636,65 @@ void VertexBufferLeaf::setupRendering( VertexBufferState& state,
     {
         const char* charThis = reinterpret_cast< const char* >( this );
         
+        const VertexBufferData& globalData = _globalData;
+        const Vertex* vertices = 0;
+        const Normal* normals = 0;
+        const Color* colors = 0;
+        const ShortIndex* indices = 0;
+        std::vector< Vertex > decodedVertices;
+        std::vector< Normal > decodedNormals;
+        std::vector< Color > decodedColors;
+        std::vector< ShortIndex > decodedIndices;
+        if( globalData.isQuantized( ))
+        {
+            decodedVertices.resize( _vertexLength );
+            decodedNormals.resize( _vertexLength );
+            for( Index i = 0; i < _vertexLength; ++i )
+            {
+                decodedVertices[i] = getVertex( _vertexStart + i );
+                decodedNormals[i] = getNormal( _vertexStart + i );
+            }
+            vertices = &decodedVertices[0];
+            normals = &decodedNormals[0];
+        }
+        else
+        {
+            vertices = &globalData.vertices[_vertexStart];
+            normals = &globalData.normals[_vertexStart];
+        }
+
+        if( state.useColors( ))
+        {
+            if( globalData.packedColors.empty( ))
+                colors = &globalData.colors[_vertexStart];
+            else
+            {
+                decodedColors.resize( _vertexLength );
+                for( Index i = 0; i < _vertexLength; ++i )
+                    decodedColors[i] = getColor( _vertexStart + i );
+                colors = &decodedColors[0];
+            }
+        }
+
+        if( globalData.isPacked( ))
+        {
+            getIndices( decodedIndices );
+            indices = &decodedIndices[0];
+        }
+        else
+            indices = &globalData.indices[_indexStart];
+
         if( data[VERTEX_OBJECT] == state.INVALID )
             data[VERTEX_OBJECT] = state.newBufferObject( charThis + 0 );
         glBindBuffer( GL_ARRAY_BUFFER, data[VERTEX_OBJECT] );
         glBufferData( GL_ARRAY_BUFFER, _vertexLength * sizeof( Vertex ),
-                        &_globalData.vertices[_vertexStart], GL_STATIC_DRAW );
+                        vertices, GL_STATIC_DRAW );
         
         if( data[NORMAL_OBJECT] == state.INVALID )
             data[NORMAL_OBJECT] = state.newBufferObject( charThis + 1 );
         glBindBuffer( GL_ARRAY_BUFFER, data[NORMAL_OBJECT] );
         glBufferData( GL_ARRAY_BUFFER, _vertexLength * sizeof( Normal ),
-                        &_globalData.normals[_vertexStart], GL_STATIC_DRAW );
+                        normals, GL_STATIC_DRAW );
         
         if( data[COLOR_OBJECT] == state.INVALID )
             data[COLOR_OBJECT] = state.newBufferObject( charThis + 2 );
@@ -230,7 +702,7 @@ void VertexBufferLeaf::setupRendering( VertexBufferState& state,
         {
             glBindBuffer( GL_ARRAY_BUFFER, data[COLOR_OBJECT] );
             glBufferData( GL_ARRAY_BUFFER, _vertexLength * sizeof( Color ),
-                            &_globalData.colors[_vertexStart], GL_STATIC_DRAW );
+                            colors, GL_STATIC_DRAW );
         }
         
         if( data[INDEX_OBJECT] == state.INVALID )
@@ -238,7 +710,7 @@ void VertexBufferLeaf::setupRendering( VertexBufferState& state,
         glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, data[INDEX_OBJECT] );
         glBufferData( GL_ELEMENT_ARRAY_BUFFER, 
                         _indexLength * sizeof( ShortIndex ),
-                        &_globalData.indices[_indexStart], GL_STATIC_DRAW );
+                        indices, GL_STATIC_DRAW );
         
         break;
     }        
@@ -331,14 +803,32 @@ void VertexBufferLeaf::renderDisplayList( VertexBufferState& state ) const
 inline
 void VertexBufferLeaf::renderImmediate( VertexBufferState& state ) const
 {
+    const VertexBufferData& globalData = _globalData;
+    const bool quantized = globalData.isQuantized();
+    const uint8_t* packed = globalData.isPacked() ?
+                            &globalData.packedIndices[_packedStart] : 0;
+    ShortIndex next = 0;
+
     glBegin( GL_TRIANGLES );  
     for( Index offset = 0; offset < _indexLength; ++offset )
     {
-        const Index i =_vertexStart + _globalData.indices[_indexStart + offset];
-        if( state.useColors() )
-            glColor4ubv( &_globalData.colors[i][0] );
-        glNormal3fv( &_globalData.normals[i][0] );
-        glVertex3fv( &_globalData.vertices[i][0] );
+        const Index i = _vertexStart + ( packed ?
+                            _unpackIndex( packed, next ) :
+                            globalData.indices[_indexStart + offset] );
+        if( quantized )
+        {
+            if( state.useColors() )
+                glColor4ubv( getColor( i ).array );
+            glNormal3fv( getNormal( i ).array );
+            glVertex3fv( getVertex( i ).array );
+        }
+        else
+        {
+            if( state.useColors() )
+                glColor4ubv( &globalData.colors[i][0] );
+            glNormal3fv( &globalData.normals[i][0] );
+            glVertex3fv( &globalData.vertices[i][0] );
+        }
     }
     glEnd();
     
@@ -371,6 +861,10 @@ void VertexBufferLeaf::fromMemory( char** addr, VertexBufferData& globalData )
              sizeof( Index ) );
     memRead( reinterpret_cast< char* >( &_indexLength ), addr, 
              sizeof( Index ) );
+    memRead( reinterpret_cast< char* >( &_packedStart ), addr, 
+             sizeof( Index ) );
+    memRead( reinterpret_cast< char* >( &_packedLength ), addr, 
+             sizeof( Index ) );
 }
 
 
@@ -385,6 +879,8 @@ void VertexBufferLeaf::toStream( std::ostream& os )
     os.write( reinterpret_cast< char* >( &_vertexLength ),sizeof( ShortIndex ));
     os.write( reinterpret_cast< char* >( &_indexStart ), sizeof( Index ));
     os.write( reinterpret_cast< char* >( &_indexLength ), sizeof( Index ));
+    os.write( reinterpret_cast< char* >( &_packedStart ), sizeof( Index ));
+    os.write( reinterpret_cast< char* >( &_packedLength ), sizeof( Index ));
 }
 
 }
@@ -46,11 +46,16 @@ namespace mesh
     public:
         VertexBufferLeaf( VertexBufferData& data )
             : _globalData( data ), _vertexStart( 0 ),
-              _indexStart( 0 ), _indexLength( 0 ) {}
+              _indexStart( 0 ), _indexLength( 0 ),
+              _packedStart( 0 ), _packedLength( 0 ) {}
         virtual ~VertexBufferLeaf() {}
         
         virtual void draw( VertexBufferState& state ) const;
         virtual Index getNumberOfVertices() const { return _indexLength; }
+
+        /*  @return the vertex cache misses of the leaf's triangles for an
+            LRU post-transform vertex cache of the given size.  */
+        size_t simulateVertexCache( const size_t cacheSize ) const;
         
     protected:
         virtual void toStream( std::ostream& os );
@@ -60,10 +65,19 @@ namespace mesh
                                 const Index length, const Axis axis,
                                 const size_t depth,
                                 VertexBufferData& globalData );
+        virtual void collectLeaves( std::vector< VertexBufferLeaf* >& leaves )
+            { leaves.push_back( this ); }
         virtual const BoundingSphere& updateBoundingSphere();
         virtual void updateRange();
         
     private:
+        void setupData( const VertexData& data, const Index vertexStart,
+                        const bool optimize );
+        void quantize( std::vector< uint8_t >& packedIndices );
+        Vertex getVertex( const Index i ) const;
+        Normal getNormal( const Index i ) const;
+        Color getColor( const Index i ) const;
+        void getIndices( std::vector< ShortIndex >& indices ) const;
         void setupRendering( VertexBufferState& state, GLuint* data ) const;
         void renderImmediate( VertexBufferState& state ) const;
         void renderDisplayList( VertexBufferState& state ) const;
@@ -74,8 +88,11 @@ namespace mesh
         Index               _vertexStart;
         Index               _indexStart;
         Index               _indexLength;
+        Index               _packedStart; // in bytes of packed indices
+        Index               _packedLength;
         ShortIndex          _vertexLength;
         friend class eqPly::VertexBufferDist;
+        friend class VertexBufferRoot;
     };
     
     
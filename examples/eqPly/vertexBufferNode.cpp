@@ -34,8 +34,14 @@
 #include "vertexData.h"
 #include <set>
 
+#if defined( _OPENMP ) && _OPENMP >= 200805 // OpenMP 3.0 tasks
+#  define EQPLY_USE_TASKS
+#endif
+
 namespace mesh
 {
+/*  Minimum number of triangles to construct a subtree in a separate task.  */
+static const Index _taskSize = LEAF_SIZE * 4;
 
 /*  Destructor, clears up children as well.  */
 VertexBufferNode::~VertexBufferNode()
@@ -63,7 +69,8 @@ void VertexBufferNode::setupTree( VertexData& data, const Index start,
              << depth << " )." << std::endl;
 #endif
 
-    data.sort( start, length, axis );
+    // the children sort or partition their halves themselves
+    data.partition( start, length, axis );
     const Index median = start + ( length / 2 );
 
     // left child will include elements smaller than the median
@@ -91,13 +98,30 @@ void VertexBufferNode::setupTree( VertexData& data, const Index start,
     const Axis newAxisRight = subdivideRight ? 
                         data.getLongestAxis( median, rightLength ) : AXIS_X;
 
-    static_cast< VertexBufferNode* >
-            ( _left )->setupTree( data, start, leftLength, newAxisLeft, depth+1,
-                                  globalData );
-    static_cast< VertexBufferNode* >
-        ( _right )->setupTree( data, median, rightLength, newAxisRight, depth+1,
-                               globalData );
+    // both subtrees work on disjoint triangle ranges, build them concurrently
+    VertexBufferNode* left = static_cast< VertexBufferNode* >( _left );
+    VertexBufferNode* right = static_cast< VertexBufferNode* >( _right );
+    VertexData* vertexData = &data;
+    VertexBufferData* bufferData = &globalData;
+
+#ifdef EQPLY_USE_TASKS
+#  pragma omp task if( leftLength > _taskSize )
+#endif
+    left->setupTree( *vertexData, start, leftLength, newAxisLeft, depth+1,
+                     *bufferData );
+    right->setupTree( *vertexData, median, rightLength, newAxisRight, depth+1,
+                      *bufferData );
+#ifdef EQPLY_USE_TASKS
+#  pragma omp taskwait
+#endif
+}
+
 
+/*  Collect the leaves of both subtrees in depth-first order.  */
+void VertexBufferNode::collectLeaves( std::vector< VertexBufferLeaf* >& leaves )
+{
+    static_cast< VertexBufferNode* >( _left )->collectLeaves( leaves );
+    static_cast< VertexBufferNode* >( _right )->collectLeaves( leaves );
 }
 
 
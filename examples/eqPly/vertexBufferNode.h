@@ -61,6 +61,7 @@ namespace mesh
                                 const Index length, const Axis axis,
                                 const size_t depth, 
                                 VertexBufferData& globalData );
+        virtual void collectLeaves( std::vector< VertexBufferLeaf* >& leaves );
         virtual const BoundingSphere& updateBoundingSphere();
         virtual void updateRange();
 
@@ -29,41 +29,99 @@
 
 
 #include "vertexBufferRoot.h"
+#include "vertexBufferLeaf.h"
 #include "vertexBufferState.h"
 #include "vertexData.h"
+#include <algorithm>
 #include <string>
 #include <sstream>
-#include <fcntl.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#ifndef _WIN32
-#   include <sys/mman.h>
-#endif
 
 namespace mesh
 {
 
-typedef vmml::frustum_culler< float >  FrustumCuller;
-
 /*  Determine number of bits used by the current architecture.  */
 size_t getArchitectureBits();
 /*  Determine whether the current architecture is little endian or not.  */
 bool isArchitectureLittleEndian();
-/*  Construct architecture dependent file name.  */
-std::string getArchitectureFilename( const std::string& filename );
 
-/*  Begin kd-tree setup, go through full range starting with x axis.  */
+/*  Begin kd-tree setup, go through full range starting with x axis. The
+    optimized data has the triangles of each leaf reordered for the vertex
+    cache, the vertices, normals and colors quantized and the indices
+    variable-length encoded.  */
 void VertexBufferRoot::setupTree( VertexData& data )
 {
     // data is VertexData, _data is VertexBufferData
     _data.clear();
+    _map.unmap();
+    data.calculateCentroids();
 
     const Axis axis = data.getLongestAxis( 0, data.triangles.size() );
 
+    // build the tree structure, subtrees are constructed in parallel tasks
+#pragma omp parallel
+#pragma omp single
     VertexBufferNode::setupTree( data, 0, data.triangles.size(), 
                                  axis, 0, _data );
+
+    // compute the vertex offsets of all leaves and merge them in parallel
+    std::vector< VertexBufferLeaf* > leaves;
+    collectLeaves( leaves );
+
+    std::vector< Index > vertexStarts( leaves.size( ));
+    Index nVertices = 0;
+    for( size_t i = 0; i < leaves.size(); ++i )
+    {
+        vertexStarts[i] = nVertices;
+        nVertices += leaves[i]->_vertexLength;
+    }
+
+    _data.vertices.resize( nVertices );
+    _data.normals.resize( nVertices );
+    if( !data.colors.empty( ))
+        _data.colors.resize( nVertices );
+    _data.indices.resize( data.triangles.size() * 3 );
+
+    const ssize_t nLeaves = ssize_t( leaves.size( ));
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nLeaves; ++i )
+        leaves[i]->setupData( data, vertexStarts[i], _optimizeData );
+    _hasColors = !_data.colors.empty();
+
     VertexBufferNode::updateBoundingSphere();
     VertexBufferNode::updateRange();
+    _culler.setup( this );
+
+    if( _optimizeData )
+    {
+        // quantize relative to the leaf bounding boxes computed above
+        _data.quantizedVertices.resize( nVertices );
+        _data.packedNormals.resize( nVertices );
+        if( _hasColors )
+            _data.packedColors.resize( nVertices );
+
+        std::vector< std::vector< uint8_t > > packedIndices( nLeaves );
+#pragma omp parallel for
+        for( ssize_t i = 0; i < nLeaves; ++i )
+            leaves[i]->quantize( packedIndices[i] );
+
+        // concatenate the leaves' packed indices in leaf order
+        Index nBytes = 0;
+        for( ssize_t i = 0; i < nLeaves; ++i )
+        {
+            leaves[i]->_packedStart = nBytes;
+            leaves[i]->_packedLength = packedIndices[i].size();
+            nBytes += packedIndices[i].size();
+        }
+        _data.packedIndices.resize( nBytes );
+        for( ssize_t i = 0; i < nLeaves; ++i )
+            std::copy( packedIndices[i].begin(), packedIndices[i].end(),
+                       &_data.packedIndices[ leaves[i]->_packedStart ] );
+
+        _data.vertices.clear();
+        _data.normals.clear();
+        _data.colors.clear();
+        _data.indices.clear();
+    }
 
 #if 0
     // re-test all points to be in the bounding sphere
@@ -82,101 +140,51 @@ void VertexBufferRoot::setupTree( VertexData& data )
 #endif
 }
 
+float VertexBufferRoot::getACMR( const size_t cacheSize ) const
+{
+    std::vector< VertexBufferLeaf* > leaves;
+    const_cast< VertexBufferRoot* >( this )->collectLeaves( leaves );
+
+    size_t nMisses = 0;
+    for( size_t i = 0; i < leaves.size(); ++i )
+        nMisses += leaves[i]->simulateVertexCache( cacheSize );
+
+    const size_t nTriangles = getNumberOfVertices() / 3;
+    return nTriangles ? float( nMisses ) / float( nTriangles ) : 0.f;
+}
+
 // #define LOGCULL
+/*  Cull the flattened tree into a draw list, then draw its nodes.  */
 void VertexBufferRoot::cullDraw( VertexBufferState& state ) const
 {
+    DrawList drawList;
+    _culler.cull( state.getProjectionModelViewMatrix(), state.getRange(),
+                  state.useFrustumCulling(), drawList );
+
     _beginRendering( state );
     
 #ifdef LOGCULL
     size_t verticesRendered = 0;
-    size_t verticesOverlap  = 0;
 #endif
 
-    const Range& range = state.getRange();
-    FrustumCuller culler;
-    culler.setup( state.getProjectionModelViewMatrix( ));
-
-    // start with root node
-    std::vector< const mesh::VertexBufferBase* > candidates;
-    candidates.push_back( this );
-
-    while( !candidates.empty() )
+    for( DrawList::const_iterator i = drawList.begin();
+         i != drawList.end() && !state.stopRendering(); ++i )
     {
-        if( state.stopRendering( ))
-            return;
-
-        const mesh::VertexBufferBase* treeNode = candidates.back();
-        candidates.pop_back();
-            
-        // completely out of range check
-        if( treeNode->getRange()[0] >= range[1] ||
-            treeNode->getRange()[1] < range[0] )
-        {
-            continue;
-        }
-
-        // bounding sphere view frustum culling
-        const vmml::Visibility visibility = state.useFrustumCulling() ?
-                            culler.test_sphere( treeNode->getBoundingSphere( )) :
-                            vmml::VISIBILITY_FULL;
-        switch( visibility )
-        {
-            case vmml::VISIBILITY_FULL:
-                // if fully visible and fully in range, render it
-                if( treeNode->getRange()[0] >= range[0] && 
-                    treeNode->getRange()[1] <  range[1] )
-                {
-                    treeNode->draw( state );
-                    //treeNode->drawBoundingSphere( state );
+        (*i)->draw( state );
+        //(*i)->drawBoundingSphere( state );
 #ifdef LOGCULL
-                    verticesRendered += treeNode->getNumberOfVertices();
+        verticesRendered += (*i)->getNumberOfVertices();
 #endif
-                    break;
-                }
-                // partial range, fall through to partial visibility
-
-            case vmml::VISIBILITY_PARTIAL:
-            {
-                const mesh::VertexBufferBase* left  = treeNode->getLeft();
-                const mesh::VertexBufferBase* right = treeNode->getRight();
-            
-                if( !left && !right )
-                {
-                    if( treeNode->getRange()[0] >= range[0] )
-                    {
-                        treeNode->draw( state );
-                        //treeNode->drawBoundingSphere( state );
-#ifdef LOGCULL
-                        verticesRendered += treeNode->getNumberOfVertices();
-                        if( visibility == vmml::VISIBILITY_PARTIAL )
-                            verticesOverlap  += treeNode->getNumberOfVertices();
-#endif
-                    }
-                    // else drop, to be drawn by 'previous' channel
-                }
-                else
-                {
-                    if( left )
-                        candidates.push_back( left );
-                    if( right )
-                        candidates.push_back( right );
-                }
-                break;
-            }
-            case vmml::VISIBILITY_NONE:
-                // do nothing
-                break;
-        }
     }
     
     _endRendering( state );
 
 #ifdef LOGCULL
-    const size_t verticesTotal = model->getNumberOfVertices();
+    const size_t verticesTotal = getNumberOfVertices();
     MESHINFO
         << getName() << " rendered " << verticesRendered * 100 / verticesTotal
-        << "% of model, overlap <= " << verticesOverlap * 100 / verticesTotal
-        << "%" << std::endl;
+        << "% of model in " << drawList.size() << " of "
+        << _culler.getNumberOfNodes() << " nodes" << std::endl;
 #endif    
 }
 
@@ -282,100 +290,34 @@ bool VertexBufferRoot::_constructFromPly( const std::string& filename )
     return true;
 }
 
-bool VertexBufferRoot::_readBinary( std::string filename )
+/*  Map the binary kd-tree file, the vertex data is used in place and stays
+    mapped until the model is destroyed or rebuilt.  */
+bool VertexBufferRoot::_readBinary( const std::string& filename )
 {
-#ifdef WIN32
-
-    // replace dir delimiters since '\' is often used as escape char
-    for( size_t i=0; i<filename.length(); ++i )
-        if( filename[i] == '\\' )
-            filename[i] = '/';
+    _data.clear();
+    _map.unmap();
 
-    // try to open binary file
-    HANDLE file = CreateFile( filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
-                              0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
-    if( file == INVALID_HANDLE_VALUE )
-        return false;
-    
-    MESHINFO << "Reading cached binary representation." << std::endl;
-    
-    // create a file mapping
-    HANDLE map = CreateFileMapping( file, 0, PAGE_READONLY, 0, 0, 
-                                    filename.c_str( ));
-    CloseHandle( file );
-    if( !map )
-    {
-        MESHERROR << "Unable to read binary file, file mapping failed." 
-                  << std::endl;
+    char* addr = static_cast< char* >( const_cast< void* >(
+                                           _map.map( filename )));
+    if( !addr )
         return false;
-    }
-    
-    // get a view of the mapping
-    char* addr   = static_cast< char* >( MapViewOfFile( map, FILE_MAP_READ, 0, 
-                                                        0, 0 ) );
-    bool  result = false;
 
-    if( addr )
+    MESHINFO << "Reading cached binary representation." << std::endl;
+    try
     {
-        try
-        {
-            fromMemory( addr );
-            result = true;
-        }
-        catch( const std::exception& e )
-        {
-            MESHERROR << "Unable to read binary file, an exception occured:  "
-                      << e.what() << std::endl;
-        }
-        UnmapViewOfFile( addr );
+        fromMemory( addr );
+        _culler.setup( this );
+        return true;
     }
-    else
+    catch( const std::exception& e )
     {
-        MESHERROR << "Unable to read binary file, memory mapping failed."
-                  << std::endl;
-        return false;
+        MESHERROR << "Unable to read binary file, an exception occured:  "
+                  << e.what() << std::endl;
     }
 
-    CloseHandle( map );
-    return result;
-    
-#else
-    // try to open binary file
-    int fd = open( filename.c_str(), O_RDONLY );
-    if( fd < 0 )
-        return false;
-    
-    // retrieving file information
-    struct stat status;
-    fstat( fd, &status );
-    
-    // create memory mapped file
-    char* addr   = static_cast< char* >( mmap( 0, status.st_size, PROT_READ, 
-                                               MAP_SHARED, fd, 0 ) );
-    bool  result = false;
-    if( addr != MAP_FAILED )
-    {
-        try
-        {
-            fromMemory( addr );
-            result = true;
-        }
-        catch( const std::exception& e )
-        {
-            MESHERROR << "Unable to read binary file, an exception occured:  "
-                      << e.what() << std::endl;
-        }
-        munmap( addr, status.st_size );
-    }
-    else
-    {
-        MESHERROR << "Unable to read binary file, memory mapping failed."
-                  << std::endl;
-    }
-    
-    close( fd );
-    return result;
-#endif
+    _data.clear();
+    _map.unmap();
+    return false;
 }
 
 /*  Read binary kd-tree representation, construct from ply if unavailable.  */
@@ -441,6 +383,7 @@ void VertexBufferRoot::fromMemory( char* start )
         throw MeshException( "Error reading binary file. Expected the root "
                              "node, but found something else instead." );
     _data.fromMemory( addr );
+    _hasColors = !_data.colors.empty() || !_data.packedColors.empty();
     VertexBufferNode::fromMemory( addr, _data );
 }
 
@@ -32,15 +32,20 @@
 #define MESH_VERTEXBUFFERROOT_H
 
 #include "vertexBufferNode.h"
+#include "vertexBufferCuller.h"
 #include "vertexBufferData.h"
 
 namespace mesh 
 {
+    /*  Construct the name of the binary kd-tree file of the given model.  */
+    std::string getArchitectureFilename( const std::string& filename );
+
     /*  The class for kd-tree root nodes.  */
     class VertexBufferRoot : public VertexBufferNode
     {
     public:
-        VertexBufferRoot() : VertexBufferNode(), _invertFaces(false) {}
+        VertexBufferRoot() : VertexBufferNode(), _hasColors(false),
+                             _invertFaces(false), _optimizeData(false) {}
 
         virtual void cullDraw( VertexBufferState& state ) const;
         virtual void draw( VertexBufferState& state ) const;
@@ -48,9 +53,17 @@ namespace mesh
         void setupTree( VertexData& data );
         bool writeToFile( const std::string& filename );
         bool readFromFile( const std::string& filename );
-        bool hasColors() const { return _data.colors.size() > 0; }
+        bool hasColors() const { return _hasColors; }
 
         void useInvertedFaces() { _invertFaces = true; }
+        void useOptimizedData() { _optimizeData = true; }
+
+        /*  @return the average number of vertex cache misses per triangle
+            for an LRU post-transform vertex cache of the given size.  */
+        float getACMR( const size_t cacheSize ) const;
+
+        /*  @return the size of the vertex data in bytes.  */
+        size_t getDataSize() const { return _data.getSize(); }
 
         const std::string& getName() const { return _name; }
 
@@ -60,14 +73,18 @@ namespace mesh
         
     private:
         bool _constructFromPly( const std::string& filename );
-        bool _readBinary( std::string filename );
+        bool _readBinary( const std::string& filename );
 
         void _beginRendering( VertexBufferState& state ) const;
         void _endRendering( VertexBufferState& state ) const;
 
-        VertexBufferData _data;
-        bool             _invertFaces;
-        std::string      _name;
+        VertexBufferData    _data;
+        VertexBufferCuller  _culler; // flattened tree for cullDraw
+        lunchbox::MemoryMap _map; // binary kd-tree file referenced by _data
+        bool                _hasColors;
+        bool                _invertFaces;
+        bool                _optimizeData;
+        std::string         _name;
 
         friend class eqPly::VertexBufferDist;
     };
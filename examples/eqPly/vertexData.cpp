@@ -31,13 +31,17 @@
 #include "ply.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
+#include <sstream>
 
 #if (( __GNUC__ > 4 ) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 4)) )
 #  include <parallel/algorithm>
 using __gnu_parallel::sort;
+using __gnu_parallel::nth_element;
 #else
 using std::sort;
+using std::nth_element;
 #endif
 
 
@@ -148,6 +152,232 @@ void VertexData::readTriangles( PlyFile* file, const int nFaces )
 }
 
 
+namespace
+{
+/*  Layout of the vertex and face elements of a binary PLY file.  */
+struct PlyLayout
+{
+    PlyLayout() : nVertices( 0 ), vertexSize( 0 ), nFaces( 0 ), faceSize( 0 ),
+                  dataOffset( 0 )
+    {
+        for( size_t i = 0; i < 6; ++i )
+            offsets[i] = -1;
+    }
+
+    size_t nVertices;
+    size_t vertexSize;
+    ssize_t offsets[6]; // x, y, z, red, green, blue
+    size_t nFaces;
+    size_t faceSize;
+    size_t dataOffset;
+};
+
+/*  @return the size of the given PLY scalar type, 0 if unknown.  */
+size_t _getTypeSize( const std::string& type )
+{
+    if( type == "char" || type == "uchar" || type == "int8" ||
+        type == "uint8" )
+    {
+        return 1;
+    }
+    if( type == "short" || type == "ushort" || type == "int16" ||
+        type == "uint16" )
+    {
+        return 2;
+    }
+    if( type == "int" || type == "uint" || type == "float" ||
+        type == "int32" || type == "uint32" || type == "float32" )
+    {
+        return 4;
+    }
+    if( type == "double" || type == "float64" )
+        return 8;
+    return 0;
+}
+
+/*  Parse the header of a binary little endian PLY file with a vertex element
+    and a face element of triangles. @return false for all other files. */
+bool _parseHeader( const char* data, const size_t size, PlyLayout& layout )
+{
+    const std::string text( data, LB_MIN( size, size_t( 65536 )));
+    const size_t headerEnd = text.find( "end_header\n" );
+    if( text.compare( 0, 4, "ply\n" ) != 0 || headerEnd == std::string::npos )
+        return false;
+
+    std::istringstream header( text.substr( 4, headerEnd - 4 ));
+    std::string element;
+    std::string line;
+    while( std::getline( header, line ))
+    {
+        std::istringstream tokens( line );
+        std::string keyword;
+        tokens >> keyword;
+
+        if( keyword == "format" )
+        {
+            std::string format;
+            tokens >> format;
+            if( format != "binary_little_endian" )
+                return false;
+        }
+        else if( keyword == "element" )
+        {
+            size_t count = 0;
+            tokens >> element >> count;
+            if( element == "vertex" && layout.nFaces == 0 )
+                layout.nVertices = count;
+            else if( element == "face" && layout.nVertices > 0 )
+                layout.nFaces = count;
+            else if( count > 0 )
+                return false; // other elements are read by the generic reader
+        }
+        else if( keyword == "property" )
+        {
+            std::string type;
+            tokens >> type;
+
+            if( element == "vertex" )
+            {
+                std::string name;
+                tokens >> name;
+                const size_t typeSize = _getTypeSize( type );
+                if( typeSize == 0 )
+                    return false;
+
+                static const char* names[] = { "x", "y", "z",
+                                               "red", "green", "blue" };
+                for( size_t i = 0; i < 6; ++i )
+                {
+                    if( name != names[i] )
+                        continue;
+                    if( typeSize != ( i < 3 ? sizeof( float ) : 1 ) ||
+                        ( i < 3 && type != "float" && type != "float32" ))
+                    {
+                        return false;
+                    }
+                    layout.offsets[i] = layout.vertexSize;
+                }
+                layout.vertexSize += typeSize;
+            }
+            else if( element == "face" )
+            {
+                std::string countType;
+                std::string indexType;
+                std::string name;
+                tokens >> countType >> indexType >> name;
+                if( type != "list" || layout.faceSize != 0 ||
+                    _getTypeSize( countType ) != 1 ||
+                    _getTypeSize( indexType ) != sizeof( uint32_t ) ||
+                    indexType.find( "float" ) != std::string::npos ||
+                    name != "vertex_indices" )
+                {
+                    return false;
+                }
+                layout.faceSize = 1 + 3 * sizeof( uint32_t );
+            }
+        }
+        else if( keyword != "comment" && keyword != "obj_info" &&
+                 !keyword.empty( ))
+        {
+            return false;
+        }
+    }
+
+    layout.dataOffset = headerEnd + 11; // strlen( "end_header\n" )
+    const bool hasColors = layout.offsets[3] >= 0;
+    return layout.offsets[0] >= 0 && layout.offsets[1] >= 0 &&
+           layout.offsets[2] >= 0 && layout.faceSize > 0 &&
+           ( !hasColors || ( layout.offsets[4] >= 0 && layout.offsets[5] >= 0 ))
+           && size >= layout.dataOffset + layout.nVertices * layout.vertexSize +
+                      layout.nFaces * layout.faceSize;
+}
+
+bool _isLittleEndian()
+{
+    const uint16_t value = 1;
+    return *reinterpret_cast< const uint8_t* >( &value ) == 1;
+}
+
+/*  Serializes the generic PLY reader, which parses using static buffers.  */
+lunchbox::Lock _plyLock;
+}
+
+/*  Read a binary little endian triangle mesh from a memory-mapped file,
+    decoding the vertex and face blocks in parallel. @return false if the file
+    needs to be read using the generic PLY reader.  */
+bool VertexData::readMappedFile( const std::string& filename )
+{
+    if( !_isLittleEndian( ))
+        return false;
+
+    lunchbox::MemoryMap file;
+    const char* data = static_cast< const char* >( file.map( filename ));
+    if( !data )
+        return false;
+
+    PlyLayout layout;
+    if( !_parseHeader( data, file.getSize(), layout ))
+        return false;
+
+    // decode vertices and colors
+    const char* vertexData = data + layout.dataOffset;
+    const bool hasColors = layout.offsets[3] >= 0;
+    vertices.resize( layout.nVertices );
+    colors.resize( hasColors ? layout.nVertices : 0 );
+
+    const ssize_t nVertices = ssize_t( layout.nVertices );
+#pragma omp parallel for
+    for( ssize_t i = 0; i < nVertices; ++i )
+    {
+        const char* vertex = vertexData + i * layout.vertexSize;
+        float xyz[3];
+        for( size_t j = 0; j < 3; ++j )
+            memcpy( &xyz[j], vertex + layout.offsets[j], sizeof( float ));
+        vertices[i] = Vertex( xyz[0], xyz[1], xyz[2] );
+
+        if( hasColors )
+        {
+            const uint8_t* rgb = reinterpret_cast< const uint8_t* >( vertex );
+            colors[i] = Color( rgb[ layout.offsets[3] ],
+                               rgb[ layout.offsets[4] ],
+                               rgb[ layout.offsets[5] ], 0 );
+        }
+    }
+
+    // decode faces, asserting that they are only triangles
+    const char* faceData = vertexData + layout.nVertices * layout.vertexSize;
+    const size_t ind1 = _invertFaces ? 2 : 0;
+    const size_t ind3 = _invertFaces ? 0 : 2;
+    triangles.resize( layout.nFaces );
+
+    const ssize_t nFaces = ssize_t( layout.nFaces );
+    ssize_t nInvalid = 0;
+#pragma omp parallel for reduction( +: nInvalid )
+    for( ssize_t i = 0; i < nFaces; ++i )
+    {
+        const char* face = faceData + i * layout.faceSize;
+        if( face[0] != 3 )
+        {
+            ++nInvalid;
+            continue;
+        }
+
+        uint32_t indices[3];
+        memcpy( indices, face + 1, sizeof( indices ));
+        triangles[i] = Triangle( indices[ind1], indices[1], indices[ind3] );
+    }
+
+    if( nInvalid == 0 )
+        return true;
+
+    // let the generic reader report the invalid faces
+    vertices.clear();
+    colors.clear();
+    triangles.clear();
+    return false;
+}
+
+
 /*  Open a PLY file and read vertex, color and index data.  */
 bool VertexData::readPlyFile( const std::string& filename )
 {
@@ -156,7 +386,11 @@ bool VertexData::readPlyFile( const std::string& filename )
     int     fileType;
     float   version;
     bool    result = false;
-    
+
+    if( readMappedFile( filename ))
+        return true;
+
+    lunchbox::ScopedMutex<> mutex( _plyLock );
     PlyFile* file = ply_open_for_reading( const_cast<char*>( filename.c_str( )),
                                           &nPlyElems, &elemNames, 
                                           &fileType, &version );
@@ -377,43 +611,63 @@ void VertexData::scale( const float baseSize )
 }
 
 
+/*  Calculate the triangle centroids used for sorting and partitioning.  */
+void VertexData::calculateCentroids()
+{
+    _centroids.resize( triangles.size( ));
+
+#pragma omp parallel for
+    for( ssize_t t = 0; t < ssize_t( triangles.size( )); ++t )
+    {
+        const Vertex& v1 = vertices[ triangles[t][0] ];
+        const Vertex& v2 = vertices[ triangles[t][1] ];
+        const Vertex& v3 = vertices[ triangles[t][2] ];
+
+        for( size_t i = 0; i < 3; ++i )
+            _centroids[t][i] = ( v1[i] + v2[i] + v3[i] ) / 3.0f;
+    }
+}
+
+
 /** @cond IGNORE */
-/*  Helper structure to sort Triangles with standard library sort function.  */
+/*  Helper structure to sort triangle indices by their precomputed centroids. */
 struct _TriangleSort
 {
-    _TriangleSort( const VertexData& data, const Axis axis ) : _data( data ),
-                                                               _axis( axis ) {}
-    
-    bool operator() ( const Triangle& t1, const Triangle& t2 )
+    _TriangleSort( const std::vector< Vertex >& centroids,
+                   const std::vector< Triangle >& triangles, const Axis axis )
+            : _centroids( centroids ), _triangles( triangles ), _axis( axis ) {}
+
+    bool operator() ( const Index t1, const Index t2 ) const
     {
-        // references to both triangles' three vertices
-        const Vertex& v11 = _data.vertices[ t1[0] ];
-        const Vertex& v12 = _data.vertices[ t1[1] ];
-        const Vertex& v13 = _data.vertices[ t1[2] ];
-        const Vertex& v21 = _data.vertices[ t2[0] ];
-        const Vertex& v22 = _data.vertices[ t2[1] ];
-        const Vertex& v23 = _data.vertices[ t2[2] ];
-        
+        const Vertex& c1 = _centroids[ t1 ];
+        const Vertex& c2 = _centroids[ t2 ];
+
         // compare first by given axis
         int axis = _axis;
         do
         {
-            // test median of 'axis' component of all three vertices
-            const float median1 = (v11[axis] + v12[axis] + v13[axis] ) / 3.0f;
-            const float median2 = (v21[axis] + v22[axis] + v23[axis] ) / 3.0f;
-            if( median1 != median2 )
-                return ( median1 < median2 );
-            
+            // test 'axis' component of both centroids
+            if( c1[axis] != c2[axis] )
+                return ( c1[axis] < c2[axis] );
+
             // if still equal, move on to the next axis
             axis = ( axis + 1 ) % 3;
         }
         while( axis != _axis );
-        
-        return false;
+
+        // identical centroids, order by vertex indices to stay deterministic
+        const Triangle& triangle1 = _triangles[ t1 ];
+        const Triangle& triangle2 = _triangles[ t2 ];
+        for( size_t i = 0; i < 3; ++i )
+            if( triangle1[i] != triangle2[i] )
+                return ( triangle1[i] < triangle2[i] );
+
+        return t1 < t2;
     }
-    
-    const VertexData&   _data;
-    const Axis          _axis;
+
+    const std::vector< Vertex >&   _centroids;
+    const std::vector< Triangle >& _triangles;
+    const Axis                     _axis;
 };
 /** @endcond */
 
@@ -422,7 +676,48 @@ void VertexData::sort( const Index start, const Index length, const Axis axis )
 {
     MESHASSERT( length > 0 );
     MESHASSERT( start + length <= triangles.size() );
-    
-    ::sort( triangles.begin() + start, triangles.begin() + start + length,
-            _TriangleSort( *this, axis ) );
+    MESHASSERT( _centroids.size() == triangles.size( ));
+
+    std::vector< Index > order( length );
+    for( Index i = 0; i < length; ++i )
+        order[i] = start + i;
+
+    ::sort( order.begin(), order.end(),
+            _TriangleSort( _centroids, triangles, axis ));
+    reorder( start, order );
+}
+
+/*  Split the index data from start to start + length at the median along the
+    given axis, without sorting both halves.  */
+void VertexData::partition( const Index start, const Index length,
+                            const Axis axis )
+{
+    MESHASSERT( length > 0 );
+    MESHASSERT( start + length <= triangles.size() );
+    MESHASSERT( _centroids.size() == triangles.size( ));
+
+    std::vector< Index > order( length );
+    for( Index i = 0; i < length; ++i )
+        order[i] = start + i;
+
+    ::nth_element( order.begin(), order.begin() + length / 2, order.end(),
+                   _TriangleSort( _centroids, triangles, axis ));
+    reorder( start, order );
+}
+
+/*  Move the triangles and their centroids to the given order.  */
+void VertexData::reorder( const Index start, const std::vector< Index >& order )
+{
+    std::vector< Triangle > sortedTriangles( order.size( ));
+    std::vector< Vertex >   sortedCentroids( order.size( ));
+    for( size_t i = 0; i < order.size(); ++i )
+    {
+        sortedTriangles[i] = triangles[ order[i] ];
+        sortedCentroids[i] = _centroids[ order[i] ];
+    }
+
+    std::copy( sortedTriangles.begin(), sortedTriangles.end(),
+               triangles.begin() + start );
+    std::copy( sortedCentroids.begin(), sortedCentroids.end(),
+               _centroids.begin() + start );
 }
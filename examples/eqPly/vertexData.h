@@ -48,7 +48,10 @@ namespace mesh
         VertexData();
 
         bool readPlyFile( const std::string& file );
+        void calculateCentroids();
         void sort( const Index start, const Index length, const Axis axis );
+        void partition( const Index start, const Index length,
+                        const Axis axis );
         void scale( const float baseSize = 2.0f );
         void calculateNormals();
         void calculateBoundingBox();
@@ -66,7 +69,10 @@ namespace mesh
         void readVertices( PlyFile* file, const int nVertices, 
                            const bool readColors );
         void readTriangles( PlyFile* file, const int nFaces );
+        bool readMappedFile( const std::string& filename );
+        void reorder( const Index start, const std::vector< Index >& order );
 
+        std::vector< Vertex > _centroids;
         BoundingBox _boundingBox;
         bool        _invertFaces;
     };
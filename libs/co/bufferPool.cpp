@@ -0,0 +1,174 @@
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "bufferPool.h"
+
+#include "global.h"
+
+#include <lunchbox/lock.h>
+#include <lunchbox/scopedMutex.h>
+
+namespace co
+{
+namespace
+{
+typedef std::vector< lunchbox::Bufferb* > Buffers;
+typedef Buffers::iterator BuffersIter;
+
+/** Buffers in class n have an allocated size in [2^n, 2^(n+1)) */
+static const size_t _nClasses = 64;
+
+struct Pool
+{
+    ~Pool() { clear(); }
+
+    void clear()
+    {
+        for( size_t i = 0; i < _nClasses; ++i )
+        {
+            for( BuffersIter j = buffers[i].begin(); j != buffers[i].end(); ++j)
+                delete *j;
+            buffers[i].clear();
+        }
+        for( BuffersIter i = shells.begin(); i != shells.end(); ++i )
+            delete *i;
+        shells.clear();
+        stats.size = 0;
+        stats.nBuffers = 0;
+    }
+
+    lunchbox::Lock lock;
+    Buffers buffers[ _nClasses ];
+    Buffers shells; //!< unused buffer objects, reused to avoid allocations
+    BufferPool::Statistics stats;
+};
+
+Pool& _getPool()
+{
+    static Pool pool;
+    return pool;
+}
+
+size_t _getClass( uint64_t size )
+{
+    size_t sizeClass = 0;
+    while( size >>= 1 )
+        ++sizeClass;
+    return sizeClass;
+}
+}
+
+void BufferPool::acquire( lunchbox::Bufferb& buffer, const uint64_t size )
+{
+    if( buffer.getMaxSize() >= size || size == 0 )
+        return;
+
+    Pool& pool = _getPool();
+    lunchbox::ScopedMutex<> mutex( pool.lock );
+
+    for( size_t i = _getClass( size ); i < _nClasses; ++i )
+    {
+        Buffers& buffers = pool.buffers[i];
+        for( BuffersIter j = buffers.begin(); j != buffers.end(); ++j )
+        {
+            lunchbox::Bufferb* pooled = *j;
+            if( pooled->getMaxSize() < size )
+                continue;
+
+            pool.stats.size -= pooled->getMaxSize();
+            --pool.stats.nBuffers;
+            ++pool.stats.hits;
+
+            // keep our old allocation, if any, in the shell for release()
+            buffers.erase( j );
+            pooled->swap( buffer );
+            if( pooled->getMaxSize() == 0 )
+                pool.shells.push_back( pooled );
+            else
+            {
+                const uint64_t oldSize = pooled->getMaxSize();
+                pooled->setSize( 0 );
+                pool.buffers[ _getClass( oldSize ) ].push_back( pooled );
+                pool.stats.size += oldSize;
+                ++pool.stats.nBuffers;
+            }
+            return;
+        }
+    }
+    ++pool.stats.misses;
+}
+
+void BufferPool::release( lunchbox::Bufferb& buffer )
+{
+    const uint64_t size = buffer.getMaxSize();
+    if( size == 0 )
+        return;
+
+    const uint64_t maxSize =
+        uint64_t( Global::getIAttribute( Global::IATTR_OBJECT_BUFFER_POOL_SIZE ))
+        * LB_1MB;
+    Pool& pool = _getPool();
+    {
+        lunchbox::ScopedMutex<> mutex( pool.lock );
+        if( pool.stats.size + size <= maxSize )
+        {
+            lunchbox::Bufferb* pooled = 0;
+            if( pool.shells.empty( ))
+                pooled = new lunchbox::Bufferb;
+            else
+            {
+                pooled = pool.shells.back();
+                pool.shells.pop_back();
+            }
+
+            pooled->swap( buffer );
+            pooled->setSize( 0 );
+            pool.buffers[ _getClass( size ) ].push_back( pooled );
+            pool.stats.size += size;
+            ++pool.stats.nBuffers;
+            ++pool.stats.released;
+            return;
+        }
+        ++pool.stats.dropped;
+    }
+    buffer.clear();
+}
+
+void BufferPool::clear()
+{
+    Pool& pool = _getPool();
+    lunchbox::ScopedMutex<> mutex( pool.lock );
+    pool.clear();
+}
+
+BufferPool::Statistics BufferPool::getStatistics()
+{
+    Pool& pool = _getPool();
+    lunchbox::ScopedMutex<> mutex( pool.lock );
+    return pool.stats;
+}
+
+std::ostream& operator << ( std::ostream& os,
+                            const BufferPool::Statistics& stats )
+{
+    return os << "BufferPool " << stats.hits << " hits, " << stats.misses
+              << " misses, " << stats.released << " released, "
+              << stats.dropped << " dropped, " << stats.nBuffers
+              << " buffers using " << stats.size / LB_1MB << " MB";
+}
+
+}
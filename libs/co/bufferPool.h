@@ -0,0 +1,79 @@
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CO_BUFFERPOOL_H
+#define CO_BUFFERPOOL_H
+
+#include <co/api.h>
+#include <co/types.h>
+
+#include <lunchbox/buffer.h>
+
+#include <iostream>
+
+namespace co
+{
+    /**
+     * A process-wide pool of reusable buffers for output data streams.
+     *
+     * Buffers released to the pool are sorted into power-of-two size classes
+     * by their allocated size. An acquired buffer is the smallest pooled buffer
+     * large enough for the requested size. The pool retains at most
+     * Global::IATTR_OBJECT_BUFFER_POOL_SIZE megabytes, further buffers are
+     * freed on release.
+     */
+    class BufferPool
+    {
+    public:
+        /** Usage statistics of the buffer pool. */
+        struct Statistics
+        {
+            Statistics() : hits( 0 ), misses( 0 ), released( 0 ), dropped( 0 )
+                         , size( 0 ), nBuffers( 0 ) {}
+
+            uint64_t hits;     //!< acquisitions served from the pool
+            uint64_t misses;   //!< acquisitions without a matching buffer
+            uint64_t released; //!< buffers retained by the pool
+            uint64_t dropped;  //!< buffers freed due to the size limit
+            uint64_t size;     //!< currently retained bytes
+            uint64_t nBuffers; //!< currently retained buffers
+        };
+
+        /**
+         * Provide a buffer with at least the given allocated size.
+         *
+         * The given buffer is swapped with a pooled buffer if its own
+         * allocation is too small. The size of the buffer is undefined
+         * afterwards.
+         */
+        CO_API static void acquire( lunchbox::Bufferb& buffer,
+                                    const uint64_t size );
+
+        /** Hand the allocation of the given buffer over to the pool. */
+        CO_API static void release( lunchbox::Bufferb& buffer );
+
+        /** Free all pooled buffers. */
+        CO_API static void clear();
+
+        /** @return the current usage statistics. */
+        CO_API static Statistics getStatistics();
+    };
+
+    CO_API std::ostream& operator << ( std::ostream& os,
+                                       const BufferPool::Statistics& stats );
+}
+
+#endif // CO_BUFFERPOOL_H
@@ -61,6 +61,8 @@ namespace co
         CMD_NODE_PING,
         CMD_NODE_PING_REPLY,
         CMD_NODE_COMMAND,
+        CMD_NODE_RELAY_INSTANCE,
+        CMD_NODE_RELAY_INSTANCE_REPLY,
         CMD_NODE_CUSTOM = 50  // some buffer for binary-compatible patches
     };
 
@@ -73,6 +75,8 @@ namespace co
         CMD_OBJECT_PUSH,
         CMD_OBJECT_OBSOLETE,
         CMD_OBJECT_MAX_VERSION,
+        CMD_OBJECT_RELAY_DONE,
+        CMD_OBJECT_SNAPSHOT,
         CMD_OBJECT_CUSTOM = 10 // some buffer for binary-compatible patches
     };
 
@@ -18,6 +18,7 @@
 
 #include "dataIStream.h"
 
+#include "command.h"
 #include "cpuCompressor.h"
 #include "log.h"
 #include "node.h"
@@ -29,6 +30,32 @@
 
 namespace co
 {
+namespace
+{
+/** Retains a received command for views into its data. */
+class CommandBuffer : public lunchbox::Referenced
+{
+public:
+    explicit CommandBuffer( Command& command ) : _command( command )
+        { _command.retain(); }
+
+protected:
+    virtual ~CommandBuffer() { _command.release(); }
+
+private:
+    Command& _command;
+};
+
+/** Owns a decompressed or copied buffer for views into its data. */
+class DataBuffer : public lunchbox::Referenced
+{
+public:
+    lunchbox::Bufferb data;
+
+protected:
+    virtual ~DataBuffer() {}
+};
+}
 
 DataIStream::DataIStream()
         : _input( 0 )
@@ -55,6 +82,7 @@ void DataIStream::_reset()
     _input     = 0;
     _inputSize = 0;
     _position  = 0;
+    _inputBuffer = 0;
 }
 
 void DataIStream::read( void* data, uint64_t size )
@@ -82,6 +110,61 @@ void DataIStream::read( void* data, uint64_t size )
     _position += size;
 }
 
+const void* DataIStream::_getView( const uint64_t size,
+                                   const size_t itemSize,
+                             lunchbox::RefPtr< lunchbox::Referenced >& buffer )
+{
+    if( !_checkBuffer( ))
+    {
+        LBUNREACHABLE;
+        LBERROR << "No more input data" << std::endl;
+        return 0;
+    }
+
+    LBASSERT( _input );
+
+    if( _position + size > _inputSize )
+    {
+        LBERROR << "Not enough data in input buffer: need " << size
+                << " bytes, " << _inputSize - _position << " left "<< std::endl;
+        LBUNREACHABLE;
+        return 0;
+    }
+
+    const uint8_t* data = _input + _position;
+    _position += size;
+
+    // items of the view have to be naturally aligned, up to eight bytes
+    const size_t alignment = LB_MIN( itemSize & ( ~itemSize + 1 ), 8 );
+    if( size_t( data ) % alignment == 0 )
+    {
+        if( !_inputBuffer && _input == _data.getData( ))
+        {
+            // hand over the decompressed buffer, the next one is reallocated
+            DataBuffer* decompressed = new DataBuffer;
+            decompressed->data.swap( _data );
+            _inputBuffer = decompressed;
+        }
+        else if( !_inputBuffer )
+        {
+            Command* command = getCurrentCommand();
+            if( command )
+                _inputBuffer = new CommandBuffer( *command );
+        }
+
+        if( _inputBuffer )
+        {
+            buffer = _inputBuffer;
+            return data;
+        }
+    }
+
+    DataBuffer* copy = new DataBuffer;
+    copy->data.replace( data, size );
+    buffer = copy;
+    return copy->data.getData();
+}
+
 const void* DataIStream::getRemainingBuffer()
 {
     if( !_checkBuffer( ))
@@ -115,6 +198,7 @@ bool DataIStream::_checkBuffer()
         if( !getNextBuffer( &compressor, &nChunks, &chunkData, &_inputSize ))
             return false;
 
+        _inputBuffer = 0;
         _input = _decompress( chunkData, compressor, nChunks, _inputSize );
         _position = 0;
     }
@@ -23,6 +23,8 @@
 #include <co/types.h>
 
 #include <lunchbox/buffer.h> // member
+#include <lunchbox/referenced.h> // member
+#include <lunchbox/refPtr.h> // member
 #include <lunchbox/types.h>
 
 #include <iostream>
@@ -34,6 +36,44 @@ namespace co
     class DataIStream
     {
     public:
+        /**
+         * A read-only view on a contiguous array of trivial items in the input
+         * data.
+         *
+         * The view retains the buffer holding the items until it is cleared or
+         * destroyed, independently of the stream it was read from.
+         */
+        template< typename T > class View
+        {
+        public:
+            View() : _data( 0 ), _size( 0 ) {}
+
+            /** @return the pointer to the first item. */
+            const T* getData() const { return _data; }
+
+            /** @return the number of items. */
+            uint64_t getSize() const { return _size; }
+
+            /** @return true if the view has no items. */
+            bool isEmpty() const { return _size == 0; }
+
+            /** @return the item at the given index. */
+            const T& operator[]( const uint64_t i ) const
+                { LBASSERT( i < _size ); return _data[ i ]; }
+
+            const T* begin() const { return _data; } //!< @return first item
+            const T* end() const { return _data + _size; } //!< @return end
+
+            /** Release the retained buffer and empty the view. */
+            void clear() { _data = 0; _size = 0; _buffer = 0; }
+
+        private:
+            const T* _data;
+            uint64_t _size;
+            lunchbox::RefPtr< lunchbox::Referenced > _buffer;
+            friend class DataIStream;
+        };
+
         /** @name Internal */
         //@{ 
         CO_API DataIStream();
@@ -67,6 +107,23 @@ namespace co
             return *this; 
         }
 
+        /**
+         * Read a std::vector of trivial items as a view without copying.
+         *
+         * The view is filled with the items written by the symmetric
+         * std::vector output operator of the DataOStream.
+         */
+        template< typename T >
+        DataIStream& operator >> ( View< T >& view )
+        {
+            uint64_t nElems = 0;
+            read( &nElems, sizeof( nElems ));
+            LBASSERTINFO( nElems < LB_BIT48,
+                  "Out-of-sync co::DataIStream: " << nElems << " elements?" );
+            view = getView< T >( nElems );
+            return *this;
+        }
+
         /**
          * Deserialize child objects.
          *
@@ -85,6 +142,27 @@ namespace co
         /** Read a number of bytes from the stream into a buffer.  */
         CO_API void read( void* data, uint64_t size );
 
+        /**
+         * Read a number of trivial items from the stream as a view.
+         *
+         * The items are not copied if the input buffer can be retained by the
+         * view, that is, if it is a decompressed buffer or if the stream
+         * implementation provides the command holding the data. Like read(),
+         * the items have to be written by a single write on the other end.
+         */
+        template< typename T > View< T > getView( const uint64_t nElems )
+        {
+            View< T > view;
+            if( nElems == 0 )
+                return view;
+
+            view._data = static_cast< const T* >(
+                _getView( nElems * sizeof( T ), sizeof( T ), view._buffer ));
+            if( view._data )
+                view._size = nElems;
+            return view;
+        }
+
         /** 
          * Get the pointer to the remaining data in the current buffer.
          *
@@ -115,6 +193,12 @@ namespace co
         virtual bool getNextBuffer( uint32_t* compressor, uint32_t* nChunks,
                                     const void** chunkData, uint64_t* size )=0;
 
+        /**
+         * @return the command holding the data of the buffer last returned by
+         *         getNextBuffer(), or 0 if views have to copy the data.
+         */
+        virtual Command* getCurrentCommand() { return 0; }
+
     private:
         /** The current input buffer */
         const uint8_t* _input;
@@ -126,12 +210,19 @@ namespace co
         CPUCompressor* const _decompressor; //!< current decompressor
         lunchbox::Bufferb _data; //!< decompressed buffer
 
+        /** The input buffer retained by views, if any */
+        lunchbox::RefPtr< lunchbox::Referenced > _inputBuffer;
+
         /**
          * Check that the current buffer has data left, get the next buffer is
          * necessary, return false if no data is left. 
          */
         CO_API bool _checkBuffer();
         CO_API void _reset();
+
+        /** @return the data for a view of size bytes, retained by buffer. */
+        CO_API const void* _getView( const uint64_t size, const size_t itemSize,
+                              lunchbox::RefPtr< lunchbox::Referenced >& buffer );
         
         const uint8_t* _decompress( const void* data, const uint32_t name,
                                     const uint32_t nChunks,
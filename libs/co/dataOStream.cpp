@@ -18,6 +18,7 @@
 
 #include "dataOStream.h"
 
+#include "bufferPool.h"
 #include "connectionDescription.h"
 #include "connections.h"
 #include "cpuCompressor.h"
@@ -57,6 +58,7 @@ DataOStream::~DataOStream()
 {
     // Can't call disable() from destructor since it uses virtual functions
     LBASSERT( !_enabled );
+    BufferPool::release( _buffer );
     delete _compressor;
 }
 
@@ -74,6 +76,8 @@ void DataOStream::_enable()
     _bufferStart = 0;
     _dataSent    = false;
     _enabled     = true;
+    BufferPool::acquire( _buffer, LB_MAX( _dataSize,
+                                          Global::getObjectBufferSize( )));
     _buffer.setSize( 0 );
 #ifndef CO_AGGRESSIVE_CACHING
     _buffer.reserve( _dataSize );
@@ -146,7 +150,7 @@ bool DataOStream::_disable()
                 // OPT: all data has been sent in one compressed chunk
                 _compressorState = STATE_COMPLETE;
 #ifndef CO_AGGRESSIVE_CACHING
-                _buffer.clear();
+                BufferPool::release( _buffer );
 #endif
             }
             else
@@ -174,7 +178,7 @@ bool DataOStream::_disable()
 
 #ifndef CO_AGGRESSIVE_CACHING
     if( !_save )
-        _buffer.clear();
+        BufferPool::release( _buffer );
 #endif
     _enabled = false;
     return true;
@@ -301,7 +305,7 @@ void DataOStream::_compress( void* src, const uint64_t size,
     if( result == STATE_COMPLETE )
     {
         LBASSERT( _buffer.getSize() == _dataSize );
-        _buffer.clear();
+        BufferPool::release( _buffer );
     }
 #endif
 }
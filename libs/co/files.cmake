@@ -6,6 +6,7 @@ set(CO_PUBLIC_HEADERS
     api.h
     barrier.h
     bufferConnection.h
+    bufferPool.h
     co.h
     command.h
     commandCache.h
@@ -85,6 +86,7 @@ set(CO_HEADERS
 set(CO_SOURCES
     barrier.cpp
     bufferConnection.cpp
+    bufferPool.cpp
     command.cpp
     commandCache.cpp
     commandQueue.cpp
@@ -111,6 +113,7 @@ set(CO_SOURCES
     objectDataOStream.cpp
     objectDeltaDataOStream.cpp
     objectInstanceDataOStream.cpp
+    objectHandler.cpp
     objectMap.cpp
     objectSlaveDataOStream.cpp
     objectStore.cpp
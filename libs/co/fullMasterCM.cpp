@@ -19,6 +19,8 @@
 
 #include "command.h"
 #include "commands.h"
+#include "global.h"
+#include "localNode.h"
 #include "log.h"
 #include "node.h"
 #include "nodePackets.h"
@@ -43,7 +45,15 @@ FullMasterCM::FullMasterCM( Object* object )
         : VersionedMasterCM( object )
         , _commitCount( 0 )
         , _nVersions( 0 )
-{}
+        , _relayID( 0 )
+{
+    object->registerCommand( CMD_OBJECT_RELAY_DONE,
+                             CmdFunc( this, &FullMasterCM::_cmdRelayDone ),
+                             object->getLocalNode()->getCommandThreadQueue( ));
+    object->registerCommand( CMD_OBJECT_SNAPSHOT,
+                             CmdFunc( this, &FullMasterCM::_cmdSnapshot ),
+                             object->getLocalNode()->getCommandThreadQueue( ));
+}
 
 FullMasterCM::~FullMasterCM()
 {
@@ -214,6 +224,9 @@ void FullMasterCM::_initSlave( NodePtr node, const uint128_t& version,
 #endif
     LBASSERT( start >= oldest );
 
+    if( _relay( node, start, end, packet, success, reply ))
+        return;
+
     bool dataSent = false;
 
     // send all instance datas from start..end
@@ -247,6 +260,9 @@ void FullMasterCM::_initSlave( NodePtr node, const uint128_t& version,
     else if( !node->multicast( reply ))
         node->send( reply );
 
+    if( dataSent && Global::getIAttribute( Global::IATTR_INSTANCE_RELAY ))
+        _relayNodes.push_back( node ); // may relay the data to later slaves
+
 #ifdef EQ_INSTRUMENT_MULTICAST
     if( _miss % 100 == 0 )
         LBINFO << "Cached " << _hit << "/" << _hit + _miss
@@ -254,6 +270,69 @@ void FullMasterCM::_initSlave( NodePtr node, const uint128_t& version,
 #endif
 }
 
+bool FullMasterCM::_relay( NodePtr node, const uint128_t& start,
+                           const uint128_t& end,
+                           const NodeMapObjectPacket* packet,
+                           NodeMapObjectSuccessPacket& success,
+                           NodeMapObjectReplyPacket& reply )
+{
+    if( !Global::getIAttribute( Global::IATTR_INSTANCE_RELAY ) ||
+        start > end || reply.useCache || node->useMulticast().isValid( ))
+    {
+        return false;
+    }
+
+    // Each slave holding the data relays it to one new slave at a time, which
+    // doubles the number of senders with each round of relays
+    NodePtr relayNode;
+    for( NodeDeque::iterator i = _relayNodes.begin(); i != _relayNodes.end(); )
+    {
+        if( !(*i)->isConnected( ))
+            i = _relayNodes.erase( i );
+        else if( *i == node )
+            ++i;
+        else
+        {
+            relayNode = *i;
+            _relayNodes.erase( i );
+            break;
+        }
+    }
+    if( !relayNode )
+        return false;
+
+    Relay& relay = _relays[ ++_relayID ];
+    relay.node = node;
+    relay.relay = relayNode;
+    relay.start = start;
+    relay.end = end;
+    relay.instanceID = packet->instanceID;
+
+    reply.relayNodeID = relayNode->getNodeID();
+    reply.relayVersion = end;
+    reply.relayID = _relayID;
+
+    node->send( success );
+    node->send( reply );
+    return true;
+}
+
+void FullMasterCM::_sendMapData( NodePtr node, const uint128_t& start,
+                                 const uint128_t& end,
+                                 const uint32_t instanceID )
+{
+    InstanceDataDeque::iterator i = _instanceDatas.begin();
+    while( i != _instanceDatas.end() && (*i)->os.getVersion() < start )
+        ++i;
+
+    if( i == _instanceDatas.end() || (*i)->os.getVersion() != start )
+        LBWARN << "Instance data v" << start << " of " << *_object
+               << " obsoleted during relay" << std::endl;
+
+    for( ; i != _instanceDatas.end() && (*i)->os.getVersion() <= end; ++i )
+        (*i)->os.sendMapData( node, instanceID );
+}
+
 void FullMasterCM::_checkConsistency() const
 {
 #ifndef NDEBUG
@@ -378,4 +457,83 @@ void FullMasterCM::push( const uint128_t& groupID, const uint128_t& typeID,
     instanceData->os.push( nodes, _object->getID(), groupID, typeID );
 }
 
+void FullMasterCM::removeSlaves( NodePtr node )
+{
+    VersionedMasterCM::removeSlaves( node );
+
+    Mutex mutex( _slaves );
+    for( NodeDeque::iterator i = _relayNodes.begin(); i != _relayNodes.end(); )
+    {
+        if( *i == node )
+            i = _relayNodes.erase( i );
+        else
+            ++i;
+    }
+
+    // A disconnected new slave will never send its relay done packet. A
+    // disconnected relay is handled by the new slave, which reports the failed
+    // relay to us.
+    for( RelayHash::iterator i = _relays.begin(); i != _relays.end(); )
+    {
+        const Relay& relay = i->second;
+        if( relay.node == node )
+        {
+            if( relay.relay != node && relay.relay->isConnected( ))
+                _relayNodes.push_back( relay.relay );
+            _relays.erase( i++ );
+        }
+        else
+            ++i;
+    }
+}
+
+//---------------------------------------------------------------------------
+// command handlers
+//---------------------------------------------------------------------------
+bool FullMasterCM::_cmdRelayDone( Command& command )
+{
+    LB_TS_THREAD( _cmdThread );
+    const ObjectRelayDonePacket* packet =
+        command.get< ObjectRelayDonePacket >();
+    Mutex mutex( _slaves );
+
+    RelayHash::iterator i = _relays.find( packet->relayID );
+    LBASSERT( i != _relays.end( ));
+    if( i == _relays.end( ))
+        return true;
+
+    const Relay relay = i->second;
+    _relays.erase( i );
+
+    if( packet->result )
+        _relayNodes.push_back( relay.relay );
+    else // relay did not have the data, send it ourselves
+        _sendMapData( relay.node, relay.start, relay.end, relay.instanceID );
+    _relayNodes.push_back( relay.node );
+    return true;
+}
+
+bool FullMasterCM::_cmdSnapshot( Command& command )
+{
+    LB_TS_THREAD( _cmdThread );
+    const ObjectSnapshotPacket* packet = command.get< ObjectSnapshotPacket >();
+    NodePtr node = command.getNode();
+    Mutex mutex( _slaves );
+
+    // The slave relies on receiving the snapshot after all versions up to the
+    // snapshot version, which only a single unicast connection guarantees.
+    if( _instanceDatas.empty() || node->useMulticast().isValid( ))
+    {
+        LBLOG( LOG_OBJECTS ) << "Ignore snapshot request from " << node
+                             << std::endl;
+        return true;
+    }
+
+    InstanceData* data = _instanceDatas.back();
+    LBLOG( LOG_OBJECTS ) << "Send snapshot v" << data->os.getVersion()
+                         << " to " << node << std::endl;
+    data->os.sendMapData( node, packet->slaveID );
+    return true;
+}
+
 }
@@ -21,6 +21,8 @@
 #include "versionedMasterCM.h"        // base class
 #include "objectInstanceDataOStream.h" // member
 
+#include <lunchbox/stdExt.h> // member
+
 #include <deque>
 
 namespace co
@@ -51,6 +53,9 @@ namespace co
 
         /** Speculatively send instance data to all nodes. */
         virtual void sendInstanceData( Nodes& nodes );
+
+        /** Remove the node from all slaves and pending relays. */
+        virtual void removeSlaves( NodePtr node );
     
     protected:
         struct InstanceData
@@ -92,10 +97,36 @@ namespace co
         InstanceDataDeque _instanceDatas;
         InstanceDatas _instanceDataCache;
 
+        /** A pending relay of instance data to a new slave. */
+        struct Relay
+        {
+            NodePtr node;        //!< the new slave node
+            NodePtr relay;       //!< the slave node relaying the data
+            uint128_t start;     //!< first relayed version
+            uint128_t end;       //!< last relayed version
+            uint32_t instanceID; //!< the new slave instance
+        };
+        typedef stde::hash_map< uint32_t, Relay > RelayHash;
+        typedef std::deque< NodePtr > NodeDeque;
+
+        /** Idle slave nodes holding the instance data, least recent first. */
+        NodeDeque _relayNodes;
+        RelayHash _relays; //!< pending relays by identifier
+        uint32_t _relayID; //!< the identifier of the last relay
+
+        bool _relay( NodePtr node, const uint128_t& start,
+                     const uint128_t& end, const NodeMapObjectPacket* packet,
+                     NodeMapObjectSuccessPacket& success,
+                     NodeMapObjectReplyPacket& reply );
+        void _sendMapData( NodePtr node, const uint128_t& start,
+                           const uint128_t& end, const uint32_t instanceID );
+
         /* The command handlers. */
         bool _cmdCommit( Command& command );
         bool _cmdObsolete( Command& command );
         bool _cmdPush( Command& command );
+        bool _cmdRelayDone( Command& command );
+        bool _cmdSnapshot( Command& command );
     };
 }
 
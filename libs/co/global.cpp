@@ -52,6 +52,14 @@ static uint32_t _getObjectBufferSize()
     return 60000;
 }
 
+static std::string _getInstanceCacheDirectory()
+{
+    const char* env = getenv( "CO_INSTANCE_CACHE_DIR" );
+    if( !env )
+        return std::string();
+    return env;
+}
+
 static int32_t _getTimeout()
 {
     const char* env = getenv( "CO_TIMEOUT" );
@@ -69,6 +77,7 @@ std::string _programName;
 std::string _workDir;
 uint16_t    _defaultPort = 0;
 uint32_t    _objectBufferSize = _getObjectBufferSize();
+std::string _instanceCacheDirectory = _getInstanceCacheDirectory();
 int32_t     _iAttributes[Global::IATTR_ALL] =
 {
     100,   // INSTANCE_CACHE_SIZE
@@ -95,7 +104,10 @@ int32_t     _iAttributes[Global::IATTR_ALL] =
     512,    // RDMA_SEND_QUEUE_DEPTH
     5000,   // RDMA_RESOLVE_TIMEOUT_MS
     1,      // IATTR_ROBUSTNESS
-    _getTimeout() // IATTR_TIMEOUT_DEFAULT
+    _getTimeout(), // IATTR_TIMEOUT_DEFAULT
+    0,      // IATTR_INSTANCE_RELAY
+    64,     // IATTR_OBJECT_BUFFER_POOL_SIZE
+    0       // IATTR_OBJECT_SNAPSHOT_THRESHOLD
 };
 }
 
@@ -182,6 +194,15 @@ uint32_t Global::getObjectBufferSize()
     return  _objectBufferSize;
 }
 
+void Global::setInstanceCacheDirectory( const std::string& directory )
+{
+    _instanceCacheDirectory = directory;
+}
+const std::string& Global::getInstanceCacheDirectory()
+{
+    return _instanceCacheDirectory;
+}
+
 PluginRegistry& Global::getPluginRegistry()
 {
     return _pluginRegistry;
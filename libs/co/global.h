@@ -72,6 +72,24 @@ namespace co
         /** @return the minimum buffer size for Object serialization. */
         CO_API static uint32_t getObjectBufferSize();
 
+        /**
+         * Set the directory for persistent object instance data.
+         *
+         * Instance data received by a node is additionally written to this
+         * directory, and read back by nodes created later on. A restarted node
+         * thereby maps unchanged objects from local storage. The default is
+         * the value of the environment variable CO_INSTANCE_CACHE_DIR, or an
+         * empty string which disables the persistent instance cache. Has to
+         * be set before the local node is created.
+         *
+         * @param directory the directory for persistent instance data.
+         */
+        CO_API static void setInstanceCacheDirectory(
+            const std::string& directory );
+
+        /** @return the directory for persistent instance data. */
+        CO_API static const std::string& getInstanceCacheDirectory();
+
         /** 
          * Set the global variables.
          *
@@ -121,6 +139,10 @@ namespace co
             IATTR_RDMA_RESOLVE_TIMEOUT_MS, //!< @internal address resolution
             IATTR_ROBUSTNESS,            //!< @internal use robustness
             IATTR_TIMEOUT_DEFAULT,       //!< @internal default timeout
+            IATTR_INSTANCE_RELAY,        //!< @internal relay map data by slaves
+            IATTR_OBJECT_BUFFER_POOL_SIZE, //!< @internal max pool size in MB
+            /** @internal queued versions triggering a snapshot request */
+            IATTR_OBJECT_SNAPSHOT_THRESHOLD,
             IATTR_ALL
         };
 
@@ -17,6 +17,7 @@
 
 #include "init.h"
 
+#include "bufferPool.h"
 #include "global.h"
 #include "node.h"
 #include "pluginRegistry.h"
@@ -118,6 +119,8 @@ bool exit()
     }
 #endif
 
+    BufferPool::clear();
+
     // de-initialize registered plugins
     PluginRegistry& plugins = Global::getPluginRegistry();
     plugins.exit();
@@ -18,47 +18,325 @@
 #include "instanceCache.h"
 
 #include "command.h"
+#include "commandCache.h"
 #include "objectDataIStream.h"
+#include "objectPackets.h"
 #include "objectVersion.h"
 
 #include <lunchbox/debug.h>
+#include <lunchbox/file.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/mtQueue.h>
 #include <lunchbox/scopedMutex.h>
+#include <lunchbox/thread.h>
+
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <sstream>
 
 namespace co
 {
-//#define EQ_INSTRUMENT_CACHE
-#ifdef EQ_INSTRUMENT_CACHE
 namespace
 {
-lunchbox::a_int32_t nRead;
-lunchbox::a_int32_t nReadHit;
-lunchbox::a_int32_t nWrite;
-lunchbox::a_int32_t nWriteHit;
-lunchbox::a_int32_t nWriteMiss;
-lunchbox::a_int32_t nWriteReady;
-lunchbox::a_int32_t nWriteOld;
-lunchbox::a_int32_t nUsedRelease;
-lunchbox::a_int32_t nUnusedRelease;
+static const uint64_t _magic = 0x436f496e7374616eull; // 'CoInstan'
+static const uint64_t _hashSeed = 0xcbf29ce484222325ull;
+
+/** The header of a persistent instance data file. */
+struct FileHeader
+{
+    uint64_t magic;
+    uint128_t identifier;
+    uint128_t version;
+    uint128_t from;
+    uint32_t masterInstanceID;
+    uint32_t fill;
+};
+
+/** A persistent instance data file found during loading. */
+struct Entry
+{
+    std::string name;
+    FileHeader header;
+};
+typedef std::map< uint128_t, Entry > Entries; //!< all versions of one object
+typedef stde::hash_map< uint128_t, Entries > EntryHash;
+
+/** FNV-1a checksum of the packets stored in a file. */
+uint64_t _hash( uint64_t hash, const void* data, const uint64_t size )
+{
+    const uint8_t* bytes = static_cast< const uint8_t* >( data );
+    for( uint64_t i = 0; i < size; ++i )
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string _getPrefix( const uint128_t& id )
+{
+    std::ostringstream name;
+    name << std::hex << std::setfill( '0' ) << std::setw( 16 ) << id.high()
+         << std::setw( 16 ) << id.low();
+    return name.str();
+}
+
+std::string _getFilename( const std::string& directory,
+                          const ObjectVersion& rev )
+{
+    return directory + '/' + _getPrefix( rev.identifier ) + '.' +
+           _getPrefix( rev.version ) + ".instance";
+}
 }
-#endif
+
+/** Appends received instance data packets to the files in the directory. */
+class InstanceCache::Writer : public lunchbox::Thread
+{
+public:
+    Writer( const std::string& directory )
+            : pending( 0 )
+            , _directory( directory )
+        {}
+
+    void write( const ObjectVersion& rev, const uint32_t instanceID,
+                const NodeID& from, Command& command )
+        {
+            command.retain();
+            ++pending;
+            _jobs.push( Job( Job::WRITE, rev, instanceID, from, &command ));
+        }
+
+    void erase( const UUID& id )
+        {
+            ++pending;
+            _jobs.push( Job( Job::ERASE, ObjectVersion( id, VERSION_NONE ),
+                             EQ_INSTANCE_INVALID, NodeID::ZERO, 0 ));
+        }
+
+    void exit()
+        {
+            ++pending;
+            _jobs.push( Job( Job::EXIT, ObjectVersion(), EQ_INSTANCE_INVALID,
+                             NodeID::ZERO, 0 ));
+        }
+
+    virtual void run()
+        {
+            for( ;; )
+            {
+                const Job job = _jobs.pop();
+                switch( job.type )
+                {
+                  case Job::WRITE:
+                      _write( job );
+                      job.command->release();
+                      break;
+
+                  case Job::ERASE:
+                      _erase( job.rev.identifier );
+                      break;
+
+                  case Job::EXIT:
+                      while( !_files.empty( ))
+                          _abort( _files.begin( ));
+                      --pending;
+                      return;
+                }
+                --pending;
+            }
+        }
+
+    lunchbox::Monitor< size_t > pending; //!< number of unprocessed jobs
+
+private:
+    struct Job
+    {
+        enum Type { WRITE, ERASE, EXIT };
+
+        Job() : type( EXIT ), instanceID( EQ_INSTANCE_INVALID ), command( 0 ){}
+        Job( const Type type_, const ObjectVersion& rev_,
+             const uint32_t instanceID_, const NodeID& from_,
+             Command* command_ )
+                : type( type_ ), rev( rev_ ), instanceID( instanceID_ )
+                , from( from_ ), command( command_ )
+            {}
+
+        Type type;
+        ObjectVersion rev;
+        uint32_t instanceID;
+        NodeID from;
+        Command* command;
+    };
+
+    /** A file being written. */
+    struct File
+    {
+        File() : file( 0 ), hash( _hashSeed ) {}
+
+        FILE* file;
+        uint128_t version;
+        uint64_t hash;
+        std::string name;
+    };
+    typedef stde::hash_map< uint128_t, File > FileHash;
+    typedef FileHash::iterator FileHashIter;
+
+    const std::string _directory;
+    lunchbox::MTQueue< Job > _jobs;
+    FileHash _files;
+
+    void _write( const Job& job )
+        {
+            const ObjectDataPacket* packet =
+                job.command->get< ObjectDataPacket >();
+            FileHashIter i = _files.find( job.rev.identifier );
+            if( i != _files.end() && i->second.version != job.rev.version )
+                _abort( i ); // incomplete previous version
+
+            i = _files.find( job.rev.identifier );
+            if( i == _files.end( ))
+            {
+                if( packet->sequence != 0 ) // missed the start of the stream
+                    return;
+
+                File file;
+                file.version = job.rev.version;
+                file.name = _getFilename( _directory, job.rev );
+                file.file = ::fopen( ( file.name + ".tmp" ).c_str(), "wb" );
+                if( !file.file )
+                {
+                    LBWARN << "Can't create " << file.name << ".tmp: "
+                           << lunchbox::sysError << std::endl;
+                    return;
+                }
+
+                FileHeader header;
+                header.magic = _magic;
+                header.identifier = job.rev.identifier;
+                header.version = job.rev.version;
+                header.from = job.from;
+                header.masterInstanceID = job.instanceID;
+                header.fill = 0;
+                if( ::fwrite( &header, sizeof( header ), 1, file.file ) != 1 )
+                {
+                    LBWARN << "Can't write " << file.name << ".tmp: "
+                           << lunchbox::sysError << std::endl;
+                    ::fclose( file.file );
+                    ::remove( ( file.name + ".tmp" ).c_str( ));
+                    return;
+                }
+                i = _files.insert( std::make_pair( job.rev.identifier,
+                                                   file )).first;
+            }
+
+            File& file = i->second;
+            const uint64_t size = packet->size;
+            file.hash = _hash( file.hash, packet, size );
+            if( ::fwrite( packet, size, 1, file.file ) != 1 )
+            {
+                LBWARN << "Can't write " << file.name << ".tmp: "
+                       << lunchbox::sysError << std::endl;
+                _abort( i );
+                return;
+            }
+
+            if( !packet->last )
+                return;
+
+            const uint64_t trailer[2] = { 0, file.hash }; // end mark, checksum
+            const bool written = ::fwrite( trailer, sizeof( trailer ), 1,
+                                           file.file ) == 1;
+            if( ::fclose( file.file ) != 0 || !written )
+            {
+                LBWARN << "Can't write " << file.name << ".tmp: "
+                       << lunchbox::sysError << std::endl;
+                ::remove( ( file.name + ".tmp" ).c_str( ));
+            }
+            else
+            {
+                ::remove( file.name.c_str( ));
+                if( ::rename( ( file.name + ".tmp" ).c_str(),
+                              file.name.c_str( )) != 0 )
+                {
+                    LBWARN << "Can't rename " << file.name << ".tmp: "
+                           << lunchbox::sysError << std::endl;
+                }
+            }
+            _files.erase( i );
+        }
+
+    void _abort( FileHashIter i )
+        {
+            const File& file = i->second;
+            ::fclose( file.file );
+            ::remove( ( file.name + ".tmp" ).c_str( ));
+            _files.erase( i );
+        }
+
+    void _erase( const uint128_t& id )
+        {
+            FileHashIter i = _files.find( id );
+            if( i != _files.end( ))
+                _abort( i );
+
+            const Strings files = lunchbox::searchDirectory( _directory,
+                                             _getPrefix( id ) + ".*.instance" );
+            for( StringsCIter j = files.begin(); j != files.end(); ++j )
+                ::remove( ( _directory + '/' + *j ).c_str( ));
+        }
+};
 
 const InstanceCache::Data InstanceCache::Data::NONE;
 
-InstanceCache::InstanceCache( const uint64_t maxSize )
+InstanceCache::InstanceCache( const uint64_t maxSize,
+                              const std::string& directory )
         : _maxSize( maxSize )
         , _size( 0 )
-{}
+        , _directory( directory )
+        , _writer( 0 )
+        , _commandCache( 0 )
+{
+    if( _directory.empty( ))
+        return;
+
+    _commandCache = new CommandCache;
+    _load();
+
+    _writer = new Writer( _directory );
+    if( !_writer->start( ))
+    {
+        LBWARN << "Can't start instance data writer, not writing to "
+               << _directory << std::endl;
+        delete _writer;
+        _writer = 0;
+    }
+}
 
 InstanceCache::~InstanceCache()
 {
-    for( ItemHash::iterator i = _items->begin(); i != _items->end(); ++i )
+    if( _writer )
     {
-        Item& item = i->second;
-        _releaseStreams( item );
+        _writer->exit();
+        _writer->join();
+        delete _writer;
+        _writer = 0;
     }
 
-    _items->clear();
-    _size = 0;
+    for( size_t i = 0; i < NUM_SHARDS; ++i )
+    {
+        Shard& shard = _shards[ i ];
+        for( ItemHashIter j = shard.items.begin(); j != shard.items.end(); ++j )
+            _releaseStreams( j->second );
+
+        shard.items.clear();
+        shard.lru.clear();
+    }
+    LBASSERT( int64_t( _size ) == 0 );
+
+    delete _commandCache;
+    _commandCache = 0;
 }
 
 InstanceCache::Data::Data() 
@@ -77,30 +355,91 @@ bool InstanceCache::Data::operator == ( const InstanceCache::Data& rhs ) const
              versions == rhs.versions );
 }
 
+InstanceCache::Statistics::Statistics()
+        : reads( 0 )
+        , readHits( 0 )
+        , writes( 0 )
+        , writeHits( 0 )
+        , writeOld( 0 )
+        , writeDups( 0 )
+        , evictions( 0 )
+{}
+
 InstanceCache::Item::Item()
         : used( 0 )
         , access( 0 )
+        , pinned( false )
+        , touched( 0 )
 {}
 
+InstanceCache::Shard& InstanceCache::_getShard( const lunchbox::uint128_t& id )
+{
+    return _shards[ ( id.high() ^ id.low( )) % NUM_SHARDS ];
+}
+
 bool InstanceCache::add( const ObjectVersion& rev, const uint32_t instanceID,
                          Command& command, const uint32_t usage )
 {
-#ifdef EQ_INSTRUMENT_CACHE
-    ++nWrite;
-#endif
-
     const NodeID nodeID = command.getNode()->getNodeID();
+    if( !_add( rev, instanceID, nodeID, command, usage ))
+        return false;
+
+    if( _writer )
+        _writer->write( rev, instanceID, nodeID, command );
+    _releaseItems();
+    return true;
+}
+
+bool InstanceCache::add( const ObjectVersion& rev, const uint32_t instanceID,
+                         const NodeID& from, Command& command, const bool pin )
+{
+    if( !_add( rev, instanceID, from, command, 0, pin ))
+        return false;
 
-    lunchbox::ScopedMutex<> mutex( _items );
-    ItemHash::const_iterator i = _items->find( rev.identifier );
-    if( i == _items->end( ))
+    if( _writer )
+        _writer->write( rev, instanceID, from, command );
+    _releaseItems();
+    return true;
+}
+
+bool InstanceCache::unpin( const UUID& id )
+{
     {
-        Item& item = _items.data[ rev.identifier ];
+        Shard& shard = _getShard( id );
+        lunchbox::ScopedMutex<> mutex( shard.lock );
+
+        ItemHashIter i = shard.items.find( id );
+        if( i == shard.items.end() || !i->second.pinned )
+            return false;
+
+        Item& item = i->second;
+        LBASSERT( item.access > 0 );
+        item.pinned = false;
+        --item.access;
+    }
+    _releaseItems();
+    return true;
+}
+
+bool InstanceCache::_add( const ObjectVersion& rev, const uint32_t instanceID,
+                          const NodeID& nodeID, Command& command,
+                          const uint32_t usage, const bool pin )
+{
+    Shard& shard = _getShard( rev.identifier );
+    lunchbox::ScopedMutex<> mutex( shard.lock );
+    ++shard.statistics.writes;
+
+    ItemHashIter i = shard.items.find( rev.identifier );
+    if( i == shard.items.end( ))
+    {
+        Item& item = shard.items[ rev.identifier ];
         item.data.masterInstanceID = instanceID;
         item.from = nodeID;
+        item.lru = shard.lru.insert( shard.lru.begin(), rev.identifier );
+        i = shard.items.find( rev.identifier );
     }
 
-    Item& item = _items.data[ rev.identifier ] ;
+    Item& item = i->second;
     if( item.data.masterInstanceID != instanceID || item.from != nodeID )
     {
         LBASSERT( !item.access ); // same master with different instance ID?!
@@ -115,6 +454,12 @@ bool InstanceCache::add( const ObjectVersion& rev, const uint32_t instanceID,
     else
         item.used = LB_MAX( item.used, usage );
 
+    if( pin && !item.pinned )
+    {
+        item.pinned = true;
+        ++item.access;
+    }
+
     if( item.data.versions.empty( ))
     {
         item.data.versions.push_back( new ObjectDataIStream ); 
@@ -124,9 +469,7 @@ bool InstanceCache::add( const ObjectVersion& rev, const uint32_t instanceID,
     {
         if( item.data.versions.back()->isReady( ))
         {
-#ifdef EQ_INSTRUMENT_CACHE
-            ++nWriteReady;
-#endif
+            ++shard.statistics.writeDups;
             return false; // Already have stream
         }
         // else append data to stream
@@ -139,9 +482,7 @@ bool InstanceCache::add( const ObjectVersion& rev, const uint32_t instanceID,
         const uint128_t previousVersion = previous->getPendingVersion();
         if( previousVersion > rev.version )
         {
-#ifdef EQ_INSTRUMENT_CACHE
-            ++nWriteOld;
-#endif
+            ++shard.statistics.writeOld;
             return false;
         }
         if( ( previousVersion + 1 ) != rev.version ) // hole
@@ -167,97 +508,133 @@ bool InstanceCache::add( const ObjectVersion& rev, const uint32_t instanceID,
     stream->addDataPacket( command );
     
     if( stream->isReady( ))
-        _size += stream->getDataSize();
+        _size += int64_t( stream->getDataSize( ));
 
-    _releaseItems( 1 );
-    _releaseItems( 0 );
-
-#ifdef EQ_INSTRUMENT_CACHE
-    if( _items->find( rev.identifier ) != _items->end( ))
-        ++nWriteHit;
-    else
-        ++nWriteMiss;
-#endif
+    ++shard.statistics.writeHits;
+    _touch( shard, item );
     return true;
 }
 
 void InstanceCache::remove( const NodeID& nodeID )
 {
-    std::vector< lunchbox::uint128_t > keys;
-
-    lunchbox::ScopedMutex<> mutex( _items );
-    for( ItemHash::iterator i = _items->begin(); i != _items->end(); ++i )
+    for( size_t i = 0; i < NUM_SHARDS; ++i )
     {
-        Item& item = i->second;
-        if( item.from != nodeID )
-            continue;
-
-        LBASSERT( !item.access );
-        if( item.access != 0 )
-            continue;
+        Shard& shard = _shards[ i ];
+        lunchbox::ScopedMutex<> mutex( shard.lock );
 
-        _releaseStreams( item );
-        keys.push_back( i->first );
-    }
+        for( ItemHashIter j = shard.items.begin(); j != shard.items.end(); )
+        {
+            Item& item = j->second;
+            const unsigned pins = item.pinned ? 1 : 0;
+            LBASSERT( item.from != nodeID || item.access == pins );
+            if( item.from != nodeID || item.access != pins )
+            {
+                ++j;
+                continue;
+            }
 
-    for( std::vector< lunchbox::uint128_t >::const_iterator i = keys.begin();
-         i != keys.end(); ++i )
-    {
-        _items->erase( *i );
+            item.pinned = false; // the master is gone, nothing left to relay
+            item.access = 0;
+            _releaseStreams( item );
+            _erase( shard, j++ );
+        }
     }
 }
 
 const InstanceCache::Data& InstanceCache::operator[]( const UUID& id )
 {
-#ifdef EQ_INSTRUMENT_CACHE
-    ++nRead;
-#endif
+    Shard& shard = _getShard( id );
+    lunchbox::ScopedMutex<> mutex( shard.lock );
+    ++shard.statistics.reads;
 
-    lunchbox::ScopedMutex<> mutex( _items );
-    ItemHash::iterator i = _items->find( id );
-    if( i == _items->end( ))
+    ItemHashIter i = shard.items.find( id );
+    if( i == shard.items.end( ))
         return Data::NONE;
 
     Item& item = i->second;
     LBASSERT( !item.data.versions.empty( ));
     ++item.access;
     ++item.used;
-
-#ifdef EQ_INSTRUMENT_CACHE
-    ++nReadHit;
-#endif
+    ++shard.statistics.readHits;
+    _touch( shard, item );
     return item.data;
 }
 
 bool InstanceCache::release( const UUID& id, const uint32_t count )
 {
-    lunchbox::ScopedMutex<> mutex( _items );
-    ItemHash::iterator i = _items->find( id );
-    if( i == _items->end( ))
-        return false;
+    {
+        Shard& shard = _getShard( id );
+        lunchbox::ScopedMutex<> mutex( shard.lock );
 
-    Item& item = i->second;
-    LBASSERT( !item.data.versions.empty( ));
-    LBASSERT( item.access >= count );
+        ItemHashIter i = shard.items.find( id );
+        if( i == shard.items.end( ))
+            return false;
+
+        Item& item = i->second;
+        LBASSERT( !item.data.versions.empty( ));
+        LBASSERT( item.access >= count );
 
-    item.access -= count;
-    _releaseItems( 1 );
+        item.access -= count;
+    }
+    _releaseItems();
     return true;
 }
 
 bool InstanceCache::erase( const UUID& id )
 {
-    lunchbox::ScopedMutex<> mutex( _items );
-    ItemHash::iterator i = _items->find( id );
-    if( i == _items->end( ))
+    if( _writer )
+        _writer->erase( id );
+
+    Shard& shard = _getShard( id );
+    lunchbox::ScopedMutex<> mutex( shard.lock );
+
+    ItemHashIter i = shard.items.find( id );
+    if( i == shard.items.end( ))
         return false;
 
     Item& item = i->second;
-    if( item.access != 0 )
+    if( item.access != ( item.pinned ? 1u : 0u ))
         return false;
 
+    item.pinned = false;
+    item.access = 0;
     _releaseStreams( item );
-    _items->erase( i );
+    _erase( shard, i );
+    return true;
+}
+
+uint64_t InstanceCache::getSize() const
+{
+    return uint64_t( int64_t( _size ));
+}
+
+InstanceCache::Statistics InstanceCache::getStatistics() const
+{
+    Statistics statistics;
+    for( size_t i = 0; i < NUM_SHARDS; ++i )
+    {
+        const Shard& shard = _shards[ i ];
+        lunchbox::ScopedMutex<> mutex( shard.lock );
+        statistics.reads += shard.statistics.reads;
+        statistics.readHits += shard.statistics.readHits;
+        statistics.writes += shard.statistics.writes;
+        statistics.writeHits += shard.statistics.writeHits;
+        statistics.writeOld += shard.statistics.writeOld;
+        statistics.writeDups += shard.statistics.writeDups;
+        statistics.evictions += shard.statistics.evictions;
+    }
+    return statistics;
+}
+
+bool InstanceCache::isEmpty() const
+{
+    for( size_t i = 0; i < NUM_SHARDS; ++i )
+    {
+        const Shard& shard = _shards[ i ];
+        lunchbox::ScopedMutex<> mutex( shard.lock );
+        if( !shard.items.empty( ))
+            return false;
+    }
     return true;
 }
 
@@ -267,29 +644,167 @@ void InstanceCache::expire( const int64_t timeout )
     if( time <= 0 )
         return;
 
-    std::vector< lunchbox::uint128_t > keys;
+    for( size_t i = 0; i < NUM_SHARDS; ++i )
+    {
+        Shard& shard = _shards[ i ];
+        lunchbox::ScopedMutex<> mutex( shard.lock );
+
+        for( ItemHashIter j = shard.items.begin(); j != shard.items.end(); )
+        {
+            Item& item = j->second;
+            if( item.access != 0 )
+            {
+                ++j;
+                continue;
+            }
 
-    lunchbox::ScopedMutex<> mutex( _items );
-    for( ItemHash::iterator i = _items->begin(); i != _items->end(); ++i )
+            _releaseStreams( item, time );
+            if( item.data.versions.empty( ))
+                _erase( shard, j++ );
+            else
+                ++j;
+        }
+    }
+}
+
+void InstanceCache::flush()
+{
+    if( _writer )
+        _writer->pending.waitEQ( 0 );
+}
+
+void InstanceCache::_load()
+{
+    // Read all headers, sorted by object and version
+    EntryHash entries;
+    const Strings files = lunchbox::searchDirectory( _directory, "*.instance" );
+    for( StringsCIter i = files.begin(); i != files.end(); ++i )
     {
-        Item& item = i->second;
-        if( item.access != 0 )
+        Entry entry;
+        entry.name = _directory + '/' + *i;
+
+        FILE* file = ::fopen( entry.name.c_str(), "rb" );
+        if( !file )
             continue;
+        const bool valid =
+            ::fread( &entry.header, sizeof( FileHeader ), 1, file ) == 1 &&
+            entry.header.magic == _magic;
+        ::fclose( file );
 
-        _releaseStreams( item, time );
-        if( item.data.versions.empty( ))
-            keys.push_back( i->first );
+        if( valid )
+            entries[ entry.header.identifier ][ entry.header.version ] = entry;
+        else
+            ::remove( entry.name.c_str( ));
     }
 
-    for( std::vector< lunchbox::uint128_t >::const_iterator i = keys.begin();
-         i != keys.end(); ++i )
+    size_t nLoaded = 0;
+    for( EntryHash::const_iterator i = entries.begin(); i != entries.end(); ++i)
     {
-        _items->erase( *i );
+        // Only the newest consecutive versions from one master are usable
+        const Entries& versions = i->second;
+        std::vector< const Entry* > usable; // newest first
+        for( Entries::const_reverse_iterator j = versions.rbegin();
+             j != versions.rend(); ++j )
+        {
+            const FileHeader& header = j->second.header;
+            const FileHeader* next = usable.empty() ? 0 :
+                                                      &usable.back()->header;
+            if( !next || ( header.masterInstanceID == next->masterInstanceID &&
+                           header.from == next->from &&
+                           header.version + 1 == next->version ))
+            {
+                usable.push_back( &j->second );
+            }
+            else
+                ::remove( j->second.name.c_str( ));
+        }
+
+        for( std::vector< const Entry* >::const_reverse_iterator j =
+                 usable.rbegin(); j != usable.rend(); ++j ) // oldest first
+        {
+            const Entry& entry = **j;
+            FILE* file = ::fopen( entry.name.c_str(), "rb" );
+            if( !file )
+                break;
+
+            Commands commands;
+            uint64_t hash = _hashSeed;
+            bool valid = ::fseek( file, sizeof( FileHeader ), SEEK_SET ) == 0;
+            while( valid )
+            {
+                uint64_t size = 0;
+                valid = ::fread( &size, sizeof( size ), 1, file ) == 1;
+                if( !valid || size == 0 ) // end mark, compare checksum
+                {
+                    uint64_t checksum = 0;
+                    valid = valid && !commands.empty() &&
+                            ::fread( &checksum, sizeof( checksum ), 1, file )
+                                == 1 &&
+                            checksum == hash;
+                    break;
+                }
+                valid = size >= sizeof( ObjectDataPacket ) && size < LB_BIT48;
+                if( !valid )
+                    break;
+
+                // retain until added, free commands are reused by alloc()
+                Command& command = _commandCache->alloc( 0, 0, size );
+                command.retain();
+                commands.push_back( &command );
+
+                uint8_t* data = reinterpret_cast< uint8_t* >(
+                    command.getModifiable< Packet >( ));
+                valid = ::fread( data + sizeof( size ), size - sizeof( size ),
+                                 1, file ) == 1;
+                hash = _hash( hash, data, size );
+            }
+            ::fclose( file );
+
+            valid = valid && commands.back()->get< ObjectDataPacket >()->last;
+            if( valid )
+            {
+                const ObjectVersion rev( UUID( entry.header.identifier ),
+                                         entry.header.version );
+                const NodeID from( entry.header.from );
+                for( CommandsCIter k = commands.begin(); k != commands.end();
+                     ++k )
+                {
+                    _add( rev, entry.header.masterInstanceID, from, **k, 0 );
+                }
+                ++nLoaded;
+            }
+
+            for( CommandsCIter k = commands.begin(); k != commands.end(); ++k )
+                (*k)->release();
+
+            if( !valid )
+            {
+                LBWARN << "Ignoring corrupt instance data " << entry.name
+                       << std::endl;
+                ::remove( entry.name.c_str( ));
+                break;
+            }
+        }
     }
+
+    _releaseItems();
+    LBINFO << "Loaded " << nLoaded << " instance data versions of "
+           << entries.size() << " objects from " << _directory << std::endl;
 }
 
-void InstanceCache::_releaseStreams( InstanceCache::Item& item, 
-                                     const int64_t minTime )
+void InstanceCache::_touch( Shard& shard, Item& item )
+{
+    shard.lru.splice( shard.lru.begin(), shard.lru, item.lru );
+    item.touched = _clock.getTime64();
+}
+
+void InstanceCache::_erase( Shard& shard, ItemHashIter i )
+{
+    shard.lru.erase( i->second.lru );
+    shard.items.erase( i );
+}
+
+void InstanceCache::_releaseStreams( Item& item, const int64_t minTime )
 {
     LBASSERT( item.access == 0 );
     while( !item.data.versions.empty() && item.times.front() <= minTime &&
@@ -299,10 +814,9 @@ void InstanceCache::_releaseStreams( InstanceCache::Item& item,
     }
 }
 
-void InstanceCache::_releaseStreams( InstanceCache::Item& item )
+void InstanceCache::_releaseStreams( Item& item )
 {
     LBASSERT( item.access == 0 );
-    LBASSERT( !item.data.versions.empty( ));
 
     while( !item.data.versions.empty( ))
     {
@@ -313,9 +827,9 @@ void InstanceCache::_releaseStreams( InstanceCache::Item& item )
     item.times.clear();
 }            
 
-void InstanceCache::_releaseFirstStream( InstanceCache::Item& item )
+void InstanceCache::_releaseFirstStream( Item& item )
 {
-    LBASSERT( item.access == 0 );
+    LBASSERT( item.access == ( item.pinned ? 1u : 0u ));
     LBASSERT( !item.data.versions.empty( ));
     if( item.data.versions.empty( ))
         return;
@@ -328,97 +842,96 @@ void InstanceCache::_releaseFirstStream( InstanceCache::Item& item )
 
 void InstanceCache::_deleteStream( ObjectDataIStream* stream )
 {
-    LBASSERT( stream->isReady( ));
-    LBASSERT( _size >= stream->getDataSize( ));
-
-    _size -= stream->getDataSize();
+    if( stream->isReady( ))
+    {
+        LBASSERT( int64_t( _size ) >= int64_t( stream->getDataSize( )));
+        _size -= int64_t( stream->getDataSize( ));
+    }
     delete stream;
 }
 
-void InstanceCache::_releaseItems( const uint32_t minUsage )
+InstanceCache::ItemHashIter InstanceCache::_findLRU( Shard& shard )
 {
-    if( _size <= _maxSize )
-        return;
-
-    LB_TS_SCOPED( _thread );
-
-    std::vector< lunchbox::uint128_t > keys;
-    const uint64_t target = uint64_t( float( _maxSize ) * 0.8f );
-
-    // Release used items (first stream)
-    bool streamsLeft = false;
-    for( ItemHashIter i = _items->begin();
-         i != _items->end() && _size > target; ++i )
+    for( LRUList::reverse_iterator i = shard.lru.rbegin();
+         i != shard.lru.rend(); ++i )
     {
-        Item& item = i->second;
-        LBASSERT( !item.data.versions.empty( ));
-
-        if( item.access == 0 && item.used >= minUsage )
+        ItemHashIter j = shard.items.find( *i );
+        LBASSERT( j != shard.items.end( ));
+        // A pinned item is not accessed otherwise, but keeps its latest version
+        const Item& item = j->second;
+        const unsigned pins = item.pinned ? 1 : 0;
+        if( item.access == pins && item.data.versions.size() > pins &&
+            item.data.versions.front()->isReady( ))
         {
-            _releaseFirstStream( item );
-            if( !item.data.versions.empty( ))
-                streamsLeft = true;
-
-            keys.push_back( i->first );
-#ifdef EQ_INSTRUMENT_CACHE
-            ++nUsedRelease;
-#endif
+            return j;
         }
     }
+    return shard.items.end();
+}
 
-    // release used items (second..n streams)
-    while( streamsLeft && _size > target )
-    {
-        streamsLeft = false;
+void InstanceCache::_releaseItems()
+{
+    if( int64_t( _size ) <= int64_t( _maxSize ))
+        return;
 
-        for( std::vector< lunchbox::uint128_t >::const_iterator i = keys.begin();
-             i != keys.end() && _size > target; ++i )
-        {
-            Item& item = _items.data[ *i ];
+    lunchbox::ScopedMutex<> releaseMutex( _releaseLock );
 
-            if( !item.data.versions.empty() && item.access == 0 && 
-                item.used >= minUsage )
+    // Release the oldest stream of the least recently used, unpinned item of
+    // all shards until the cache is below the target size. Only one shard
+    // lock is held at any time.
+    const int64_t target = int64_t( float( _maxSize ) * 0.8f );
+    while( int64_t( _size ) > target )
+    {
+        Shard* oldest = 0;
+        int64_t oldestTime = std::numeric_limits< int64_t >::max();
+        for( size_t i = 0; i < NUM_SHARDS; ++i )
+        {
+            Shard& shard = _shards[ i ];
+            lunchbox::ScopedMutex<> mutex( shard.lock );
+            ItemHashIter j = _findLRU( shard );
+            if( j != shard.items.end() && j->second.touched < oldestTime )
             {
-                _releaseFirstStream( item );
-                if( !item.data.versions.empty( ))
-                    streamsLeft = true;
-#ifdef EQ_INSTRUMENT_CACHE
-                ++nUsedRelease;
-#endif
+                oldest = &shard;
+                oldestTime = j->second.touched;
             }
         }
-    }
 
-    for( std::vector< lunchbox::uint128_t >::const_iterator i = keys.begin();
-         i != keys.end(); ++i )
-    {
-        Item& item = _items.data[ *i ];
+        if( !oldest )
+        {
+            LBWARN << "Overfull instance cache, too many pinned items, size "
+                   << int64_t( _size ) << " target " << target << std::endl;
+            return;
+        }
+
+        lunchbox::ScopedMutex<> mutex( oldest->lock );
+        ItemHashIter j = _findLRU( *oldest ); // may have changed meanwhile
+        if( j == oldest->items.end( ))
+            continue;
+
+        Item& item = j->second;
+        _releaseFirstStream( item );
+        ++oldest->statistics.evictions;
         if( item.data.versions.empty( ))
-            _items->erase( *i );
+            _erase( *oldest, j );
     }
+}
 
-    if( _size > target && minUsage == 0 )
-        LBWARN << "Overfull instance cache, too many pinned items, size "
-               << _size << " target " << target << " max " << _maxSize
-               << " " << _items->size() << " entries"
-#ifdef EQ_INSTRUMENT_CACHE
-               << ": " << *this
-#endif
-               << std::endl;
+std::ostream& operator << ( std::ostream& os,
+                            const InstanceCache::Statistics& statistics )
+{
+    os << statistics.readHits << "/" << statistics.reads << " reads, "
+       << statistics.writeHits << "/" << statistics.writes << " writes ("
+       << statistics.writeOld << " old, " << statistics.writeDups << " dups) "
+       << statistics.evictions << " evictions";
+    return os;
 }
 
 std::ostream& operator << ( std::ostream& os,
                             const InstanceCache& instanceCache )
 {
     os << "InstanceCache " << instanceCache.getSize() / 1048576 << "/" 
-       << instanceCache.getMaxSize() / 1048576 << " MB"
-#ifdef EQ_INSTRUMENT_CACHE
-       << ", " << nReadHit << "/" << nRead << " reads, " << nWriteHit
-       << "/" << nWrite << " writes (" << nWriteMiss << " misses, " << nWriteOld
-       << " old, " << nWriteReady << " dups) " << nUsedRelease << " used, "
-       << nUnusedRelease << " unused releases"
-#endif
-        ;
+       << instanceCache.getMaxSize() / 1048576 << " MB, "
+       << instanceCache.getStatistics();
     return os;
 }
 
@@ -21,23 +21,45 @@
 #include <co/api.h>
 #include <co/types.h>
 
+#include <lunchbox/atomic.h>    // member
 #include <lunchbox/clock.h>     // member
 #include <lunchbox/lock.h>      // member
-#include <lunchbox/lockable.h>  // member
 #include <lunchbox/stdExt.h>    // member
-#include <lunchbox/thread.h>    // member
 #include <lunchbox/uuid.h>      // member
 
 #include <iostream>
+#include <list>
+#include <string>
 
 namespace co
 {
-    /** @internal A thread-safe cache for object instance data. */
+    class CommandCache;
+
+    /**
+     * @internal A thread-safe cache for object instance data.
+     *
+     * The cache is split into shards by object identifier, each with its own
+     * lock for its items and LRU list. The size is accounted globally, when
+     * it exceeds the maximum size the least recently used, unpinned instance
+     * data of all shards is released.
+     *
+     * Optionally, all received instance data is also written asynchronously
+     * to a directory, and the data found in this directory is loaded when the
+     * cache is created. Each version is stored in its own file together with
+     * the master instance and node identifiers and a checksum of its content.
+     */
     class InstanceCache
     {
     public:
-        /** Construct a new instance cache. */
-        CO_API InstanceCache( const uint64_t maxSize = LB_100MB );
+        /**
+         * Construct a new instance cache.
+         *
+         * @param maxSize the maximum number of bytes kept in memory.
+         * @param directory the directory for persistent instance data, or an
+         *                  empty string to keep the data only in memory.
+         */
+        CO_API InstanceCache( const uint64_t maxSize = LB_100MB,
+                              const std::string& directory = std::string( ));
 
         /** Destruct this instance cache. */
         CO_API ~InstanceCache();
@@ -54,6 +76,30 @@ namespace co
         CO_API bool add( const ObjectVersion& rev, const uint32_t instanceID, 
                          Command& command, const uint32_t usage = 0 );
 
+        /**
+         * Add a new command of the given master node to the instance cache.
+         *
+         * A pinned item keeps its latest version until unpin() is called,
+         * regardless of the maximum size of the cache.
+         *
+         * @param rev the object identifier and version.
+         * @param instanceID the master instance ID.
+         * @param from the master node of the object.
+         * @param command The command to add.
+         * @param pin true to pin the item of the object.
+         * @return true if the command was entered, false if not.
+         */
+        CO_API bool add( const ObjectVersion& rev, const uint32_t instanceID,
+                         const NodeID& from, Command& command,
+                         const bool pin );
+
+        /**
+         * Unpin the item of the given object pinned by add().
+         *
+         * @return true if the item was unpinned, false if it is not pinned.
+         */
+        CO_API bool unpin( const UUID& id );
+
         /** Remove all items from the given node. */
         void remove( const NodeID& node );
 
@@ -69,6 +115,20 @@ namespace co
             CO_API static const Data NONE; //!< '0' return value 
         };
 
+        /** Usage counters of the instance cache. */
+        struct Statistics
+        {
+            Statistics();
+
+            uint64_t reads;     //!< lookups
+            uint64_t readHits;  //!< lookups returning cached data
+            uint64_t writes;    //!< add() calls
+            uint64_t writeHits; //!< add() calls which stored data
+            uint64_t writeOld;  //!< add() calls with an outdated version
+            uint64_t writeDups; //!< add() calls for an already cached version
+            uint64_t evictions; //!< streams released to honor the maximum size
+        };
+
         /**
          * Direct access to the cached instance data for the given object id.
          *
@@ -104,49 +164,83 @@ namespace co
         CO_API bool erase( const UUID& id );
 
         /** @return the number of bytes used by the instance cache. */
-        uint64_t getSize() const { return _size; }
+        CO_API uint64_t getSize() const;
 
         /** @return the maximum number of bytes used by the instance cache. */
         uint64_t getMaxSize() const { return _maxSize; }
 
+        /** @return the accumulated usage counters of all shards. */
+        CO_API Statistics getStatistics() const;
+
         /** Remove all items which are older than the given time. */
         void expire( const int64_t age );
 
-        bool isEmpty() { return _items->empty(); }
+        /** Wait until all instance data has been written to the directory. */
+        CO_API void flush();
+
+        CO_API bool isEmpty() const;
 
     private:
+        typedef std::list< lunchbox::uint128_t > LRUList;
+
         struct Item
         {
             Item();
             Data data;
             unsigned used;
             unsigned access;
+            bool pinned; //!< pinned by add(), counted in access
             NodeID from;
 
             typedef std::deque< int64_t > TimeDeque;
             TimeDeque times;
+
+            LRUList::iterator lru; //!< position in the shard's LRU list
+            int64_t touched;       //!< time of the last use
         };
 
         typedef stde::hash_map< lunchbox::uint128_t, Item > ItemHash;
         typedef ItemHash::iterator ItemHashIter;
-        lunchbox::Lockable< ItemHash > _items;
+
+        struct Shard
+        {
+            mutable lunchbox::Lock lock;
+            ItemHash items;
+            LRUList lru;           //!< item identifiers, most recent first
+            Statistics statistics;
+        };
+
+        enum { NUM_SHARDS = 16 };
+        Shard _shards[ NUM_SHARDS ];
 
         const uint64_t _maxSize; //!<high-water mark to start releasing commands
-        uint64_t _size;          //!< Current number of bytes stored
+        lunchbox::Atomic< int64_t > _size; //!< bytes stored in all shards
+        lunchbox::Lock _releaseLock;   //!< serializes _releaseItems
 
         const lunchbox::Clock _clock;  //!< Clock for item expiration
 
-        void _releaseItems( const uint32_t minUsage );
-        void _releaseStreams( InstanceCache::Item& item );
-        void _releaseStreams( InstanceCache::Item& item, 
-                              const int64_t minTime );
-        void _releaseFirstStream( InstanceCache::Item& item );
+        const std::string _directory;  //!< persistent instance data, optional
+        class Writer;
+        Writer* _writer;               //!< writes instance data to _directory
+        CommandCache* _commandCache;   //!< commands of loaded instance data
+
+        Shard& _getShard( const lunchbox::uint128_t& id );
+        bool _add( const ObjectVersion& rev, const uint32_t instanceID,
+                   const NodeID& nodeID, Command& command,
+                   const uint32_t usage, const bool pin = false );
+        void _load();
+        void _touch( Shard& shard, Item& item );
+        void _erase( Shard& shard, ItemHashIter i );
+        ItemHashIter _findLRU( Shard& shard );
+        void _releaseItems();
+        void _releaseStreams( Item& item );
+        void _releaseStreams( Item& item, const int64_t minTime );
+        void _releaseFirstStream( Item& item );
         void _deleteStream( ObjectDataIStream* iStream );
-
-        LB_TS_VAR( _thread );
     };
 
+    CO_API std::ostream& operator << ( std::ostream&,
+                                       const InstanceCache::Statistics& );
     CO_API std::ostream& operator << ( std::ostream&, const InstanceCache& );
 }
 #endif //CO_INSTANCECACHE_H
-
@@ -704,6 +704,21 @@ void LocalNode::expireInstanceData( const int64_t age )
     _impl->objectStore->expireInstanceData( age );
 }
 
+const InstanceCache* LocalNode::getInstanceCache() const
+{
+    return _impl->objectStore->getInstanceCache();
+}
+
+uint32_t LocalNode::getRelayHits() const
+{
+    return _impl->objectStore->getRelayHits();
+}
+
+uint32_t LocalNode::getRelayMisses() const
+{
+    return _impl->objectStore->getRelayMisses();
+}
+
 void LocalNode::enableSendOnRegister()
 {
     _impl->objectStore->enableSendOnRegister();
@@ -1624,6 +1639,7 @@ bool LocalNode::_cmdConnect( Command& command )
         _impl->nodes.data[ remoteNode->_id ] = remoteNode;
     }
     LBVERB << "Added node " << nodeID << std::endl;
+    notifyConnect( remoteNode );
 
     // send our information as reply
     NodeConnectReplyPacket reply( packet );
@@ -1714,6 +1730,7 @@ bool LocalNode::_cmdConnectReply( Command& command )
         _impl->nodes.data[ peer->_id ] = peer;
     }
     LBVERB << "Added node " << nodeID << std::endl;
+    notifyConnect( peer );
 
     serveRequest( packet->requestID, true );
 
@@ -164,6 +164,15 @@ namespace detail { class LocalNode; class ReceiverThread; class CommandThread; }
         /** @internal */
         CO_API void expireInstanceData( const int64_t age );
 
+        /** @internal @return the instance cache, or 0 if it is disabled. */
+        CO_API const InstanceCache* getInstanceCache() const;
+
+        /** @internal @return the number of mappings served by a slave. */
+        CO_API uint32_t getRelayHits() const;
+
+        /** @internal @return the number of relays served by the master. */
+        CO_API uint32_t getRelayMisses() const;
+
         /**
          * Enable sending instance data after registration.
          *
@@ -428,6 +437,9 @@ namespace detail { class LocalNode; class ReceiverThread; class CommandThread; }
          */
         CO_API bool connect( NodePtr node, ConnectionPtr connection );
 
+        /** Notify remote node connection from the receiver thread. */
+        virtual void notifyConnect( NodePtr node ) { }
+
         /** Notify remote node disconnection from the receiver thread. */
         virtual void notifyDisconnect( NodePtr node ) { }
 
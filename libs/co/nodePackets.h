@@ -318,6 +318,7 @@ namespace co
                 : objectID( request->objectID )
                 , version( request->requestedVersion )
                 , requestID( request->requestID )
+                , relayID( LB_UNDEFINED_UINT32 )
                 , result( false )
                 , releaseCache( request->useCache )
                 , useCache( false )
@@ -329,13 +330,49 @@ namespace co
         NodeID nodeID;
         const UUID objectID;
         uint128_t version;
+        NodeID relayNodeID;   //!< slave relaying the instance data, or ZERO
+        uint128_t relayVersion; //!< last version to be relayed
         const uint32_t requestID;
+        uint32_t relayID;     //!< master-side identifier of the relay
         
         bool result;
         const bool releaseCache;
         bool useCache;
     };
 
+    struct NodeRelayInstancePacket : public NodePacket
+    {
+        NodeRelayInstancePacket()
+                : requestID( LB_UNDEFINED_UINT32 )
+                , fill( 0 )
+            {
+                command = CMD_NODE_RELAY_INSTANCE;
+                size    = sizeof( NodeRelayInstancePacket );
+            }
+
+        UUID objectID;
+        uint128_t start; //!< first version to relay
+        uint128_t end;   //!< last version to relay
+        uint32_t masterInstanceID;
+        uint32_t instanceID; //!< the instance on the requesting node
+        uint32_t requestID;
+        const uint32_t fill;
+    };
+
+    struct NodeRelayInstanceReplyPacket : public NodePacket
+    {
+        NodeRelayInstanceReplyPacket( const NodeRelayInstancePacket* request )
+                : requestID( request->requestID )
+                , result( false )
+            {
+                command = CMD_NODE_RELAY_INSTANCE_REPLY;
+                size    = sizeof( NodeRelayInstanceReplyPacket );
+            }
+
+        const uint32_t requestID;
+        uint32_t result; // bool + valgrind padding
+    };
+
     struct NodeUnmapObjectPacket : public NodePacket
     {
         NodeUnmapObjectPacket()
@@ -510,6 +547,16 @@ namespace co
     {
         os << (NodePacket*)packet << " id " << packet->objectID << " req "
            << packet->requestID;
+        if( packet->relayNodeID != NodeID::ZERO )
+            os << " relay " << packet->relayNodeID;
+        return os;
+    }
+    inline std::ostream& operator << ( std::ostream& os, 
+                                       const NodeRelayInstancePacket* packet )
+    {
+        os << (NodePacket*)packet << " id " << packet->objectID << "."
+           << packet->instanceID << " v" << packet->start << ".."
+           << packet->end << " req " << packet->requestID;
         return os;
     }
 
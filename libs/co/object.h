@@ -119,6 +119,26 @@ namespace co
         virtual uint64_t getMaxVersions() const
             { return std::numeric_limits< uint64_t >::max(); }
 
+        /**
+         * Return if a slave instance may skip queued versions during sync().
+         *
+         * If true, sync() discards all queued versions preceding the newest
+         * queued version with full instance data, without unpacking them. The
+         * slave instance furthermore requests a snapshot of the master
+         * instance data when more than
+         * Global::IATTR_OBJECT_SNAPSHOT_THRESHOLD versions are queued, which
+         * is applied in place of the queued versions up to its version.
+         *
+         * Skipped versions are not passed to unpack() or applyInstanceData(),
+         * that is, this is only valid if the instance data of a version fully
+         * replaces the changes of previous versions. The method is called on
+         * the slave instance.
+         *
+         * @return true if queued versions may be skipped during sync().
+         * @version 1.4
+         */
+        virtual bool canSkipVersions() const { return false; }
+
         /**
          * Return the compressor to be used for data transmission.
          *
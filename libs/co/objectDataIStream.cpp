@@ -19,6 +19,7 @@
 
 #include "command.h"
 #include "commands.h"
+#include "node.h"
 #include "objectPackets.h"
 
 #include <co/plugins/compressor.h>
@@ -120,6 +121,37 @@ NodePtr ObjectDataIStream::getMaster()
     return command->getNode();
 }
 
+void ObjectDataIStream::sendMapData( NodePtr node,
+                                     const uint32_t instanceID ) const
+{
+    LBASSERT( isReady( ));
+    LBASSERT( !_usedCommand );
+
+    // headerSize excludes the eight bytes used for data by Node::send()
+    const uint64_t headerSize = sizeof( ObjectInstancePacket ) - 8;
+    for( CommandDequeCIter i = _commands.begin(); i != _commands.end(); ++i )
+    {
+        const ObjectInstancePacket* cached =
+            (*i)->get< ObjectInstancePacket >();
+        LBASSERT( cached->size >= headerSize );
+
+        ObjectInstancePacket packet( node->getNodeID(),
+                                     cached->masterInstanceID );
+        packet.command        = CMD_NODE_OBJECT_INSTANCE_MAP;
+        packet.instanceID     = instanceID;
+        packet.objectID       = cached->objectID;
+        packet.version        = cached->version;
+        packet.dataSize       = cached->dataSize;
+        packet.sequence       = cached->sequence;
+        packet.compressorName = cached->compressorName;
+        packet.nChunks        = cached->nChunks;
+        packet.last           = cached->last;
+
+        const uint8_t* data = reinterpret_cast< const uint8_t* >( cached );
+        node->send( packet, data + headerSize, cached->size - headerSize );
+    }
+}
+
 size_t ObjectDataIStream::getDataSize() const
 {
     size_t size = 0;
@@ -51,10 +51,14 @@ namespace co
         bool hasInstanceData() const;
         CO_API virtual NodePtr getMaster();
 
+        /** Send the buffered instance data to the given slave instance. */
+        void sendMapData( NodePtr node, const uint32_t instanceID ) const;
+
     protected:
         const Command* getNextCommand();
         virtual bool getNextBuffer( uint32_t* compressor, uint32_t* nChunks,
                                     const void** chunkData, uint64_t* size );
+        virtual Command* getCurrentCommand() { return _usedCommand; }
 
     private:
         /** All data command packets for this istream. */
@@ -0,0 +1,45 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *  
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "objectHandler.h"
+
+#include "node.h"
+#include "objectVersion.h"
+
+namespace co
+{
+bool ObjectHandler::mapObjects( const Objects& objects,
+                                const ObjectVersions& versions, NodePtr master )
+{
+    LBASSERT( objects.size() == versions.size( ));
+    const size_t size = LB_MIN( objects.size(), versions.size( ));
+
+    std::vector< uint32_t > requests( size );
+    for( size_t i = 0; i < size; ++i )
+    {
+        const ObjectVersion& version = versions[i];
+        requests[i] = mapObjectNB( objects[i], version.identifier,
+                                   version.version, master );
+    }
+
+    bool mapped = ( size == objects.size() && size == versions.size( ));
+    for( size_t i = 0; i < size; ++i )
+        if( !mapObjectSync( requests[i] ))
+            mapped = false;
+    return mapped;
+}
+}
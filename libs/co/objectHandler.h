@@ -18,6 +18,9 @@
 #ifndef CO_OBJECTHANDLER_H
 #define CO_OBJECTHANDLER_H
 
+#include <co/api.h>
+#include <co/types.h>
+
 namespace co
 {
     /** Interface for entities which map and register objects. @version 0.5.1 */
@@ -66,6 +69,22 @@ namespace co
         /** Finalize the mapping of a distributed object. */
         virtual bool mapObjectSync( const uint32_t requestID ) = 0;
 
+        /**
+         * Map multiple distributed objects.
+         *
+         * All map requests are sent before the first one is finalized, which
+         * costs about one round-trip instead of one per object. Objects which
+         * could not be mapped are not attached after this call.
+         *
+         * @param objects the objects to map.
+         * @param versions the identifier and version for each object.
+         * @param master the master node of all objects, may be invalid/0.
+         * @return true if all objects were mapped, false otherwise.
+         */
+        CO_API virtual bool mapObjects( const Objects& objects,
+                                        const ObjectVersions& versions,
+                                        NodePtr master = 0 );
+
         /** Unmap a mapped object. */
         virtual void unmapObject( Object* object ) = 0;
     };
@@ -20,10 +20,15 @@
 
 #include "dataIStream.h"
 #include "dataOStream.h"
+#include "node.h"
 #include "objectFactory.h"
+#include "objectHandler.h"
+#include "objectVersion.h"
 
 #include <lunchbox/scopedMutex.h>
 
+#include <algorithm>
+
 namespace co
 {
 namespace
@@ -53,7 +58,8 @@ class ObjectMap
 {
 public:
     ObjectMap( ObjectHandler& h, ObjectFactory& f )
-            : handler( h ) , factory( f ) {}
+            : handler( h ) , factory( f ), concurrentCommit( false )
+            , mapOnSync( false ) {}
 
     ~ObjectMap()
         {
@@ -85,6 +91,18 @@ public:
     Map map; //!< the actual map
     Objects masters; //!< Master objects registered with this instance
 
+    /** Masters not tracked using setDirty(), checked on each commit. */
+    Objects untracked;
+
+    /** Serializable masters which became dirty since the last commit. */
+    lunchbox::Lockable< Objects, lunchbox::SpinLock > dirty;
+
+    /** Commit the dirty masters from multiple threads. */
+    bool concurrentCommit;
+
+    /** Map the entries added by the master during sync(). */
+    bool mapOnSync;
+
     /** Added master objects since the last commit. */
     IDVector added;
 
@@ -99,6 +117,12 @@ ObjectMap::ObjectMap( ObjectHandler& handler, ObjectFactory& factory )
 
 ObjectMap::~ObjectMap()
 {
+    for( ObjectsCIter i =_impl->masters.begin(); i !=_impl->masters.end(); ++i )
+    {
+        Serializable* serializable = dynamic_cast< Serializable* >( *i );
+        if( serializable )
+            serializable->_setObjectMap( 0 );
+    }
     delete _impl;
 }
 
@@ -116,24 +140,87 @@ bool ObjectMap::isDirty() const
     if( Serializable::isDirty( ))
         return true;
 
+    {
+        lunchbox::ScopedFastRead mutex( _impl->dirty );
+        for( ObjectsCIter i = _impl->dirty->begin(); i != _impl->dirty->end();
+             ++i )
+        {
+            if( (*i)->isDirty( ))
+                return true;
+        }
+    }
+
     lunchbox::ScopedFastRead mutex( _impl->mutex );
-    for( ObjectsCIter i =_impl->masters.begin(); i !=_impl->masters.end(); ++i )
+    for( ObjectsCIter i = _impl->untracked.begin();
+         i != _impl->untracked.end(); ++i )
+    {
         if( (*i)->isDirty( ))
             return true;
+    }
     return false;
 }
 
+void ObjectMap::setConcurrentCommit( const bool enable )
+{
+    _impl->concurrentCommit = enable;
+}
+
+bool ObjectMap::isConcurrentCommit() const
+{
+    return _impl->concurrentCommit;
+}
+
+void ObjectMap::setMapOnSync( const bool enable )
+{
+    _impl->mapOnSync = enable;
+}
+
+bool ObjectMap::isMapOnSync() const
+{
+    return _impl->mapOnSync;
+}
+
+void ObjectMap::_notifyDirty( Serializable* object )
+{
+    lunchbox::ScopedFastWrite mutex( _impl->dirty );
+    _impl->dirty->push_back( object );
+}
+
 void ObjectMap::_commitMasters( const uint32_t incarnation )
 {
     lunchbox::ScopedFastWrite mutex( _impl->mutex );
+    Objects candidates;
+    {
+        lunchbox::ScopedFastWrite dirtyMutex( _impl->dirty );
+        candidates.swap( *_impl->dirty );
+    }
 
-    for( ObjectsCIter i =_impl->masters.begin(); i !=_impl->masters.end(); ++i )
+    // Masters committed outside of the map may have been noted more than once
+    std::sort( candidates.begin(), candidates.end( ));
+    candidates.erase( std::unique( candidates.begin(), candidates.end( )),
+                      candidates.end( ));
+    candidates.insert( candidates.end(), _impl->untracked.begin(),
+                       _impl->untracked.end( ));
+
+    Objects objects;
+    for( ObjectsCIter i = candidates.begin(); i != candidates.end(); ++i )
     {
         Object* object = *i;
-        if( !object->isDirty() || object->getChangeType() == Object::STATIC )
-            continue;
+        if( object->isDirty() && object->getChangeType() != Object::STATIC )
+            objects.push_back( object );
+    }
 
-        const ObjectVersion ov( object->getID(), object->commit( incarnation ));
+    const ssize_t nObjects = ssize_t( objects.size( ));
+    std::vector< uint128_t > versions( nObjects );
+#ifdef CO_USE_OPENMP
+#  pragma omp parallel for if( _impl->concurrentCommit )
+#endif
+    for( ssize_t i = 0; i < nObjects; ++i )
+        versions[i] = objects[i]->commit( incarnation );
+
+    for( ssize_t i = 0; i < nObjects; ++i )
+    {
+        const ObjectVersion ov( objects[i]->getID(), versions[i] );
         Entry& entry = _impl->map[ ov.identifier ];
         if( entry.version == ov.version )
             continue;
@@ -204,6 +291,13 @@ void ObjectMap::deserialize( DataIStream& is, const uint64_t dirtyBits )
             Entry& entry = _impl->map[ *i ];
             is >> entry.version >> entry.type;
         }
+
+        // Failed mappings are retried by the next get()
+        if( _impl->mapOnSync && !added.empty( ))
+        {
+            Objects instances;
+            _get( added, instances );
+        }
     }
     if( dirtyBits & DIRTY_CHANGED )
     {
@@ -242,6 +336,17 @@ bool ObjectMap::register_( Object* object, const uint32_t type )
     LBASSERT( _impl->map.find( object->getID( )) == _impl->map.end( ));
 
     _impl->map[ object->getID() ] = entry;
+
+    Serializable* serializable = dynamic_cast< Serializable* >( object );
+    if( serializable && serializable->isDirtyTracked( ))
+    {
+        serializable->_setObjectMap( this );
+        if( serializable->getDirty() != DIRTY_NONE )
+            _notifyDirty( serializable );
+    }
+    else
+        _impl->untracked.push_back( object );
+
     _impl->masters.push_back( object );
     _impl->added.push_back( object->getID( ));
     setDirty( DIRTY_ADDED );
@@ -296,4 +401,78 @@ Object* ObjectMap::get( const uint128_t& identifier, Object* instance )
     return object;
 }
 
+bool ObjectMap::get( const std::vector< uint128_t >& identifiers,
+                     Objects& instances )
+{
+    lunchbox::ScopedFastWrite mutex( _impl->mutex );
+    return _get( identifiers, instances );
+}
+
+bool ObjectMap::_get( const std::vector< uint128_t >& identifiers,
+                      Objects& instances )
+{
+    instances.assign( identifiers.size(), 0 );
+
+    Objects objects;
+    ObjectVersions versions;
+    IDVector ids;
+    bool mapped = true;
+
+    for( size_t i = 0; i < identifiers.size(); ++i )
+    {
+        const uint128_t& identifier = identifiers[i];
+        MapIter j = _impl->map.find( identifier );
+        LBASSERT( j != _impl->map.end( ));
+        if( j == _impl->map.end( ))
+        {
+            LBWARN << "Object mapping failed, no master registered"
+                   << std::endl;
+            mapped = false;
+            continue;
+        }
+
+        Entry& entry = j->second;
+        if( !entry.instance )
+        {
+            LBASSERT( entry.type != OBJECTTYPE_NONE );
+            entry.instance = _impl->factory.createObject( entry.type );
+            LBASSERT( entry.instance );
+            if( !entry.instance )
+            {
+                mapped = false;
+                continue;
+            }
+            objects.push_back( entry.instance );
+            versions.push_back( ObjectVersion( identifier, entry.version ));
+            ids.push_back( identifier );
+        }
+        instances[i] = entry.instance;
+    }
+
+    if( objects.empty( ))
+        return mapped;
+
+    // All entries are registered by the master instance of this map
+    NodePtr master;
+    if( !isMaster( ))
+        master = getMasterNode();
+    if( !_impl->handler.mapObjects( objects, versions, master ))
+    {
+        mapped = false;
+        for( size_t i = 0; i < objects.size(); ++i )
+        {
+            Object* object = objects[i];
+            if( object->isAttached( ))
+                continue;
+
+            Entry& entry = _impl->map[ ids[i] ];
+            std::replace( instances.begin(), instances.end(), object,
+                          static_cast< Object* >( 0 ));
+            _impl->factory.destroyObject( object, entry.type );
+            entry.instance = 0;
+        }
+    }
+    return mapped;
+}
+
 }
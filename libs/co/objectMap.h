@@ -52,6 +52,9 @@ namespace detail { class ObjectMap; }
          *
          * Upon registering using the object handler, this object will be
          * remembered for serialization on the next call to commit.
+         * Serializable masters are committed once they called setDirty(),
+         * unless Serializable::isDirtyTracked() returns false. All other
+         * masters are checked using isDirty() on each commit.
          *
          * @param object the new object to add and register
          * @param type unique object type to create object via slave factory
@@ -75,10 +78,60 @@ namespace detail { class ObjectMap; }
          */
         CO_API Object* get( const uint128_t& identifier, Object* instance=0 );
 
+        /**
+         * Map and return multiple objects.
+         *
+         * All objects not yet mapped are created via their type and mapped
+         * together using ObjectHandler::mapObjects(), which waits about one
+         * round-trip instead of one per object.
+         *
+         * @param identifiers unique object identifiers used for map operation
+         * @param instances returns the instance for each identifier, 0 if not
+         *                  registered or if the mapping failed
+         * @return true if all objects were mapped, false otherwise
+         * @version 1.4
+         */
+        CO_API bool get( const std::vector< uint128_t >& identifiers,
+                         Objects& instances );
+
         /** Commits all registered objects. @version 0.5.1 */
         CO_API virtual uint128_t commit( const uint32_t incarnation =
                                          CO_COMMIT_NEXT );
 
+        /**
+         * Enable or disable the concurrent commit of the registered masters.
+         *
+         * If enabled and OpenMP is available, commit() commits the dirty
+         * masters from multiple threads. All registered masters have to
+         * support a concurrent commit, i.e., must not share unprotected data.
+         * Disabled by default.
+         *
+         * @param enable true to commit concurrently, false to commit serially.
+         * @version 1.4
+         */
+        CO_API void setConcurrentCommit( const bool enable );
+
+        /** @return true if masters are committed concurrently. @version 1.4 */
+        CO_API bool isConcurrentCommit() const;
+
+        /**
+         * Enable or disable the mapping of new entries during sync().
+         *
+         * If enabled, sync() creates the instances of all entries added by
+         * the master since the last sync and maps them together using
+         * ObjectHandler::mapObjects(). Otherwise entries are only mapped by
+         * get(), which also allows to pass an existing instance. Disabled by
+         * default.
+         *
+         * @param enable true to map new entries on sync, false to map them on
+         *               first access.
+         * @version 1.4
+         */
+        CO_API void setMapOnSync( const bool enable );
+
+        /** @return true if new entries are mapped by sync(). @version 1.4 */
+        CO_API bool isMapOnSync() const;
+
     protected:
         CO_API virtual bool isDirty() const;
 
@@ -104,6 +157,14 @@ namespace detail { class ObjectMap; }
 
         /** Commit and note new master versions. */
         void _commitMasters( const uint32_t incarnation );
+
+        /** Map the given entries, with the map's mutex held. */
+        bool _get( const std::vector< uint128_t >& identifiers,
+                   Objects& instances );
+
+        friend class Serializable;
+        /** Note a registered master becoming dirty, called by setDirty(). */
+        void _notifyDirty( Serializable* object );
     };
 }
 #endif // CO_OBJECTMAP_H
@@ -89,6 +89,30 @@ namespace co
         const uint32_t slaveID;
     };
 
+    struct ObjectRelayDonePacket : public ObjectPacket
+    {
+        ObjectRelayDonePacket( const uint32_t relayID_, const bool result_ )
+                : relayID( relayID_ ), result( result_ )
+            {
+                command = CMD_OBJECT_RELAY_DONE;
+                size = sizeof( ObjectRelayDonePacket );
+            }
+        const uint32_t relayID;
+        const uint32_t result; // bool + valgrind padding
+    };
+
+    struct ObjectSnapshotPacket : public ObjectPacket
+    {
+        ObjectSnapshotPacket( const uint32_t slaveInstanceID )
+                : slaveID( slaveInstanceID ), fill( 0 )
+            {
+                command = CMD_OBJECT_SNAPSHOT;
+                size = sizeof( ObjectSnapshotPacket );
+            }
+        const uint32_t slaveID;
+        const uint32_t fill; // valgrind padding
+    };
+
     struct ObjectDataPacket : public ObjectPacket
     {
         ObjectDataPacket()
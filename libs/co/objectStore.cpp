@@ -46,8 +46,11 @@ typedef CommandFunc<ObjectStore> CmdFunc;
 ObjectStore::ObjectStore( LocalNode* localNode )
         : _localNode( localNode )
         , _instanceIDs( -0x7FFFFFFF )
-        , _instanceCache( new InstanceCache( Global::getIAttribute( 
-                              Global::IATTR_INSTANCE_CACHE_SIZE ) * LB_1MB ) )
+        , _instanceCache( new InstanceCache( uint64_t( Global::getIAttribute(
+                              Global::IATTR_INSTANCE_CACHE_SIZE )) * LB_1MB,
+                              Global::getInstanceCacheDirectory( )))
+        , _relayHits( 0 )
+        , _relayMisses( 0 )
 {
     LBASSERT( localNode );
     CommandQueue* queue = localNode->getCommandThreadQueue();
@@ -88,6 +91,10 @@ ObjectStore::ObjectStore( LocalNode* localNode )
         CmdFunc( this, &ObjectStore::_cmdRemoveNode ), queue );
     localNode->_registerCommand( CMD_NODE_OBJECT_PUSH,
         CmdFunc( this, &ObjectStore::_cmdObjectPush ), queue );
+    localNode->_registerCommand( CMD_NODE_RELAY_INSTANCE,
+        CmdFunc( this, &ObjectStore::_cmdRelayInstance ), queue );
+    localNode->_registerCommand( CMD_NODE_RELAY_INSTANCE_REPLY,
+        CmdFunc( this, &ObjectStore::_cmdRelayInstanceReply ), 0 );
 }
 
 ObjectStore::~ObjectStore()
@@ -126,11 +133,17 @@ ObjectStore::~ObjectStore()
 void ObjectStore::clear( )
 {
     LBASSERT( _objects->empty( ));
+    if( _instanceCache )
+        _instanceCache->flush();
     expireInstanceData( 0 );
     LBASSERT( !_instanceCache || _instanceCache->isEmpty( ));
 
     _objects->clear();
+    _instances.clear();
     _sendQueue.clear();
+    _masterNodeIDs->clear();
+    _relays->clear();
+    _relaySources->clear();
 }
 
 void ObjectStore::disableInstanceCache()
@@ -150,6 +163,16 @@ void ObjectStore::removeInstanceData( const NodeID& nodeID )
 {
     if( _instanceCache )
         _instanceCache->remove( nodeID ); 
+
+    lunchbox::ScopedFastWrite mutex( _masterNodeIDs );
+    for( NodeIDHash::iterator i = _masterNodeIDs->begin();
+         i != _masterNodeIDs->end(); )
+    {
+        if( i->second == nodeID )
+            _masterNodeIDs->erase( i++ );
+        else
+            ++i;
+    }
 }
 
 void ObjectStore::enableSendOnRegister()
@@ -177,33 +200,66 @@ NodeID ObjectStore::_findMasterNodeID( const UUID& identifier )
 {
     LB_TS_NOT_THREAD( _commandThread );
 
-    // OPT: look up locally first?
+    NodeID masterNodeID = _findLocalMasterNodeID( identifier );
+    if( masterNodeID != UUID::ZERO )
+        return masterNodeID;
+    {
+        lunchbox::ScopedFastRead mutex( _masterNodeIDs );
+        NodeIDHashCIter i = _masterNodeIDs->find( identifier );
+        if( i != _masterNodeIDs->end( ))
+            return i->second;
+    }
+
     Nodes nodes;
-    _localNode->getNodes( nodes );
-    
-    // OPT: send to multiple nodes at once?
-    for( NodesIter i = nodes.begin(); i != nodes.end(); ++i )
+    _localNode->getNodes( nodes, false );
+    if( nodes.empty( ))
+        return UUID::ZERO;
+
+    // Query all nodes at once, the first positive or the last reply serves
+    NodeFindMasterNodeIDPacket packet;
+    packet.requestID = _localNode->registerRequest();
+    packet.identifier = identifier;
     {
-        NodePtr node = *i;
-        NodeFindMasterNodeIDPacket packet;
-        packet.requestID = _localNode->registerRequest();
-        packet.identifier = identifier;
+        lunchbox::ScopedFastWrite mutex( _findRequests );
+        _findRequests.data[ packet.requestID ] = uint32_t( nodes.size( ));
+    }
 
-        LBLOG( LOG_OBJECTS ) << "Finding " << identifier << " on " << node
-                             << " req " << packet.requestID << std::endl;
-        node->send( packet );
+    LBLOG( LOG_OBJECTS ) << "Finding " << identifier << " on " << nodes.size()
+                         << " nodes req " << packet.requestID << std::endl;
+    for( NodesIter i = nodes.begin(); i != nodes.end(); ++i )
+        (*i)->send( packet );
 
-        NodeID masterNodeID = UUID::ZERO;
-        _localNode->waitRequest( packet.requestID, masterNodeID );
+    _localNode->waitRequest( packet.requestID, masterNodeID );
+    if( masterNodeID == UUID::ZERO )
+        return UUID::ZERO;
 
-        if( masterNodeID != UUID::ZERO )
-        {
-            LBLOG( LOG_OBJECTS ) << "Found " << identifier << " on "
-                                 << masterNodeID << std::endl;
-            return masterNodeID;
-        }
-    }
+    LBLOG( LOG_OBJECTS ) << "Found " << identifier << " on " << masterNodeID
+                         << std::endl;
+    lunchbox::ScopedFastWrite mutex( _masterNodeIDs );
+    _masterNodeIDs.data[ identifier ] = masterNodeID;
+    return masterNodeID;
+}
 
+NodeID ObjectStore::_findLocalMasterNodeID( const UUID& id )
+{
+    lunchbox::ScopedFastRead mutex( _objects );
+    ObjectsHashCIter i = _objects->find( id );
+    if( i == _objects->end( ))
+        return UUID::ZERO;
+
+    const Objects& objects = i->second;
+    LBASSERTINFO( !objects.empty(), id );
+
+    for( ObjectsCIter j = objects.begin(); j != objects.end(); ++j )
+    {
+        Object* object = *j;
+        if( object->isMaster( ))
+            return _localNode->getNodeID();
+
+        NodePtr master = object->getMasterNode();
+        if( master.isValid( ))
+            return master->getNodeID();
+    }
     return UUID::ZERO;
 }
 
@@ -262,6 +318,9 @@ void ObjectStore::_attachObject( Object* object, const UUID& id,
             " attached objects with same ID, first is: " << *objects[0] );
         objects.push_back( object );
     }
+    LBASSERTINFO( _instances.find( instanceID ) == _instances.end(),
+                  instanceID );
+    _instances[ instanceID ] = object;
 
     _localNode->flushCommands(); // redispatch pending commands
 
@@ -310,6 +369,7 @@ void ObjectStore::swapObject( Object* oldObject, Object* newObject )
 
     newObject->transfer( oldObject );
     *j = newObject;
+    _instances[ newObject->getInstanceID() ] = newObject;
 }
 
 void ObjectStore::_detachObject( Object* object )
@@ -336,6 +396,7 @@ void ObjectStore::_detachObject( Object* object )
         if( objects.empty( ))
             _objects->erase( id );
     }
+    _instances.erase( object->getInstanceID( ));
 
     LBASSERT( object->getInstanceID() != EQ_INSTANCE_INVALID );
     object->detach();
@@ -438,13 +499,61 @@ bool ObjectStore::mapObjectSync( const uint32_t requestID )
 
     const bool mapped = object->isAttached();
     if( mapped )
+    {
+        _relayMapData( object );
         object->applyMapData( version ); // apply initial instance data
 
+        lunchbox::ScopedFastWrite mutex( _relaySources );
+        _relaySources->erase( object->getInstanceID( ));
+    }
+
     object->notifyAttached();
     LBLOG( LOG_OBJECTS ) << "Mapped " << lunchbox::className( object ) << std::endl;
     return mapped;
 }
 
+void ObjectStore::_relayMapData( Object* object )
+{
+    Relay relay;
+    {
+        lunchbox::ScopedFastWrite mutex( _relays );
+        RelayHash::iterator i = _relays->find( object->getInstanceID( ));
+        if( i == _relays->end( ))
+            return;
+
+        relay = i->second;
+        _relays->erase( i );
+    }
+
+    // Pull the instance data from the relay. If it can't provide the data, the
+    // master sends it after the relay done packet.
+    bool relayed = false;
+    NodePtr node = _localNode->connect( relay.nodeID );
+    if( node )
+    {
+        NodeRelayInstancePacket packet;
+        packet.requestID        = _localNode->registerRequest();
+        packet.objectID         = object->getID();
+        packet.start            = relay.start;
+        packet.end              = relay.end;
+        packet.masterInstanceID = object->getMasterInstanceID();
+        packet.instanceID       = object->getInstanceID();
+
+        node->send( packet );
+        _localNode->waitRequest( packet.requestID, relayed );
+    }
+
+    if( relayed )
+        ++_relayHits;
+    else
+        ++_relayMisses;
+
+    ObjectRelayDonePacket packet( relay.relayID, relayed );
+    packet.objectID   = object->getID();
+    packet.instanceID = object->getMasterInstanceID();
+    object->getMasterNode()->send( packet );
+}
+
 void ObjectStore::unmapObject( Object* object )
 {
     LBASSERT( object );
@@ -456,6 +565,8 @@ void ObjectStore::unmapObject( Object* object )
     LBLOG( LOG_OBJECTS ) << "Unmap " << object << std::endl;
 
     object->notifyDetach();
+    if( _instanceCache )
+        _instanceCache->unpin( id );
 
     // send unsubscribe to master, master will send detach packet.
     LBASSERT( !object->isMaster( ));
@@ -541,6 +652,10 @@ void ObjectStore::deregisterObject( Object* object )
     object->setupChangeManager( Object::NONE, true, 0, EQ_INSTANCE_INVALID );
     if( _instanceCache )
         _instanceCache->erase( id );
+    {
+        lunchbox::ScopedFastWrite mutex( _masterNodeIDs );
+        _masterNodeIDs->erase( id );
+    }
     object->notifyDetached();
 }
 
@@ -606,6 +721,19 @@ bool ObjectStore::dispatchObjectCommand( Command& command )
     const UUID& id = packet->objectID;
     const uint32_t instanceID = packet->instanceID;
 
+    if( instanceID <= EQ_INSTANCE_MAX )
+    {
+        // unlocked, only modified by the receiver thread
+        InstanceHash::const_iterator i = _instances.find( instanceID );
+        if( i == _instances.end( ))
+            return false; // not yet attached, redispatched on attach
+
+        Object* object = i->second;
+        LBASSERTINFO( object->getID() == id, packet );
+        LBCHECK( object->dispatchCommand( command ));
+        return true;
+    }
+
     ObjectsHash::const_iterator i = _objects->find( id );
 
     if( i == _objects->end( ))
@@ -616,21 +744,6 @@ bool ObjectStore::dispatchObjectCommand( Command& command )
     const Objects& objects = i->second;
     LBASSERTINFO( !objects.empty(), packet );
 
-    if( instanceID <= EQ_INSTANCE_MAX )
-    {
-        for( Objects::const_iterator j = objects.begin(); j!=objects.end(); ++j)
-        {
-            Object* object = *j;
-            if( instanceID == object->getInstanceID( ))
-            {
-                LBCHECK( object->dispatchCommand( command ));
-                return true;
-            }
-        }
-        LBUNREACHABLE;
-        return false;
-    }
-
     Objects::const_iterator j = objects.begin();
     Object* object = *j;
     LBCHECK( object->dispatchCommand( command ));
@@ -655,31 +768,7 @@ bool ObjectStore::_cmdFindMasterNodeID( Command& command )
     LBASSERT( id.isGenerated() );
 
     NodeFindMasterNodeIDReplyPacket reply( packet );
-    {
-        lunchbox::ScopedFastRead mutex( _objects );
-        ObjectsHashCIter i = _objects->find( id );
-
-        if( i != _objects->end( ))
-        {
-            const Objects& objects = i->second;
-            LBASSERTINFO( !objects.empty(), packet );
-
-            for( ObjectsCIter j = objects.begin(); j != objects.end(); ++j )
-            {
-                Object* object = *j;
-                if( object->isMaster( ))
-                    reply.masterNodeID = _localNode->getNodeID();
-                else
-                {
-                    NodePtr master = object->getMasterNode();
-                    if( master.isValid( ))
-                        reply.masterNodeID = master->getNodeID();
-                }
-                if( reply.masterNodeID != UUID::ZERO )
-                    break;
-            }
-        }
-    }
+    reply.masterNodeID = _findLocalMasterNodeID( id );
 
     LBLOG( LOG_OBJECTS ) << "Object " << id << " master " << reply.masterNodeID
                          << " req " << reply.requestID << std::endl;
@@ -689,8 +778,19 @@ bool ObjectStore::_cmdFindMasterNodeID( Command& command )
 
 bool ObjectStore::_cmdFindMasterNodeIDReply( Command& command )
 {
+    LB_TS_THREAD( _receiverThread );
     const NodeFindMasterNodeIDReplyPacket* packet =
           command.get< NodeFindMasterNodeIDReplyPacket >();
+    {
+        lunchbox::ScopedFastWrite mutex( _findRequests );
+        RequestHash::iterator i = _findRequests->find( packet->requestID );
+        if( i == _findRequests->end( )) // already served
+            return true;
+
+        if( packet->masterNodeID == UUID::ZERO && --i->second > 0 )
+            return true;
+        _findRequests->erase( i );
+    }
     _localNode->serveRequest( packet->requestID, packet->masterNodeID );
     return true;
 }
@@ -850,6 +950,15 @@ bool ObjectStore::_cmdMapObjectSuccess( Command& command )
     object->setupChangeManager( Object::ChangeType( packet->changeType ), false,
                                 _localNode, packet->masterInstanceID );
     _attachObject( object, packet->objectID, packet->instanceID );
+
+    // The master may ask us to relay the instance data to later slaves
+    const Object::ChangeType type = Object::ChangeType( packet->changeType );
+    if( _instanceCache && Global::getIAttribute( Global::IATTR_INSTANCE_RELAY )
+        && ( type == Object::INSTANCE || type == Object::DELTA ))
+    {
+        lunchbox::ScopedFastWrite mutex( _relaySources );
+        (*_relaySources)[ packet->instanceID ] = command.getNode()->getNodeID();
+    }
     return true;
 }
 
@@ -876,6 +985,18 @@ bool ObjectStore::_cmdMapObjectReply( Command& command )
 
         object->setMasterNode( command.getNode( ));
 
+        if( packet->relayNodeID != NodeID::ZERO )
+        {
+            Relay relay;
+            relay.nodeID  = packet->relayNodeID;
+            relay.start   = packet->version;
+            relay.end     = packet->relayVersion;
+            relay.relayID = packet->relayID;
+
+            lunchbox::ScopedFastWrite mutex( _relays );
+            (*_relays)[ object->getInstanceID() ] = relay;
+        }
+
         if( packet->useCache )
         {
             LBASSERT( packet->releaseCache );
@@ -899,6 +1020,10 @@ bool ObjectStore::_cmdMapObjectReply( Command& command )
         if( packet->releaseCache )
             _instanceCache->release( packet->objectID, 1 );
 
+        // master node moved or object deregistered, look it up next time
+        lunchbox::ScopedFastWrite mutex( _masterNodeIDs );
+        _masterNodeIDs->erase( packet->objectID );
+
         LBWARN << "Could not map object " << packet->objectID << std::endl;
     }
 
@@ -906,6 +1031,78 @@ bool ObjectStore::_cmdMapObjectReply( Command& command )
     return true;
 }
 
+bool ObjectStore::_cmdRelayInstance( Command& command )
+{
+    LB_TS_THREAD( _commandThread );
+    const NodeRelayInstancePacket* packet =
+        command.get< NodeRelayInstancePacket >();
+    LBLOG( LOG_OBJECTS ) << "Cmd relay instance " << packet << std::endl;
+
+    NodePtr node = command.getNode();
+    NodeRelayInstanceReplyPacket reply( packet );
+
+    if( _instanceCache )
+    {
+        const UUID& id = packet->objectID;
+        const InstanceCache::Data& cached = (*_instanceCache)[ id ];
+        if( cached != InstanceCache::Data::NONE )
+        {
+            // relay only if all requested versions are cached
+            typedef ObjectDataIStreamDeque::const_iterator StreamCIter;
+            const ObjectDataIStreamDeque& versions = cached.versions;
+            StreamCIter first = versions.end();
+            uint128_t next = packet->start;
+
+            if( cached.masterInstanceID == packet->masterInstanceID )
+            {
+                for( StreamCIter i = versions.begin(); i != versions.end(); ++i)
+                {
+                    const ObjectDataIStream* stream = *i;
+                    if( !stream->isReady( ))
+                        break;
+
+                    const uint128_t version = stream->getVersion();
+                    if( version < packet->start )
+                        continue;
+                    if( version != next )
+                        break;
+
+                    if( first == versions.end( ))
+                        first = i;
+                    if( version == packet->end )
+                    {
+                        reply.result = true;
+                        break;
+                    }
+                    next = version + 1;
+                }
+            }
+
+            for( StreamCIter i = first; reply.result; ++i )
+            {
+                const ObjectDataIStream* stream = *i;
+                stream->sendMapData( node, packet->instanceID );
+                if( stream->getVersion() == packet->end )
+                    break;
+            }
+            _instanceCache->release( id, 1 );
+        }
+    }
+
+    node->send( reply );
+    return true;
+}
+
+bool ObjectStore::_cmdRelayInstanceReply( Command& command )
+{
+    LB_TS_THREAD( _receiverThread );
+    const NodeRelayInstanceReplyPacket* packet =
+        command.get< NodeRelayInstanceReplyPacket >();
+
+    _localNode->serveRequest( packet->requestID, bool( packet->result ));
+    return true;
+}
+
 bool ObjectStore::_cmdUnsubscribeObject( Command& command )
 {
     LB_TS_THREAD( _commandThread );
@@ -963,6 +1160,7 @@ bool ObjectStore::_cmdUnmapObject( Command& command )
     for( Objects::const_iterator j = objects.begin(); j != objects.end(); ++j )
     {
         Object* object = *j;
+        _instances.erase( object->getInstanceID( ));
         object->detach();
     }
 
@@ -986,10 +1184,28 @@ bool ObjectStore::_cmdInstance( Command& command )
 
     if( _instanceCache )
     {
+        // Pin the map data of relay sources, independent of the cache size.
+        // Relayed data is cached as coming from the master node.
+        NodeID from = command.getNode()->getNodeID();
+        bool pin = false;
+        if( type == CMD_NODE_OBJECT_INSTANCE_MAP &&
+            packet->nodeID == _localNode->getNodeID( ))
+        {
+            lunchbox::ScopedFastRead mutex( _relaySources );
+            InstanceNodeHash::const_iterator i =
+                _relaySources->find( packet->instanceID );
+            if( i != _relaySources->end( ))
+            {
+                from = i->second;
+                pin = true;
+            }
+        }
+
 #ifndef CO_AGGRESSIVE_CACHING // Issue #82: 
         if( type != CMD_NODE_OBJECT_INSTANCE_PUSH )
 #endif
-            _instanceCache->add( rev, packet->masterInstanceID, command, 0 );
+            _instanceCache->add( rev, packet->masterInstanceID, from, command,
+                                 pin );
     }
 
     switch( type )
@@ -132,12 +132,21 @@ namespace co
         /** Expire all data older than age from the cache. */
         void expireInstanceData( const int64_t age );
 
-        /** Remove all entries of the node from the cache. */
+        /** Remove all entries of the node from the caches. */
         void removeInstanceData( const NodeID& nodeID );
 
         /** Disable the instance cache of an stopped local node. */
         void disableInstanceCache();
 
+        /** @return the instance cache, or 0 if it is disabled. */
+        const InstanceCache* getInstanceCache() const { return _instanceCache; }
+
+        /** @return the number of mappings served by a relaying slave. */
+        uint32_t getRelayHits() const { return _relayHits; }
+
+        /** @return the number of relays which fell back to the master. */
+        uint32_t getRelayMisses() const { return _relayMisses; }
+
         /** Enable sending data of newly registered objects when idle. */
         void enableSendOnRegister();
         
@@ -185,6 +194,11 @@ namespace co
          */
         lunchbox::Lockable< ObjectsHash, lunchbox::SpinLock > _objects;
 
+        typedef stde::hash_map< uint32_t, Object* > InstanceHash;
+
+        /** All attached objects by instance identifier, receiver thread only */
+        InstanceHash _instances;
+
         struct SendQueueItem
         {
             int64_t age;
@@ -197,6 +211,43 @@ namespace co
         InstanceCache* _instanceCache; //!< cached object mapping data
         DataIStreamQueue _pushData;    //!< Object::push() queue
 
+        typedef stde::hash_map< lunchbox::uint128_t, NodeID > NodeIDHash;
+        typedef NodeIDHash::const_iterator NodeIDHashCIter;
+
+        /** Master node identifiers found by _findMasterNodeID(). */
+        lunchbox::Lockable< NodeIDHash, lunchbox::SpinLock > _masterNodeIDs;
+
+        typedef stde::hash_map< uint32_t, uint32_t > RequestHash;
+
+        /** Outstanding replies per pending master node lookup. */
+        lunchbox::Lockable< RequestHash, lunchbox::SpinLock > _findRequests;
+
+        /** Instance data to be fetched from a relaying slave. */
+        struct Relay
+        {
+            NodeID nodeID;     //!< the relaying node
+            uint128_t start;   //!< first version to fetch
+            uint128_t end;     //!< last version to fetch
+            uint32_t relayID;  //!< master-side identifier of the relay
+        };
+        typedef stde::hash_map< uint32_t, Relay > RelayHash;
+
+        /** Pending relays by instance identifier of the mapped object. */
+        lunchbox::Lockable< RelayHash, lunchbox::SpinLock > _relays;
+
+        typedef stde::hash_map< uint32_t, NodeID > InstanceNodeHash;
+
+        /**
+         * Master nodes of pending mappings whose instance data is pinned to
+         * relay it to later slaves, by instance identifier of the mapped
+         * object.
+         */
+        lunchbox::Lockable< InstanceNodeHash,
+                            lunchbox::SpinLock > _relaySources;
+
+        lunchbox::a_int32_t _relayHits;   //!< relays served by the slave
+        lunchbox::a_int32_t _relayMisses; //!< relays served by the master
+
         /**
          * Returns the master node id for an identifier.
          * 
@@ -205,9 +256,15 @@ namespace co
          *         found for the identifier.
          */
         NodeID _findMasterNodeID( const UUID& id );
+
+        /** @return the master node id known locally, or UUID::ZERO. */
+        NodeID _findLocalMasterNodeID( const UUID& id );
  
         NodePtr _connectMaster( const UUID& id );
 
+        /** Fetch the initial instance data from a relaying slave. */
+        void _relayMapData( Object* object );
+
         void _attachObject( Object* object, const UUID& id, 
                             const uint32_t instanceID );
         void _detachObject( Object* object );
@@ -219,6 +276,8 @@ namespace co
         bool _cmdDetachObject( Command& command );
         bool _cmdMapObject( Command& command );
         bool _cmdMapObjectSuccess( Command& command );
+        bool _cmdRelayInstance( Command& command );
+        bool _cmdRelayInstanceReply( Command& command );
         bool _cmdMapObjectReply( Command& command );
         bool _cmdUnmapObject( Command& command );
         bool _cmdUnsubscribeObject( Command& command );
@@ -19,6 +19,7 @@
 
 #include "dataIStream.h"
 #include "dataOStream.h"
+#include "objectMap.h"
 
 namespace co
 {
@@ -27,11 +28,14 @@ namespace detail
 class Serializable
 {
 public:
-    Serializable() : dirty( co::Serializable::DIRTY_NONE ) {}
+    Serializable() : dirty( co::Serializable::DIRTY_NONE ), map( 0 ) {}
     ~Serializable() {}
 
     /** The current dirty bits. */
     uint64_t dirty;
+
+    /** The object map this master is registered with, notified when dirty. */
+    co::ObjectMap* map;
 };
 }
 
@@ -73,7 +77,16 @@ uint128_t Serializable::commit( const uint32_t incarnation )
 
 void Serializable::setDirty( const uint64_t bits )
 {
+    const bool notify = _impl->map && _impl->dirty == DIRTY_NONE &&
+                        bits != DIRTY_NONE;
     _impl->dirty |= bits;
+    if( notify )
+        _impl->map->_notifyDirty( this );
+}
+
+void Serializable::_setObjectMap( ObjectMap* map )
+{
+    _impl->map = map;
 }
 
 void Serializable::unsetDirty( const uint64_t bits )
@@ -44,6 +44,13 @@ namespace detail { class Serializable; }
         /** @return true if the given dirty bit is set. @version 1.0 */
         CO_API virtual bool isDirty( const uint64_t dirtyBits ) const;
 
+        /**
+         * @return true if all changes are marked using setDirty(), false if
+         *         isDirty() is overridden to report other changes.
+         * @version 1.4
+         */
+        virtual bool isDirtyTracked() const { return true; }
+
         CO_API virtual uint128_t commit( const uint32_t incarnation =
                                          CO_COMMIT_NEXT );
 
@@ -112,6 +119,10 @@ namespace detail { class Serializable; }
     private:
         detail::Serializable* const _impl;
         friend class detail::Serializable;
+        friend class ObjectMap;
+
+        /** Set the object map to notify when this master becomes dirty. */
+        void _setObjectMap( ObjectMap* map );
 
         virtual void getInstanceData( co::DataOStream& os )
             { serialize( os, DIRTY_ALL ); }
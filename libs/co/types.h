@@ -47,11 +47,13 @@ class DataIStream;
 class DataOStream;
 class ErrorRegistry;
 class Global;
+class InstanceCache; //!< @internal
 class LocalNode;
 class Node;
 class Object;
 class ObjectFactory;
 class ObjectHandler;
+class ObjectMap;
 class ObjectDataIStream;
 class Plugin;        //!< @internal
 class PluginRegistry;
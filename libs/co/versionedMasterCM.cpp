@@ -51,6 +51,9 @@ VersionedMasterCM::VersionedMasterCM( Object* object )
     object->registerCommand( CMD_OBJECT_MAX_VERSION,
                             CmdFunc( this, &VersionedMasterCM::_cmdMaxVersion ),
                              0 );
+    object->registerCommand( CMD_OBJECT_SNAPSHOT,
+                             CmdFunc( this, &VersionedMasterCM::_cmdDiscard ),
+                             0 );
 }
 
 VersionedMasterCM::~VersionedMasterCM()
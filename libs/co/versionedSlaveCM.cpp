@@ -19,6 +19,7 @@
 
 #include "command.h"
 #include "commands.h"
+#include "global.h"
 #include "log.h"
 #include "object.h"
 #include "objectDataIStream.h"
@@ -34,6 +35,9 @@ VersionedSlaveCM::VersionedSlaveCM( Object* object, uint32_t masterInstanceID )
         : ObjectCM( object )
         , _version( VERSION_NONE )
         , _currentIStream( 0 )
+        , _receivedVersion( VERSION_NONE )
+        , _snapshotRequested( false )
+        , _mapped( 0 )
         , _masterInstanceID( masterInstanceID )
 #pragma warning(push)
 #pragma warning(disable: 4355)
@@ -52,6 +56,8 @@ VersionedSlaveCM::~VersionedSlaveCM()
 {
     while( !_queuedVersions.isEmpty( ))
         delete _queuedVersions.pop();
+    while( !_snapshots.isEmpty( ))
+        delete _snapshots.pop();
 
     LBASSERT( !_currentIStream );
     delete _currentIStream;
@@ -99,6 +105,9 @@ uint128_t VersionedSlaveCM::sync( const uint128_t& v )
                   lunchbox::className( _object ) << " " << _object->getID() <<
                   " (" << _version << ", " << version <<")" );
 
+    if( _object->canSkipVersions( ))
+        _skipVersions( version );
+
     while( _version < version )
         _unpackOneVersion( _queuedVersions.pop( ));
 
@@ -114,6 +123,9 @@ void VersionedSlaveCM::_syncToHead()
     if( _queuedVersions.isEmpty( ))
         return;
 
+    if( _object->canSkipVersions( ))
+        _skipVersions( getHeadVersion( ));
+
     ObjectDataIStream* is = 0;
     while( _queuedVersions.tryPop( is ))
         _unpackOneVersion( is );
@@ -123,6 +135,116 @@ void VersionedSlaveCM::_syncToHead()
         localNode->flushCommands();
 }
 
+void VersionedSlaveCM::_skipVersions( const uint128_t& version )
+{
+    // newest received snapshot up to the requested version
+    ObjectDataIStream* newest = 0;
+    ObjectDataIStream* is = 0;
+    while( _snapshots.getFront( is ) && is->getVersion() <= version )
+    {
+        LBCHECK( _snapshots.tryPop( is ));
+        if( newest )
+            _releaseStream( newest );
+        newest = is;
+    }
+    if( newest && newest->getVersion() <= _version ) // outdated
+    {
+        _releaseStream( newest );
+        newest = 0;
+    }
+
+    // queued versions up to the requested version, without blocking
+    ObjectDataIStreams pending;
+    while( _queuedVersions.getFront( is ) && is->getVersion() <= version )
+    {
+        LBCHECK( _queuedVersions.tryPop( is ));
+        pending.push_back( is );
+    }
+
+    for( ObjectDataIStreams::reverse_iterator i = pending.rbegin();
+         i != pending.rend(); ++i )
+    {
+        is = *i;
+        if( !is->hasInstanceData( ))
+            continue;
+
+        if( !newest || is->getVersion() > newest->getVersion( ))
+        {
+            if( newest )
+                _releaseStream( newest );
+            newest = is;
+            *i = 0;
+        }
+        break;
+    }
+
+    size_t nSkipped = 0;
+    if( newest )
+    {
+        for( ObjectDataIStreams::iterator i = pending.begin();
+             i != pending.end(); ++i )
+        {
+            if( *i && (*i)->getVersion() <= newest->getVersion( ))
+            {
+                _releaseStream( *i );
+                *i = 0;
+                ++nSkipped;
+            }
+        }
+        _applySnapshot( newest );
+    }
+
+    for( ObjectDataIStreams::const_iterator i = pending.begin();
+         i != pending.end(); ++i )
+    {
+        if( *i )
+            _unpackOneVersion( *i );
+    }
+
+    LBLOG( LOG_OBJECTS ) << "Skipped " << nSkipped << " versions of "
+                         << _object->getID() << " up to v" << _version
+                         << std::endl;
+}
+
+void VersionedSlaveCM::_applySnapshot( ObjectDataIStream* is )
+{
+    LBASSERT( is->hasInstanceData( ));
+    LBASSERTINFO( _version < is->getVersion(), _version << " >= " <<
+                  is->getVersion( ));
+
+    _object->applyInstanceData( *is );
+    _version = is->getVersion();
+    _sendAck();
+
+    LBASSERT( _version != VERSION_INVALID );
+    LBASSERT( _version != VERSION_NONE );
+    LBASSERTINFO( is->getRemainingBufferSize()==0 && is->nRemainingBuffers()==0,
+                  "Object " << typeid( *_object ).name() <<
+                  " did not unpack all data" );
+    _releaseStream( is );
+}
+
+void VersionedSlaveCM::_checkSnapshot()
+{
+    LB_TS_THREAD( _rcvThread );
+    if( _snapshotRequested || !_mapped || !_object->canSkipVersions( ))
+        return;
+
+    const int32_t threshold =
+        Global::getIAttribute( Global::IATTR_OBJECT_SNAPSHOT_THRESHOLD );
+    if( threshold <= 0 || _queuedVersions.getSize() <= size_t( threshold ))
+        return;
+
+    LBLOG( LOG_OBJECTS ) << "Request snapshot of " << _object->getID()
+                         << ", " << _queuedVersions.getSize()
+                         << " versions queued" << std::endl;
+    _snapshotRequested = true;
+
+    ObjectSnapshotPacket packet( _object->getInstanceID( ));
+    packet.instanceID = _masterInstanceID;
+    _object->send( _master, packet );
+}
+
 void VersionedSlaveCM::_releaseStream( ObjectDataIStream* stream )
 {
 #ifdef CO_AGGRESSIVE_CACHING
@@ -196,6 +318,7 @@ void VersionedSlaveCM::applyMapData( const uint128_t& version )
             if( is->hasData( )) // not VERSION_NONE
                 _object->applyInstanceData( *is );
             _version = is->getVersion();
+            _mapped = 1;
 
             LBASSERT( _version != VERSION_INVALID );
             LBASSERTINFO( !is->hasData(),
@@ -304,6 +427,8 @@ void VersionedSlaveCM::addInstanceDatas( const ObjectDataIStreamDeque& cache,
         } 
 #endif
         _queuedVersions.push( new ObjectDataIStream( *stream ));
+        if( stream->getVersion() > _receivedVersion )
+            _receivedVersion = stream->getVersion();
 #if 0
         LBLOG( LOG_OBJECTS ) << stream->getVersion() << ' ';
 #endif
@@ -328,6 +453,15 @@ bool VersionedSlaveCM::_cmdData( Command& command )
     if( _currentIStream->isReady( ))
     {
         const uint128_t& version = _currentIStream->getVersion();
+        if( _snapshotRequested && version <= _receivedVersion )
+        {
+            // requested snapshot, all versions up to it have been received
+            LBASSERT( _currentIStream->hasInstanceData( ));
+            _snapshotRequested = false;
+            _snapshots.push( _currentIStream );
+            _currentIStream = 0;
+            return true;
+        }
 #if 0
         LBLOG( LOG_OBJECTS ) << "v" << version << ", id " << _object->getID()
                              << "." << _object->getInstanceID() << " ready"
@@ -341,9 +475,15 @@ bool VersionedSlaveCM::_cmdData( Command& command )
             LBASSERT( debugStream->getVersion() + 1 == version );
         }
 #endif
+        const bool hasInstanceData = _currentIStream->hasInstanceData();
+        if( version > _receivedVersion )
+            _receivedVersion = version;
         _queuedVersions.push( _currentIStream );
         _object->notifyNewHeadVersion( version );
         _currentIStream = 0;
+
+        if( !hasInstanceData )
+            _checkSnapshot();
     }
     return true;
 }
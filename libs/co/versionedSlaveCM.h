@@ -22,6 +22,7 @@
 #include "objectDataIStream.h"      // member
 #include "objectSlaveDataOStream.h" // member
 
+#include <lunchbox/atomic.h>      // member
 #include <lunchbox/mtQueue.h>     // member
 #include <lunchbox/pool.h>        // member
 #include <lunchbox/thread.h>      // thread-safety macro
@@ -74,6 +75,18 @@ namespace co
         /** The change queue. */
         lunchbox::MTQueue< ObjectDataIStream* > _queuedVersions;
 
+        /** Instance data snapshots received upon request. */
+        lunchbox::MTQueue< ObjectDataIStream* > _snapshots;
+
+        /** The newest queued version, used by the receiver thread. */
+        uint128_t _receivedVersion;
+
+        /** A requested snapshot has not been received yet. */
+        bool _snapshotRequested;
+
+        /** The map data has been applied, snapshots may be requested. */
+        lunchbox::a_int32_t _mapped;
+
         /** Cached input streams (+decompressor) */
         lunchbox::Pool< ObjectDataIStream, true > _iStreamCache;
 
@@ -90,6 +103,15 @@ namespace co
         void _releaseStream( ObjectDataIStream* stream );
         void _sendAck();
 
+        /** Apply the newest full instance data up to the given version. */
+        void _skipVersions( const uint128_t& version );
+
+        /** Apply instance data of a newer, not consecutive version. */
+        void _applySnapshot( ObjectDataIStream* is );
+
+        /** Request a snapshot if too many versions are queued. */
+        void _checkSnapshot();
+
         /** Apply the data in the input stream to the object */
         virtual void _unpackOneVersion( ObjectDataIStream* is );
 
@@ -50,6 +50,7 @@
 #include <co/connectionDescription.h>
 #include <co/exception.h>
 #include <co/queueSlave.h>
+#include <lunchbox/clock.h>
 #include <lunchbox/rng.h>
 #include <lunchbox/scopedMutex.h>
 
@@ -119,6 +120,8 @@ void Channel::attach( const UUID& id, const uint32_t instanceID )
                      CmdFunc( this, &Channel::_cmdStopFrame ), commandQ );
     registerCommand( fabric::CMD_CHANNEL_FRAME_TILES,
                      CmdFunc( this, &Channel::_cmdFrameTiles ), queue );
+    registerCommand( fabric::CMD_CHANNEL_FRAME_CONTEXT,
+                     CmdFunc( this, &Channel::_cmdFrameContext ), queue );
     registerCommand( fabric::CMD_CHANNEL_FINISH_READBACK,
                      CmdFunc( this, &Channel::_cmdFinishReadback ), transferQ );
     registerCommand( fabric::CMD_CHANNEL_DELETE_TRANSFER_CONTEXT,
@@ -326,12 +329,13 @@ void Channel::notifyViewportChanged()
 
 void Channel::addStatistic( Event& event )
 {
-    {
-        const uint32_t frameNumber = event.statistic.frameNumber;
-        const size_t index = frameNumber % _impl->statistics->size();
-        LBASSERT( index < _impl->statistics->size( ));
-        LBASSERTINFO( _impl->statistics.data[ index ].used > 0, frameNumber );
+    const uint32_t frameNumber = event.statistic.frameNumber;
+    const size_t index = frameNumber % _impl->statistics->size();
+    LBASSERT( index < _impl->statistics->size( ));
+    LBASSERTINFO( _impl->statistics.data[ index ].used > 0, frameNumber );
 
+    {
+        // sent to the server in _unrefFrame()
         lunchbox::ScopedFastWrite mutex( _impl->statistics );
         Statistics& statistics = _impl->statistics.data[ index ].data;
         statistics.push_back( event.statistic );
@@ -856,9 +860,12 @@ bool Channel::processEvent( const Event& event )
         case Event::CHANNEL_POINTER_MOTION:
         case Event::CHANNEL_POINTER_BUTTON_PRESS:
         case Event::CHANNEL_POINTER_BUTTON_RELEASE:
-        case Event::STATISTIC:
             break;
 
+        case Event::STATISTIC: // sent once per frame by the node
+            getNode()->addStatistic( event );
+            return true;
+
         case Event::CHANNEL_RESIZE:
         {
             const UUID& viewID = getNativeContext().view.identifier;
@@ -1379,12 +1386,32 @@ private:
 
 typedef lunchbox::RefPtr< detail::RBStat > RBStatPtr;
 
+namespace
+{
+/** Same computation as the server's tile frustum, see Compound. */
+Frustumf _getTileFrustum( const Frustumf& base, const Viewport& vp )
+{
+    Frustumf frustum = base;
+    if( vp == Viewport::FULL || !vp.isValid( ))
+        return frustum;
+
+    const float frustumWidth = frustum.right() - frustum.left();
+    frustum.left()  += frustumWidth * vp.x;
+    frustum.right()  = frustum.left() + frustumWidth * vp.w;
+
+    const float frustumHeight = frustum.top() - frustum.bottom();
+    frustum.bottom() += frustumHeight * vp.y;
+    frustum.top()     = frustum.bottom() + frustumHeight * vp.h;
+    return frustum;
+}
+}
+
 void Channel::_frameTiles( const ChannelFrameTilesPacket* packet )
 {
-    RenderContext context = packet->context;
+    RenderContext context = _impl->getContext( packet->context );
     _setRenderContext( context );
 
-    frameTilesStart( packet->context.frameID );
+    frameTilesStart( context.frameID );
 
     RBStatPtr stat;
     if( packet->tasks & fabric::TASK_READBACK )
@@ -1399,14 +1426,17 @@ void Channel::_frameTiles( const ChannelFrameTilesPacket* packet )
     int64_t readbackTime = 0;
     bool hasAsyncReadback = false;
 
+    std::vector< TileCost > costs;
+    lunchbox::Clock tileClock;
     co::QueueSlave* queue = _getQueue( packet->queueVersion );
     LBASSERT( queue );
     for( co::Command* queuePacket = queue->pop(); queuePacket;
          queuePacket = queue->pop( ))
     {
+        tileClock.reset();
         const TileTaskPacket* tilePacket = queuePacket->get<TileTaskPacket>();
-        context.frustum = tilePacket->frustum;
-        context.ortho = tilePacket->ortho;
+        context.frustum = _getTileFrustum( packet->frustum, tilePacket->vp );
+        context.ortho = _getTileFrustum( packet->ortho, tilePacket->vp );
         context.pvp = tilePacket->pvp;
         context.vp = tilePacket->vp;
 
@@ -1419,14 +1449,14 @@ void Channel::_frameTiles( const ChannelFrameTilesPacket* packet )
         if( packet->tasks & fabric::TASK_CLEAR )
         {
             const int64_t time = getConfig()->getTime();
-            frameClear( packet->context.frameID );
+            frameClear( context.frameID );
             clearTime += getConfig()->getTime() - time;
         }
 
         if( packet->tasks & fabric::TASK_DRAW )
         {
             const int64_t time = getConfig()->getTime();
-            frameDraw( packet->context.frameID );
+            frameDraw( context.frameID );
             drawTime += getConfig()->getTime() - time;
         }
 
@@ -1444,7 +1474,7 @@ void Channel::_frameTiles( const ChannelFrameTilesPacket* packet )
                     getPixelViewport( ));
             }
 
-            frameReadback( packet->context.frameID );
+            frameReadback( context.frameID );
             readbackTime += getConfig()->getTime() - time;
 
             for( size_t i = 0; i < nFrames; ++i )
@@ -1463,9 +1493,26 @@ void Channel::_frameTiles( const ChannelFrameTilesPacket* packet )
             if( _asyncFinishReadback( nImages ))
                 hasAsyncReadback = true;
         }
+
+        if( packet->reportCosts )
+        {
+            TileCost cost;
+            cost.pvp = tilePacket->pvp;
+            cost.time = tileClock.getTimef();
+            costs.push_back( cost );
+        }
         queuePacket->release();
     }
 
+    if( !costs.empty( ))
+    {
+        ChannelFrameTileCostsPacket costsPacket;
+        costsPacket.objectID = getID();
+        costsPacket.queueID = packet->queueVersion.identifier;
+        costsPacket.nCosts = uint32_t( costs.size( ));
+        getServer()->send( costsPacket, costs );
+    }
+
     if( packet->tasks & fabric::TASK_CLEAR )
     {
         ChannelStatistics event( Statistic::CHANNEL_CLEAR, this );
@@ -1491,7 +1538,7 @@ void Channel::_frameTiles( const ChannelFrameTilesPacket* packet )
         _setReady( hasAsyncReadback, stat.get( ));
     }
 
-    frameTilesFinish( packet->context.frameID );
+    frameTilesFinish( context.frameID );
     resetRenderContext();
 }
 
@@ -2014,16 +2061,17 @@ bool Channel::_cmdConfigExit( co::Command& command )
 
 bool Channel::_cmdFrameStart( co::Command& command )
 {
-    ChannelFrameStartPacket* packet = 
-        command.getModifiable< ChannelFrameStartPacket >();
+    const ChannelFrameStartPacket* packet =
+        command.get< ChannelFrameStartPacket >();
     LBVERB << "handle channel frame start " << packet << std::endl;
 
     //_grabFrame( packet->frameNumber ); single-threaded
     sync( packet->version );
 
-    overrideContext( packet->context );
+    RenderContext context = _impl->getContext( packet->context );
+    overrideContext( context );
     bindFrameBuffer();
-    frameStart( packet->context.frameID, packet->frameNumber );
+    frameStart( context.frameID, packet->frameNumber );
 
     const size_t index = packet->frameNumber % _impl->statistics->size();
     detail::Channel::FrameStatistics& statistic = _impl->statistics.data[index];
@@ -2038,13 +2086,14 @@ bool Channel::_cmdFrameStart( co::Command& command )
 
 bool Channel::_cmdFrameFinish( co::Command& command )
 {
-    ChannelFrameFinishPacket* packet =
-        command.getModifiable< ChannelFrameFinishPacket >();
+    const ChannelFrameFinishPacket* packet =
+        command.get< ChannelFrameFinishPacket >();
     LBLOG( LOG_TASKS ) << "TASK frame finish " << getName() <<  " " << packet
                        << std::endl;
 
-    overrideContext( packet->context );
-    frameFinish( packet->context.frameID, packet->frameNumber );
+    RenderContext context = _impl->getContext( packet->context );
+    overrideContext( context );
+    frameFinish( context.frameID, packet->frameNumber );
     resetRenderContext();
 
     _unrefFrame( packet->frameNumber );
@@ -2054,14 +2103,15 @@ bool Channel::_cmdFrameFinish( co::Command& command )
 bool Channel::_cmdFrameClear( co::Command& command )
 {
     LBASSERT( _impl->state == STATE_RUNNING );
-    ChannelFrameClearPacket* packet = 
-        command.getModifiable< ChannelFrameClearPacket >();
+    const ChannelFrameClearPacket* packet =
+        command.get< ChannelFrameClearPacket >();
     LBLOG( LOG_TASKS ) << "TASK clear " << getName() <<  " " << packet
                        << std::endl;
 
-    _setRenderContext( packet->context );
+    RenderContext context = _impl->getContext( packet->context );
+    _setRenderContext( context );
     ChannelStatistics event( Statistic::CHANNEL_CLEAR, this );
-    frameClear( packet->context.frameID );
+    frameClear( context.frameID );
     resetRenderContext();
 
     return true;
@@ -2069,17 +2119,18 @@ bool Channel::_cmdFrameClear( co::Command& command )
 
 bool Channel::_cmdFrameDraw( co::Command& command )
 {
-    ChannelFrameDrawPacket* packet = 
-        command.getModifiable< ChannelFrameDrawPacket >();
+    const ChannelFrameDrawPacket* packet =
+        command.get< ChannelFrameDrawPacket >();
     LBLOG( LOG_TASKS ) << "TASK draw " << getName() <<  " " << packet
                        << std::endl;
 
-    _setRenderContext( packet->context );
+    RenderContext context = _impl->getContext( packet->context );
+    _setRenderContext( context );
     const uint32_t frameNumber = getCurrentFrame();
     ChannelStatistics event( Statistic::CHANNEL_DRAW, this, frameNumber,
                              packet->finish ? NICEST : AUTO );
 
-    frameDraw( packet->context.frameID );
+    frameDraw( context.frameID );
     // Update ROI for server equalizers
     if( !getRegion().isValid( ))
         declareRegion( getPixelViewport( ));
@@ -2106,12 +2157,13 @@ bool Channel::_cmdFrameDrawFinish( co::Command& command )
 
 bool Channel::_cmdFrameAssemble( co::Command& command )
 {
-    ChannelFrameAssemblePacket* packet = 
-        command.getModifiable< ChannelFrameAssemblePacket >();
+    const ChannelFrameAssemblePacket* packet =
+        command.get< ChannelFrameAssemblePacket >();
     LBLOG( LOG_TASKS | LOG_ASSEMBLY ) << "TASK assemble " << getName() <<  " " 
                                       << packet << std::endl;
 
-    _setRenderContext( packet->context );
+    RenderContext context = _impl->getContext( packet->context );
+    _setRenderContext( context );
     ChannelStatistics event( Statistic::CHANNEL_ASSEMBLE, this );
     for( uint32_t i=0; i<packet->nFrames; ++i )
     {
@@ -2120,7 +2172,7 @@ bool Channel::_cmdFrameAssemble( co::Command& command )
         _impl->inputFrames.push_back( frame );
     }
 
-    frameAssemble( packet->context.frameID );
+    frameAssemble( context.frameID );
 
     for( FramesCIter i = _impl->inputFrames.begin();
          i != _impl->inputFrames.end(); ++i )
@@ -2143,8 +2195,9 @@ bool Channel::_cmdFrameReadback( co::Command& command )
     LBLOG( LOG_TASKS | LOG_ASSEMBLY ) << "TASK readback " << getName() <<  " "
                                       << packet << std::endl;
 
-    _setRenderContext( packet->context );
-    _frameReadback( packet->context.frameID, packet->nFrames, packet->frames );
+    RenderContext context = _impl->getContext( packet->context );
+    _setRenderContext( context );
+    _frameReadback( context.frameID, packet->nFrames, packet->frames );
     resetRenderContext();
     return true;
 }
@@ -2209,13 +2262,14 @@ bool Channel::_cmdFrameSetReadyNode( co::Command& command )
 
 bool Channel::_cmdFrameViewStart( co::Command& command )
 {
-    ChannelFrameViewStartPacket* packet = 
-        command.getModifiable< ChannelFrameViewStartPacket >();
+    const ChannelFrameViewStartPacket* packet =
+        command.get< ChannelFrameViewStartPacket >();
     LBLOG( LOG_TASKS ) << "TASK view start " << getName() <<  " " << packet
                        << std::endl;
 
-    _setRenderContext( packet->context );
-    frameViewStart( packet->context.frameID );
+    RenderContext context = _impl->getContext( packet->context );
+    _setRenderContext( context );
+    frameViewStart( context.frameID );
     resetRenderContext();
 
     return true;
@@ -2223,14 +2277,15 @@ bool Channel::_cmdFrameViewStart( co::Command& command )
 
 bool Channel::_cmdFrameViewFinish( co::Command& command )
 {
-    ChannelFrameViewFinishPacket* packet = 
-        command.getModifiable< ChannelFrameViewFinishPacket >();
+    const ChannelFrameViewFinishPacket* packet =
+        command.get< ChannelFrameViewFinishPacket >();
     LBLOG( LOG_TASKS ) << "TASK view finish " << getName() <<  " " << packet
                        << std::endl;
 
-    _setRenderContext( packet->context );
+    RenderContext context = _impl->getContext( packet->context );
+    _setRenderContext( context );
     ChannelStatistics event( Statistic::CHANNEL_VIEW_FINISH, this );
-    frameViewFinish( packet->context.frameID );
+    frameViewFinish( context.frameID );
     resetRenderContext();
 
     return true;
@@ -2258,6 +2313,33 @@ bool Channel::_cmdFrameTiles( co::Command& command )
     return true;
 }
 
+bool Channel::_cmdFrameContext( co::Command& command )
+{
+    const ChannelFrameContextPacket* packet =
+        command.get< ChannelFrameContextPacket >();
+    LBLOG( LOG_TASKS ) << "TASK channel frame context " << getName() <<  " "
+                       << packet << std::endl;
+
+    // the server allocates context indices consecutively
+    std::vector< RenderContext >& contexts = _impl->contexts;
+    const uint8_t* data = packet->data;
+    const size_t header = data - reinterpret_cast< const uint8_t* >( packet );
+    const size_t size = RenderContext::getDeltaSize( packet->fields );
+    if( packet->index > contexts.size() || packet->size < header ||
+        size > packet->size - header )
+    {
+        LBWARN << "Ignoring malformed render context update " << packet
+               << " of " << packet->size << " bytes" << std::endl;
+        return true;
+    }
+
+    if( packet->index == contexts.size( ))
+        contexts.resize( packet->index + 1 );
+    LBCHECK( contexts[ packet->index ].deserializeDelta( packet->fields,
+                                                         data ) == size );
+    return true;
+}
+
 bool Channel::_cmdDeleteTransferContext( co::Command& command )
 {
     const ChannelDeleteTransferContextPacket* packet =
@@ -640,6 +640,7 @@ namespace detail { class Channel; struct RBStat; }
         bool _cmdFrameViewFinish( co::Command& command );
         bool _cmdStopFrame( co::Command& command );
         bool _cmdFrameTiles( co::Command& command );
+        bool _cmdFrameContext( co::Command& command );
         bool _cmdDeleteTransferContext( co::Command& command );
 
         LB_TS_VAR( _pipeThread );
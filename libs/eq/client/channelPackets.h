@@ -21,6 +21,7 @@
 
 #include <eq/client/packets.h> // base structs
 #include <eq/client/statistic.h> // member
+#include <eq/fabric/queuePackets.h> // member
 #include <eq/fabric/renderContext.h> // member
 
 /** @cond IGNORE */
@@ -86,7 +87,21 @@ namespace detail { struct RBStat; }
 
     struct ChannelTaskPacket : public ChannelPacket
     {
-        RenderContext context;
+        uint32_t context; //!< index of the ChannelFrameContextPacket context
+    };
+
+    /** Updates a render context with the fields changed since last use. */
+    struct ChannelFrameContextPacket : public ChannelPacket
+    {
+        ChannelFrameContextPacket()
+            {
+                command = fabric::CMD_CHANNEL_FRAME_CONTEXT;
+                size    = sizeof( ChannelFrameContextPacket );
+            }
+
+        uint32_t index;  //!< the render context index
+        uint32_t fields; //!< changed fields, see RenderContext::getDelta()
+        LB_ALIGN8( uint8_t data[8] );
     };
 
     struct ChannelFrameStartPacket : public ChannelTaskPacket
@@ -284,13 +299,29 @@ namespace detail { struct RBStat; }
             size              = sizeof( ChannelFrameTilesPacket );
         }
 
+        Frustumf          frustum; //!< untiled frustum of the tile queue
+        Frustumf          ortho;   //!< untiled ortho frustum of the tile queue
         bool              isLocal;
+        bool              reportCosts; //!< send TileCosts after processing
         co::ObjectVersion queueVersion;
         uint32_t          tasks;
         uint32_t          nFrames;
         LB_ALIGN8( co::ObjectVersion frames[1] );
     };
 
+    struct ChannelFrameTileCostsPacket : public ChannelPacket
+    {
+        ChannelFrameTileCostsPacket()
+        {
+            command           = fabric::CMD_CHANNEL_FRAME_TILE_COSTS;
+            size              = sizeof( ChannelFrameTileCostsPacket );
+        }
+
+        UUID     queueID;
+        uint32_t nCosts;
+        LB_ALIGN8( TileCost costs[1] );
+    };
+
     inline std::ostream& operator << ( std::ostream& os, 
                                     const ChannelConfigInitReplyPacket* packet )
     {
@@ -320,7 +351,14 @@ namespace detail { struct RBStat; }
     inline std::ostream& operator << ( std::ostream& os, 
                                        const ChannelTaskPacket* packet )
     {
-        os << (co::ObjectPacket*)packet << " " << packet->context;
+        os << (co::ObjectPacket*)packet << " context " << packet->context;
+        return os;
+    }
+    inline std::ostream& operator << ( std::ostream& os,
+                                       const ChannelFrameContextPacket* packet )
+    {
+        os << (co::ObjectPacket*)packet << " context " << packet->index
+           << " fields " << std::hex << packet->fields << std::dec;
         return os;
     }
     inline std::ostream& operator << ( std::ostream& os, 
@@ -36,6 +36,7 @@
 #include "server.h"
 #include "view.h"
 #include "window.h"
+#include "detail/statisticsStore.h"
 
 #include <eq/fabric/configVisitor.h>
 #include <eq/fabric/task.h>
@@ -82,6 +83,7 @@ public:
             : lastEvent( 0 )
             , currentFrame( 0 )
             , unlockedFrame( 0 )
+            , statistics( 4096 )
             , finishedFrame( 0 )
             , running( false )
     {
@@ -107,9 +109,8 @@ public:
     /** The connections configured by the server for this config. */
     co::Connections connections;
 
-    /** Global statistics events, index per frame and channel. */
-    lunchbox::Lockable< std::deque< FrameStatistics >, lunchbox::SpinLock >
-        statistics;
+    /** Global statistics events, index per frame and originator. */
+    detail::StatisticsStore statistics;
 
     /** The last started frame. */
     uint32_t currentFrame;
@@ -187,6 +188,8 @@ void Config::attach( const UUID& id, const uint32_t instanceID )
                      ConfigFunc( this, &Config::_cmdSyncClock ), 0 );
     registerCommand( fabric::CMD_CONFIG_SWAP_OBJECT,
                      ConfigFunc( this, &Config::_cmdSwapObject ), 0 );
+    registerCommand( fabric::CMD_CONFIG_STATISTICS,
+                     ConfigFunc( this, &Config::_cmdStatistics ), 0 );
 }
 
 void Config::notifyAttached()
@@ -590,6 +593,17 @@ void Config::sendEvent( ConfigEvent& event )
         send( _impl->appNode, event );
 }
 
+void Config::sendStatistics( const std::vector< Event >& events )
+{
+    LBASSERT( _impl->appNode );
+    if( events.empty() || !_impl->appNode )
+        return;
+
+    ConfigStatisticsPacket packet;
+    packet.nEvents = uint32_t( events.size( ));
+    send( _impl->appNode, packet, events );
+}
+
 const ConfigEvent* Config::nextEvent()
 {
     if( _impl->lastEvent )
@@ -667,30 +681,7 @@ bool Config::handleEvent( const ConfigEvent* event )
                 return false;
             }
 
-            lunchbox::ScopedFastWrite mutex( _impl->statistics );
-
-            for( std::deque<FrameStatistics>::iterator i =
-                     _impl->statistics->begin();
-                 i != _impl->statistics->end(); ++i )
-            {
-                FrameStatistics& frameStats = *i;
-                if( frameStats.first == frame )
-                {
-                    SortedStatistics& sortedStats = frameStats.second;
-                    Statistics&       statistics  = sortedStats[ originator ];
-                    statistics.push_back( statistic );
-                    return false;
-                }
-            }
-
-            _impl->statistics->push_back( FrameStatistics( ));
-            FrameStatistics& frameStats = _impl->statistics->back();
-            frameStats.first = frame;
-
-            SortedStatistics& sortedStats = frameStats.second;
-            Statistics&       statistics  = sortedStats[ originator ];
-            statistics.push_back( statistic );
-
+            _impl->statistics.add( originator, &statistic, 1 );
             return false;
         }
 
@@ -741,24 +732,27 @@ bool Config::_needsLocalSync() const
 void Config::_updateStatistics( const uint32_t finishedFrame )
 {
     // keep statistics for three frames
-    lunchbox::ScopedMutex< lunchbox::SpinLock > mutex( _impl->statistics );
-    while( !_impl->statistics->empty() &&
-           finishedFrame - _impl->statistics->front().first > 2 )
+    _impl->statistics.update( finishedFrame, 3, getLatency( ));
+
+    // deliver the statistics batched by the render nodes, see handleEvent()
+    detail::StatisticsStore::Record* record = 0;
+    while( _impl->statistics.pop( record ))
     {
-        _impl->statistics->pop_front();
+        const std::vector< Event >& events = record->events;
+        ConfigEvent event;
+        for( std::vector< Event >::const_iterator i = events.begin();
+             i != events.end(); ++i )
+        {
+            event.data = *i;
+            handleEvent( &event );
+        }
+        delete record;
     }
 }
 
 void Config::getStatistics( std::vector< FrameStatistics >& statistics )
 {
-    lunchbox::ScopedMutex< lunchbox::SpinLock > mutex( _impl->statistics );
-
-    for( std::deque<FrameStatistics>::const_iterator i =
-             _impl->statistics->begin(); i != _impl->statistics->end(); ++i )
-    {
-        if( (*i).first <= _impl->finishedFrame.get( ))
-            statistics.push_back( *i );
-    }
+    _impl->statistics.get( statistics );
 }
 
 uint32_t Config::getCurrentFrame() const
@@ -1070,6 +1064,20 @@ bool Config::_cmdSyncClock( co::Command& command )
     return true;
 }
 
+bool Config::_cmdStatistics( co::Command& command )
+{
+    const ConfigStatisticsPacket* packet =
+        command.get< ConfigStatisticsPacket >();
+    LBLOG( LOG_STATS ) << packet << std::endl;
+
+    // handled by the application thread in _updateStatistics()
+    detail::StatisticsStore::Record* record =
+        new detail::StatisticsStore::Record;
+    record->events.assign( packet->events, packet->events + packet->nEvents );
+    _impl->statistics.push( record );
+    return true;
+}
+
 bool Config::_cmdSwapObject( co::Command& command )
 {
     const ConfigSwapObjectPacket* packet =
@@ -339,6 +339,14 @@ namespace detail { class Config; }
          */
         EQ_API void sendEvent( ConfigEvent& event );
 
+        /**
+         * @internal
+         * Send a batch of statistic events to the application node.
+         *
+         * The application delivers each event to handleEvent() once per frame.
+         */
+        void sendStatistics( const std::vector< Event >& events );
+
         /** 
          * Get the next event.
          * 
@@ -435,6 +443,7 @@ namespace detail { class Config; }
 
         /** The command functions. */
         bool _cmdSyncClock( co::Command& command );
+        bool _cmdStatistics( co::Command& command );
         bool _cmdCreateNode( co::Command& command );
         bool _cmdDestroyNode( co::Command& command );
         bool _cmdInitReply( co::Command& command );
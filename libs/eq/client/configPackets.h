@@ -20,6 +20,7 @@
 #define EQ_CONFIGPACKETS_H
 
 #include <eq/client/packets.h> // base structs
+#include <eq/client/event.h>  // member
 
 /** @cond IGNORE */
 namespace eq
@@ -215,6 +216,25 @@ namespace eq
         co::Object*     object;
     };
 
+    struct ConfigStatisticsPacket : public ConfigPacket
+    {
+        ConfigStatisticsPacket()
+        {
+            command   = fabric::CMD_CONFIG_STATISTICS;
+            size      = sizeof( ConfigStatisticsPacket );
+        }
+
+        uint32_t nEvents;
+        LB_ALIGN8( Event events[1] );
+    };
+
+    inline std::ostream& operator << ( std::ostream& os, 
+                                       const ConfigStatisticsPacket* packet )
+    {
+        os << (ConfigPacket*)packet << " statistics " << packet->nEvents;
+        return os;
+    }
+
     inline std::ostream& operator << ( std::ostream& os, 
                                        const ConfigFrameFinishPacket* packet )
     {
@@ -89,6 +89,15 @@ public:
 
     /** The number of the last finished frame. */
     lunchbox::Monitor< uint32_t > finishedFrame;
+
+    /** Server-supplied render contexts, referenced by the task packets. */
+    std::vector< RenderContext > contexts;
+
+    const RenderContext& getContext( const uint32_t index ) const
+        {
+            LBASSERTINFO( index < contexts.size(), index );
+            return contexts[ index ];
+        }
 };
 
 }
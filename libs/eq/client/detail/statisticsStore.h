@@ -0,0 +1,203 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQ_DETAIL_STATISTICSSTORE_H
+#define EQ_DETAIL_STATISTICSSTORE_H
+
+#include <eq/client/event.h>     // member
+#include <eq/client/statistic.h> // used inline
+#include <eq/client/types.h>
+
+#include <lunchbox/lfQueue.h>
+#include <lunchbox/lockable.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/spinLock.h>
+
+#include <deque>
+
+namespace eq
+{
+namespace detail
+{
+/**
+ * The statistics received by the application, sorted per frame and originator.
+ *
+ * Batches of statistic events are queued lock-free by a single producer,
+ * typically the receiver thread. The application thread pops them once per
+ * frame and sorts the statistics into a ring buffer of frames. Readers copy the
+ * finished frames under a lock held only for the copy.
+ */
+class StatisticsStore
+{
+public:
+    /** A batch of statistic events of one node. */
+    struct Record
+    {
+        std::vector< Event > events;
+    };
+
+    /** Construct a new store queueing at most queueSize records. */
+    explicit StatisticsStore( const size_t queueSize )
+        : _queue( queueSize ), _finishedFrame( 0 ), _nFrames( 0 )
+    {
+        _frames.data.resize( 8 ); // until the first update()
+    }
+
+    ~StatisticsStore()
+    {
+        Record* record = 0;
+        while( pop( record ))
+            delete record;
+    }
+
+    /**
+     * Queue a batch of statistics and take ownership. Single producer.
+     *
+     * Lock-free unless the queue is full, in which case the record is kept in
+     * an overflow list guarded by a spin lock.
+     *
+     * @return true if the record was queued lock-free, false otherwise.
+     */
+    bool push( Record* record )
+    {
+        if( _queue.push( record ))
+            return true;
+
+        lunchbox::ScopedFastWrite mutex( _overflow );
+        _overflow->push_back( record );
+        return false;
+    }
+
+    /**
+     * Retrieve the next queued batch. Single consumer.
+     *
+     * @return true if a record was returned, which is owned by the caller.
+     */
+    bool pop( Record*& record )
+    {
+        if( _queue.pop( record ))
+            return true;
+
+        lunchbox::ScopedFastWrite mutex( _overflow );
+        if( _overflow->empty( ))
+            return false;
+        record = _overflow->front();
+        _overflow->pop_front();
+        return true;
+    }
+
+    /** Sort the given statistics directly. Thread-safe. */
+    void add( const uint32_t originator, const Statistic* statistics,
+              const size_t nStatistics )
+    {
+        lunchbox::ScopedFastWrite mutex( _frames );
+        _sort( originator, statistics, nStatistics );
+    }
+
+    /**
+     * Update the frames kept by the store.
+     *
+     * @param finishedFrame the last finished frame.
+     * @param nFrames the number of frames to keep before the finished frame.
+     * @param latency the number of frames in flight after the finished frame.
+     */
+    void update( const uint32_t finishedFrame, const uint32_t nFrames,
+                 const uint32_t latency )
+    {
+        lunchbox::ScopedFastWrite mutex( _frames );
+        _finishedFrame = finishedFrame;
+        _nFrames = nFrames;
+        _resize( nFrames + latency + 1 );
+    }
+
+    /** Copy the kept, finished frames. Thread-safe. */
+    void get( std::vector< FrameStatistics >& statistics )
+    {
+        lunchbox::ScopedFastWrite mutex( _frames );
+        for( std::vector< FrameStatistics >::const_iterator i =
+                 _frames.data.begin(); i != _frames.data.end(); ++i )
+        {
+            const uint32_t frame = i->first;
+            if( frame > 0 && frame <= _finishedFrame &&
+                _finishedFrame - frame < _nFrames )
+            {
+                statistics.push_back( *i );
+            }
+        }
+    }
+
+private:
+    lunchbox::LFQueue< Record* > _queue;
+    lunchbox::Lockable< std::deque< Record* >, lunchbox::SpinLock > _overflow;
+    lunchbox::Lockable< std::vector< FrameStatistics >,
+                        lunchbox::SpinLock > _frames;
+    uint32_t _finishedFrame;
+    uint32_t _nFrames;
+
+    void _resize( const size_t size )
+    {
+        if( _frames.data.size() == size )
+            return;
+
+        std::vector< FrameStatistics > frames( size );
+        for( std::vector< FrameStatistics >::iterator i = _frames.data.begin();
+             i != _frames.data.end(); ++i )
+        {
+            FrameStatistics& slot = frames[ i->first % size ];
+            if( i->first > slot.first )
+                slot = *i;
+        }
+        _frames.data.swap( frames );
+    }
+
+    void _sort( const uint32_t originator, const Statistic* statistics,
+                const size_t nStatistics )
+    {
+        uint32_t frame = 0;
+        Statistics* sorted = 0;
+        for( size_t i = 0; i < nStatistics; ++i )
+        {
+            const Statistic& statistic = statistics[i];
+            if( statistic.frameNumber == 0 ) // not a frame-related statistic
+                continue;
+
+            if( statistic.frameNumber != frame )
+            {
+                frame = statistic.frameNumber;
+                FrameStatistics& slot =
+                    _frames.data[ frame % _frames.data.size( )];
+                if( slot.first > frame ) // slot reused, statistic too old
+                {
+                    sorted = 0;
+                    continue;
+                }
+                if( slot.first != frame )
+                {
+                    slot.first = frame;
+                    slot.second.clear();
+                }
+                sorted = &slot.second[ originator ];
+            }
+            if( sorted )
+                sorted->push_back( statistic );
+        }
+    }
+};
+}
+}
+
+#endif // EQ_DETAIL_STATISTICSSTORE_H
@@ -96,6 +96,7 @@ set(CLIENT_HEADERS
 
 set(CLIENT_SOURCES
   detail/channel.ipp
+  detail/statisticsStore.h
   canvas.cpp
   channel.cpp
   channelStatistics.cpp
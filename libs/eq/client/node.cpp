@@ -22,6 +22,7 @@
 #include "config.h"
 #include "configPackets.h"
 #include "error.h"
+#include "event.h"
 #include "exception.h"
 #include "frameData.h"
 #include "global.h"
@@ -39,13 +40,21 @@
 #include <co/barrier.h>
 #include <co/command.h>
 #include <co/connection.h>
+#include <lunchbox/lockable.h>
 #include <lunchbox/scopedMutex.h>
+#include <lunchbox/spinLock.h>
 
 namespace eq
 {
 /** @cond IGNORE */
 typedef co::CommandFunc<Node> NodeFunc;
 typedef fabric::Node< Config, Node, Pipe, NodeVisitor > Super;
+
+struct Node::Private
+{
+    /** Statistic events of all channels, sent once per frame. */
+    lunchbox::Lockable< std::vector< Event >, lunchbox::SpinLock > statistics;
+};
 /** @endcond */
 
 Node::Node( Config* parent )
@@ -57,12 +66,14 @@ Node::Node( Config* parent )
         , _state( STATE_STOPPED )
         , _finishedFrame( 0 )
         , _unlockedFrame( 0 )
+        , _private( new Private )
 {
 }
 
 Node::~Node()
 {
     LBASSERT( getPipes().empty( ));
+    delete _private;
 }
 
 void Node::attach( const UUID& id, const uint32_t instanceID )
@@ -255,9 +266,27 @@ void Node::_finishFrame( const uint32_t frameNumber ) const
     }
 }
 
+void Node::addStatistic( const Event& event )
+{
+    lunchbox::ScopedFastWrite mutex( _private->statistics );
+    _private->statistics->push_back( event );
+}
+
+void Node::_flushStatistics()
+{
+    std::vector< Event > statistics;
+    {
+        lunchbox::ScopedFastWrite mutex( _private->statistics );
+        statistics.swap( _private->statistics.data );
+    }
+    getConfig()->sendStatistics( statistics );
+}
+
 void Node::_frameFinish( const uint128_t& frameID, 
                          const uint32_t frameNumber )
 {
+    // all pipes finished the frame, late channel statistics go with the next
+    _flushStatistics();
     frameFinish( frameID, frameNumber );
     LBLOG( LOG_TASKS ) << "---- Finished Frame --- " << frameNumber
                        << std::endl;
@@ -522,7 +551,8 @@ bool Node::_cmdConfigExit( co::Command& command )
         Pipe* pipe = *i;
         pipe->waitExited();
     }
-    
+    _flushStatistics();
+
     _state = configExit() ? STATE_STOPPED : STATE_FAILED;
     transmitter.getQueue().wakeup();
     transmitter.join();
@@ -118,6 +118,15 @@ namespace eq
         /** @internal @return the number of the last finished frame. */
         uint32_t getFinishedFrame() const { return _finishedFrame; }
 
+        /**
+         * @internal
+         * Queue a statistic event for the application node.
+         *
+         * The queued events are sent in one packet when the node finishes a
+         * frame.
+         */
+        void addStatistic( const Event& event );
+
         /** @internal */
         class TransmitThread : public lunchbox::Thread
         {
@@ -296,6 +305,9 @@ namespace eq
         void _frameFinish( const uint128_t& frameID,
                            const uint32_t frameNumber );
 
+        /** Send the queued statistic events to the application node. */
+        void _flushStatistics();
+
         void _flushObjects();
 
         /** The command functions. */
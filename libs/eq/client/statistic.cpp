@@ -75,6 +75,8 @@ static StatisticData _statisticData[] =
    "pipe idle",    Vector3f( 1.f, 1.f, 1.f ) }, 
  { Statistic::NODE_FRAME_DECOMPRESS,
    "decompress",   Vector3f( 0.f, .7f, 1.f ) }, 
+ { Statistic::NODE_FRAME_CREDITS,
+   "wait credits", Vector3f( 1.0f, .5f, 0.f ) }, 
  { Statistic::CONFIG_START_FRAME,
    "start frame",  Vector3f( .5f, 1.0f, .5f ) }, 
  { Statistic::CONFIG_FINISH_FRAME,
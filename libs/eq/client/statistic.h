@@ -59,6 +59,8 @@ namespace eq
             WINDOW_FPS, //!< Framerate sampling
             PIPE_IDLE, //!< Pipe thread idle ratio
             NODE_FRAME_DECOMPRESS, //!< Sampling of frame decompression
+            /** Sampling of application throttling by the node frame credits */
+            NODE_FRAME_CREDITS,
             CONFIG_START_FRAME, //!< Sampling of Config::startFrame
             CONFIG_FINISH_FRAME, //!< Sampling of Config::finishFrame
             /** Sampling of synchronization time during Config::finishFrame */
@@ -90,6 +90,7 @@ using fabric::Projection;
 using fabric::Range;
 using fabric::RenderContext;
 using fabric::SubPixel;
+using fabric::TileCost;
 using fabric::TileTaskPacket;
 using fabric::Viewport;
 using fabric::Wall;
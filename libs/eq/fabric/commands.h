@@ -95,6 +95,7 @@ namespace fabric
         CMD_CONFIG_EVENT,
         CMD_CONFIG_SYNC_CLOCK,
         CMD_CONFIG_SWAP_OBJECT,
+        CMD_CONFIG_STATISTICS,
         CMD_CONFIG_CUSTOM = 45 // some buffer for binary-compatible patches
     };
 
@@ -182,6 +183,8 @@ namespace fabric
         CMD_CHANNEL_FRAME_TILES,
         CMD_CHANNEL_FINISH_READBACK,
         CMD_CHANNEL_DELETE_TRANSFER_CONTEXT,
+        CMD_CHANNEL_FRAME_TILE_COSTS,
+        CMD_CHANNEL_FRAME_CONTEXT,
         CMD_CHANNEL_CUSTOM = 45 // some buffer for binary-compatible patches
     };
 
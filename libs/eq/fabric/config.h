@@ -137,6 +137,7 @@ namespace fabric
         enum IAttribute
         {
             IATTR_ROBUSTNESS, //!< Tolerate resource failures
+            IATTR_LAUNCH_CONCURRENCY, //!< Max number of parallel node launches
             IATTR_LAST,
             IATTR_ALL = IATTR_LAST + 5
         };
@@ -45,6 +45,7 @@ std::string _fAttributeStrings[] =
 std::string _iAttributeStrings[] = 
 {
     MAKE_ATTR_STRING( IATTR_ROBUSTNESS ),
+    MAKE_ATTR_STRING( IATTR_LAUNCH_CONCURRENCY ),
 };
 }
 
@@ -905,8 +906,12 @@ std::ostream& operator << ( std::ostream& os,
        << "robustness "
        << IAttribute( config.getIAttribute( C::IATTR_ROBUSTNESS )) << std::endl
        << "eye_base   " << config.getFAttribute( C::FATTR_EYE_BASE )
-       << std::endl
-       << lunchbox::exdent << "}" << std::endl;
+       << std::endl;
+    const int32_t concurrency =
+        config.getIAttribute( C::IATTR_LAUNCH_CONCURRENCY );
+    if( concurrency != AUTO )
+        os << "launch_concurrency " << IAttribute( concurrency ) << std::endl;
+    os << lunchbox::exdent << "}" << std::endl;
 
     const typename C::Nodes& nodes = config.getNodes();
     for( typename C::Nodes::const_iterator i = nodes.begin();
@@ -82,6 +82,7 @@ namespace fabric
             IATTR_THREAD_MODEL,
             IATTR_LAUNCH_TIMEOUT, //!< Timeout when auto-launching the node
             IATTR_HINT_AFFINITY,
+            IATTR_FRAME_CREDITS, //!< Max frames in flight on the node
             IATTR_LAST,
             IATTR_ALL = IATTR_LAST + 5
         };
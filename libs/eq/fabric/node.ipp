@@ -37,7 +37,8 @@ namespace
 std::string _iAttributeStrings[] = {
     MAKE_ATTR_STRING( IATTR_THREAD_MODEL ),
     MAKE_ATTR_STRING( IATTR_LAUNCH_TIMEOUT ),
-    MAKE_ATTR_STRING( IATTR_HINT_AFFINITY )
+    MAKE_ATTR_STRING( IATTR_HINT_AFFINITY ),
+    MAKE_ATTR_STRING( IATTR_FRAME_CREDITS )
 };
 
 }
@@ -99,6 +99,9 @@ namespace fabric
         /** @return true if the object has data to commit. @version 1.0 */
         EQFABRIC_API virtual bool isDirty() const;
 
+        /** @internal isDirty() also reports changed user data. */
+        virtual bool isDirtyTracked() const { return false; }
+
         /** @internal */
         EQFABRIC_API virtual uint128_t commit( const uint32_t incarnation =
                                                CO_COMMIT_NEXT );
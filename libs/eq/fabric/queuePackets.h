@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2011, Stefan Eilemann <eile@eyescale.ch>
+/* Copyright (c) 2011-2012, Stefan Eilemann <eile@eyescale.ch>
  *
  * This library is free software; you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 2.1 as published
@@ -51,9 +51,14 @@ struct TileTaskPacket : public co::QueueItemPacket
     }
 
     PixelViewport pvp;
-    Viewport vp;
-    Frustumf frustum;
-    Frustumf ortho;
+    Viewport vp; //!< frusta are derived from the tile packet's base frusta
+};
+
+/** The render time of one tile, reported back for cost-ordered queues. */
+struct TileCost
+{
+    PixelViewport pvp; //!< the pvp of the originating TileTaskPacket
+    float time;        //!< clear, draw and readback time in ms
 };
 
 } // fabric
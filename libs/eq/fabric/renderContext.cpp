@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2006-2011, Stefan Eilemann <eile@equalizergraphics.com> 
+/* Copyright (c) 2006-2012, Stefan Eilemann <eile@equalizergraphics.com> 
  *
  * This library is free software; you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 2.1 as published
@@ -17,6 +17,18 @@
 
 #include "renderContext.h"
 
+#include <cstring>
+#include <limits>
+
+// All fields transmitted by the delta encoding, one bit each
+#define EQ_RENDERCONTEXT_FIELDS                                         \
+    FIELD( frustum ) FIELD( ortho ) FIELD( headTransform )              \
+    FIELD( orthoTransform ) FIELD( view ) FIELD( frameID ) FIELD( pvp ) \
+    FIELD( pixel ) FIELD( overdraw ) FIELD( vp ) FIELD( offset )        \
+    FIELD( range ) FIELD( subpixel ) FIELD( zoom ) FIELD( buffer )      \
+    FIELD( taskID ) FIELD( period ) FIELD( phase ) FIELD( eye )         \
+    FIELD( bufferMask )
+
 namespace eq
 {
 namespace fabric
@@ -38,6 +50,71 @@ RenderContext::RenderContext()
 {
 }
 
+uint32_t RenderContext::getDelta( const RenderContext& previous ) const
+{
+    uint32_t fields = 0;
+    uint32_t bit = 1;
+#define FIELD( name )                                                 \
+    if( ::memcmp( &name, &previous.name, sizeof( name )) != 0 )       \
+        fields |= bit;                                                \
+    bit <<= 1;
+
+    EQ_RENDERCONTEXT_FIELDS
+#undef FIELD
+    return fields;
+}
+
+size_t RenderContext::getDeltaSize( const uint32_t fields )
+{
+    const RenderContext* context = 0;
+    size_t size = 0;
+    uint32_t bit = 1;
+#define FIELD( name )                                                 \
+    if( fields & bit )                                                \
+        size += sizeof( context->name );                              \
+    bit <<= 1;
+
+    EQ_RENDERCONTEXT_FIELDS
+#undef FIELD
+    return ( fields & ~( bit - 1 )) ? std::numeric_limits< size_t >::max() :
+                                      size;
+}
+
+void RenderContext::serializeDelta( const uint32_t fields,
+                                    std::vector< uint8_t >& data ) const
+{
+    uint32_t bit = 1;
+#define FIELD( name )                                                 \
+    if( fields & bit )                                                \
+    {                                                                 \
+        const uint8_t* ptr = reinterpret_cast< const uint8_t* >(      \
+            &name );                                                  \
+        data.insert( data.end(), ptr, ptr + sizeof( name ));          \
+    }                                                                 \
+    bit <<= 1;
+
+    EQ_RENDERCONTEXT_FIELDS
+#undef FIELD
+}
+
+size_t RenderContext::deserializeDelta( const uint32_t fields,
+                                        const uint8_t* data )
+{
+    size_t size = 0;
+    uint32_t bit = 1;
+#define FIELD( name )                                                 \
+    if( fields & bit )                                                \
+    {                                                                 \
+        ::memcpy( &name, data + size, sizeof( name ));                \
+        size += sizeof( name );                                       \
+    }                                                                 \
+    bit <<= 1;
+
+    EQ_RENDERCONTEXT_FIELDS
+#undef FIELD
+    return size;
+}
+
 std::ostream& operator << ( std::ostream& os, const RenderContext& ctx )
 {
     os << "ID " << ctx.frameID << " pvp " << ctx.pvp << " vp " << ctx.vp << " "
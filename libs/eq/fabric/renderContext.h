@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2006-2011, Stefan Eilemann <eile@equalizergraphics.com> 
+/* Copyright (c) 2006-2012, Stefan Eilemann <eile@equalizergraphics.com> 
  *
  * This library is free software; you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 2.1 as published
@@ -30,6 +30,8 @@
 #include <co/objectVersion.h>
 #include <eq/fabric/api.h>
 
+#include <vector>
+
 namespace eq
 {
 namespace fabric
@@ -40,6 +42,30 @@ namespace fabric
     public: 
         EQFABRIC_API RenderContext();
 
+        /**
+         * @internal
+         * @return the bitmask of the fields differing from the given context.
+         */
+        EQFABRIC_API uint32_t getDelta( const RenderContext& previous ) const;
+
+        /**
+         * @internal
+         * @return the serialized size of the given fields, or the maximum
+         *         size_t value if unknown fields are set.
+         */
+        EQFABRIC_API static size_t getDeltaSize( const uint32_t fields );
+
+        /** @internal Append the given fields to the data. */
+        EQFABRIC_API void serializeDelta( const uint32_t fields,
+                                          std::vector< uint8_t >& data ) const;
+
+        /**
+         * @internal Apply the fields serialized by serializeDelta().
+         * @return the number of bytes consumed from the data.
+         */
+        EQFABRIC_API size_t deserializeDelta( const uint32_t fields,
+                                              const uint8_t* data );
+
         Frustumf       frustum;        //!< frustum for projection matrix
         Frustumf       ortho;          //!< ortho frustum for projection matrix
 
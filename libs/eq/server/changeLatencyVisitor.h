@@ -20,6 +20,7 @@
 #define EQSERVER_CHANGELATENCYVISITOR_H
 
 #include "compound.h"
+#include "config.h"
 #include "configVisitor.h"
 #include "frame.h"
 #include "layout.h"
@@ -43,12 +44,14 @@ public:
 
     virtual VisitorResult visit( Compound* compound )
     { 
+        // frame data is used by render nodes up to their frame credits behind
+        const uint32_t window = compound->getConfig()->getFrameWindow();
         const Frames& outputFrames = compound->getOutputFrames();
         for( FramesCIter i = outputFrames.begin(); 
              i != outputFrames.end(); ++i )
         {
             Frame* frame = *i;
-            frame->setAutoObsolete( _latency );
+            frame->setAutoObsolete( window );
         }
 
         const Frames& inputFrames = compound->getInputFrames();
@@ -56,7 +59,7 @@ public:
              i != inputFrames.end(); ++i )
         {
             Frame* frame = *i;
-            frame->setAutoObsolete( _latency );
+            frame->setAutoObsolete( window );
         }
 
         const TileQueues& outputTileQueues = compound->getOutputTileQueues();
@@ -64,7 +67,7 @@ public:
              i != outputTileQueues.end(); ++i )
         {
             TileQueue* queue = *i;
-            queue->setAutoObsolete( _latency );
+            queue->setAutoObsolete( window );
         }
 
         const TileQueues& inputTileQueues = compound->getInputTileQueues();
@@ -72,7 +75,7 @@ public:
              i != inputTileQueues.end(); ++i )
         {
             TileQueue* queue = *i;
-            queue->setAutoObsolete( _latency );
+            queue->setAutoObsolete( window );
         }
         return TRAVERSE_CONTINUE; 
     }
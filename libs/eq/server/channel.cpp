@@ -28,6 +28,7 @@
 #include "log.h"
 #include "node.h"
 #include "segment.h"
+#include "tileQueue.h"
 #include "view.h"
 #include "window.h"
 
@@ -86,6 +87,7 @@ Channel::Channel( Window* parent )
         , _segment( 0 )
         , _state( STATE_STOPPED )
         , _lastDrawCompound( 0 )
+        , _nContexts( 0 )
 {
     const Global* global = Global::instance();
     for( unsigned i = 0; i < IATTR_ALL; ++i )
@@ -102,6 +104,7 @@ Channel::Channel( const Channel& from )
         , _segment( 0 )
         , _state( STATE_STOPPED )
         , _lastDrawCompound( 0 )
+        , _nContexts( 0 )
 {
     // Don't copy view and segment. Will be re-set by segment copy ctor
 }
@@ -119,6 +122,8 @@ void Channel::attach( const UUID& id, const uint32_t instanceID )
                      CmdFunc( this, &Channel::_cmdConfigExitReply ), cmdQ );
     registerCommand( fabric::CMD_CHANNEL_FRAME_FINISH_REPLY,
                      CmdFunc( this, &Channel::_cmdFrameFinishReply ), mainQ );
+    registerCommand( fabric::CMD_CHANNEL_FRAME_TILE_COSTS,
+                     CmdFunc( this, &Channel::_cmdFrameTileCosts ), mainQ );
 }
 
 Channel::~Channel()
@@ -131,6 +136,8 @@ void Channel::postDelete()
     // command invokation after channel deletion
     registerCommand( fabric::CMD_CHANNEL_FRAME_FINISH_REPLY,
                      CmdFunc( this, &Channel::_cmdNop ), 0 );
+    registerCommand( fabric::CMD_CHANNEL_FRAME_TILE_COSTS,
+                     CmdFunc( this, &Channel::_cmdNop ), 0 );
 }
 
 Config* Channel::getConfig()
@@ -297,6 +304,7 @@ void Channel::configInit( const uint128_t& initID, const uint32_t frameNumber )
 {
     LBASSERT( _state == STATE_STOPPED );
     _state = STATE_INITIALIZING;
+    _contexts.clear(); // new render client channel
 
     WindowCreateChannelPacket createChannelPacket( getID( ));
     getWindow()->send( createChannelPacket );
@@ -372,10 +380,15 @@ bool Channel::update( const uint128_t& frameID, const uint32_t frameNumber )
     LBASSERT( isActive( ))
     LBASSERT( getWindow()->isActive( ));
 
+    _nContexts = 0;
+
+    RenderContext context;
+    _setupRenderContext( frameID, context );
+
     ChannelFrameStartPacket startPacket;
     startPacket.frameNumber = frameNumber;
     startPacket.version     = getVersion();
-    _setupRenderContext( frameID, startPacket.context );
+    startPacket.context     = sendContext( context );
 
     send( startPacket );
     LBLOG( LOG_TASKS ) << "TASK channel " << getName() << " start frame  " 
@@ -419,6 +432,36 @@ void Channel::send( co::ObjectPacket& packet )
     getNode()->send( packet );
 }
 
+uint32_t Channel::sendContext( const RenderContext& context )
+{
+    // pre- and post-visit of a compound use the same context
+    for( uint32_t i = _nContexts; i > 0; --i )
+        if( context.getDelta( _contexts[ i - 1 ] ) == 0 )
+            return i - 1;
+
+    const uint32_t index = _nContexts++;
+    if( index >= _contexts.size( ))
+        _contexts.resize( index + 1 );
+
+    RenderContext& previous = _contexts[ index ];
+    const uint32_t fields = context.getDelta( previous );
+    if( fields == 0 )
+        return index;
+
+    ChannelFrameContextPacket packet;
+    packet.index  = index;
+    packet.fields = fields;
+
+    _contextData.clear();
+    context.serializeDelta( fields, _contextData );
+    send< uint8_t >( packet, _contextData );
+    previous = context;
+
+    LBLOG( LOG_TASKS ) << "TASK context " << getName() << " " << &packet
+                       << " " << _contextData.size() << " bytes" << std::endl;
+    return index;
+}
+
 //---------------------------------------------------------------------------
 // Listener interface
 //---------------------------------------------------------------------------
@@ -489,6 +532,32 @@ bool Channel::_cmdFrameFinishReply( co::Command& command )
     return true;
 }
 
+bool Channel::_cmdFrameTileCosts( co::Command& command )
+{
+    const ChannelFrameTileCostsPacket* packet =
+        command.get< ChannelFrameTileCostsPacket >();
+
+    const Compounds& compounds = getCompounds();
+    for( CompoundsCIter i = compounds.begin(); i != compounds.end(); ++i )
+    {
+        const TileQueues& queues = (*i)->getInputTileQueues();
+        for( TileQueuesCIter j = queues.begin(); j != queues.end(); ++j )
+        {
+            for( unsigned k = 0; k < NUM_EYES; ++k )
+            {
+                TileQueue* output = (*j)->getOutputQueue( Eye( 1<<k ));
+                if( output && output->addTileCosts( packet->queueID,
+                                                    packet->nCosts,
+                                                    packet->costs ))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return true; // queue already recycled
+}
+
 bool Channel::omitOutput() const
 {
     // don't print generated channels for now
@@ -170,6 +170,17 @@ namespace server
         void send( co::ObjectPacket& packet );
         template< typename T >
         void send( co::ObjectPacket &packet, const std::vector<T>& data );
+
+        /**
+         * Make a render context available to the task packets of this frame.
+         *
+         * Contexts already sent during this frame are reused. New contexts are
+         * delta-encoded against the context using the same index during the
+         * last frame.
+         *
+         * @return the index of the render context on the render client.
+         */
+        uint32_t sendContext( const RenderContext& context );
         //@}
 
         /** @name Channel listener interface. */
@@ -208,6 +219,15 @@ namespace server
         /** The last draw compound for this entity */
         const Compound* _lastDrawCompound;
 
+        /** The render contexts as known by the render client. */
+        std::vector< RenderContext > _contexts;
+
+        /** The number of render contexts used in the current frame. */
+        uint32_t _nContexts;
+
+        /** Reused buffer for the delta-encoded render context. */
+        std::vector< uint8_t > _contextData;
+
         typedef std::vector< ChannelListener* > ChannelListeners;
         ChannelListeners _listeners;
 
@@ -231,6 +251,7 @@ namespace server
         bool _cmdConfigInitReply( co::Command& command );
         bool _cmdConfigExitReply( co::Command& command );
         bool _cmdFrameFinishReply( co::Command& command );
+        bool _cmdFrameTileCosts( co::Command& command );
         bool _cmdNop( co::Command& command )
             { return true; }
 
@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2007-2011, Stefan Eilemann <eile@equalizergraphics.com>
+/* Copyright (c) 2007-2012, Stefan Eilemann <eile@equalizergraphics.com>
  *                    2010, Cedric Stalder <cedric.stalder@gmail.com>
  *
  * This library is free software; you can redistribute it and/or modify it under
@@ -137,7 +137,6 @@ VisitorResult ChannelUpdateVisitor::visitLeaf( const Compound* compound )
         return TRAVERSE_CONTINUE;
     }
 
-    // OPT: Send render context once before task packets?
     RenderContext context;
     _setupRenderContext( compound, context );
     _updateFrameRate( compound );
@@ -225,7 +224,7 @@ void ChannelUpdateVisitor::_updateDraw( const Compound* compound,
     if( compound->testInheritTask( fabric::TASK_DRAW ))
     {
         ChannelFrameDrawPacket drawPacket;
-        drawPacket.context = context;
+        drawPacket.context = _channel->sendContext( context );
         drawPacket.finish = _channel->hasListeners(); // finish for eq stats
         _channel->send( drawPacket );
         _updated = true;
@@ -262,7 +261,16 @@ void ChannelUpdateVisitor::_updateDrawTiles( const Compound* compound,
 
         ChannelFrameTilesPacket tilesPacket;
         tilesPacket.isLocal = (_channel == destChannel);
-        tilesPacket.context = context;
+        tilesPacket.reportCosts =
+            ( outputQueue->getStrategy() == TileQueue::STRATEGY_COST );
+        tilesPacket.context = _channel->sendContext( context );
+
+        // tile frusta are computed on the client from the untiled frusta
+        const Compound* outputCompound = outputQueue->getCompound();
+        outputCompound->computeTileFrustum( tilesPacket.frustum, context.eye,
+                                            Viewport::FULL, false );
+        outputCompound->computeTileFrustum( tilesPacket.ortho, context.eye,
+                                            Viewport::FULL, true );
         tilesPacket.tasks = compound->getInheritTasks() &
                             ( eq::fabric::TASK_CLEAR | eq::fabric::TASK_DRAW |
                               eq::fabric::TASK_READBACK );
@@ -355,7 +363,7 @@ void ChannelUpdateVisitor::_updateDrawFinish( const Compound* compound ) const
 void ChannelUpdateVisitor::_sendClear( const RenderContext& context )
 {
     ChannelFrameClearPacket clearPacket;
-    clearPacket.context = context;
+    clearPacket.context = _channel->sendContext( context );
     _channel->send( clearPacket );
     _updated = true;
     LBLOG( LOG_TASKS ) << "TASK clear " << _channel->getName() <<  " "
@@ -439,7 +447,7 @@ void ChannelUpdateVisitor::_updateAssemble( const Compound* compound,
 
     // assemble task
     ChannelFrameAssemblePacket packet;
-    packet.context   = context;
+    packet.context   = _channel->sendContext( context );
     packet.nFrames   = uint32_t( frameIDs.size( ));
 
     LBLOG( LOG_ASSEMBLY | LOG_TASKS ) 
@@ -479,7 +487,7 @@ void ChannelUpdateVisitor::_updateReadback( const Compound* compound,
 
     // readback task
     ChannelFrameReadbackPacket packet;
-    packet.context   = context;
+    packet.context   = _channel->sendContext( context );
     packet.nFrames   = uint32_t( frames.size( ));
 
     _channel->send<co::ObjectVersion>( packet, frameIDs );
@@ -498,7 +506,7 @@ void ChannelUpdateVisitor::_updateViewStart( const Compound* compound,
     
     // view start task
     ChannelFrameViewStartPacket packet;
-    packet.context = context;
+    packet.context = _channel->sendContext( context );
 
     LBLOG( LOG_TASKS ) << "TASK view start " << _channel->getName() <<  " "
                            << &packet << std::endl;
@@ -514,7 +522,7 @@ void ChannelUpdateVisitor::_updateViewFinish( const Compound* compound,
     
     // view finish task
     ChannelFrameViewFinishPacket packet;
-    packet.context = context;
+    packet.context = _channel->sendContext( context );
 
     LBLOG( LOG_TASKS ) << "TASK view finish " << _channel->getName() <<  " "
                        << &packet << std::endl;
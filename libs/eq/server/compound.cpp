@@ -1075,14 +1075,15 @@ void Compound::exit()
 void Compound::register_()
 {
     ServerPtr server = getServer();
-    const uint32_t latency = getConfig()->getLatency();
+    // frame data is used by render nodes up to their frame credits behind
+    const uint32_t window = getConfig()->getFrameWindow();
 
     for( Frames::const_iterator i = _outputFrames.begin(); 
          i != _outputFrames.end(); ++i )
     {
         Frame* frame = *i;
         server->registerObject( frame );
-        frame->setAutoObsolete( latency );
+        frame->setAutoObsolete( window );
         LBLOG( eq::LOG_ASSEMBLY ) << "Output frame \"" << frame->getName() 
                                   << "\" id " << frame->getID() << std::endl;
     }
@@ -1092,7 +1093,7 @@ void Compound::register_()
     {
         Frame* frame = *i;
         server->registerObject( frame );
-        frame->setAutoObsolete( latency );
+        frame->setAutoObsolete( window );
         LBLOG( eq::LOG_ASSEMBLY ) << "Input frame \"" << frame->getName() 
                                   << "\" id " << frame->getID() << std::endl;
     }
@@ -1102,7 +1103,7 @@ void Compound::register_()
     {
         TileQueue* queue = *i;
         server->registerObject( queue );
-        queue->setAutoObsolete( latency );
+        queue->setAutoObsolete( window );
         LBLOG( eq::LOG_ASSEMBLY ) << "Input queue \"" << queue->getName() 
                                   << "\" id " << queue->getID() << std::endl;
     }
@@ -1112,7 +1113,7 @@ void Compound::register_()
     {
         TileQueue* queue = *i;
         server->registerObject( queue );
-        queue->setAutoObsolete( latency );
+        queue->setAutoObsolete( window );
         LBLOG( eq::LOG_ASSEMBLY ) << "Output queue \"" << queue->getName() 
                                   << "\" id " << queue->getID() << std::endl;
     }
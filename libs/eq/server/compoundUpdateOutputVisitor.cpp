@@ -24,6 +24,7 @@
 #include "tileQueue.h"
 #include "window.h"
 
+#include "tiles/costStrategy.h"
 #include "tiles/rasterStrategy.h"
 #include "tiles/spiralStrategy.h"
 #include "tiles/squareStrategy.h"
@@ -32,8 +33,6 @@
 #include <eq/client/log.h>
 #include <eq/fabric/iAttribute.h>
 
-#define TILE_STRATEGY ZigzagStrategy
-
 namespace eq
 {
 namespace server
@@ -198,21 +197,26 @@ void CompoundUpdateOutputVisitor::_generateTiles( TileQueue* queue,
     std::vector< Vector2i > tiles;
     tiles.reserve( dim.x() * dim.y() );
 
-    tiles::TILE_STRATEGY strategy;
-    strategy( tiles, dim );
-    _addTilesToQueue( queue, compound, tiles );
-}
-
-void CompoundUpdateOutputVisitor::_addTilesToQueue( TileQueue* queue, 
-                                                    Compound* compound, 
-                                         const std::vector< Vector2i >& tiles )
-{
-
-    const Vector2i& tileSize = queue->getTileSize();
-    PixelViewport pvp = compound->getInheritPixelViewport();
-    const double xFraction = 1.0 / pvp.w;
-    const double yFraction = 1.0 / pvp.h;
+    const TileQueue::Strategy strategy = queue->getStrategy();
+    switch( strategy )
+    {
+        case TileQueue::STRATEGY_RASTER:
+            tiles::RasterStrategy()( tiles, dim );
+            break;
+        case TileQueue::STRATEGY_SPIRAL:
+            tiles::SpiralStrategy()( tiles, dim );
+            break;
+        case TileQueue::STRATEGY_SQUARE:
+            tiles::SquareStrategy()( tiles, dim );
+            break;
+        case TileQueue::STRATEGY_ZIGZAG:
+        case TileQueue::STRATEGY_COST: // fallback order for unknown costs
+            tiles::ZigzagStrategy()( tiles, dim );
+            break;
+    }
 
+    std::vector< PixelViewport > tilePVPs;
+    tilePVPs.reserve( tiles.size( ));
     for( std::vector< Vector2i >::const_iterator i = tiles.begin();
          i != tiles.end(); ++i )
     {
@@ -226,6 +230,30 @@ void CompoundUpdateOutputVisitor::_addTilesToQueue( TileQueue* queue,
         if ( tilePVP.y + tileSize.y() > pvp.h ) // no full tile
             tilePVP.h = pvp.h - tilePVP.y;
 
+        tilePVPs.push_back( tilePVP );
+    }
+
+    if( strategy == TileQueue::STRATEGY_COST )
+    {
+        tiles::CostStrategy costStrategy( queue->getTileCosts( dim ));
+        costStrategy( tilePVPs, dim, tileSize );
+    }
+
+    _addTilesToQueue( queue, compound, tilePVPs );
+}
+
+void CompoundUpdateOutputVisitor::_addTilesToQueue( TileQueue* queue, 
+                                                    Compound* compound, 
+                                    const std::vector< PixelViewport >& tiles )
+{
+    PixelViewport pvp = compound->getInheritPixelViewport();
+    const double xFraction = 1.0 / pvp.w;
+    const double yFraction = 1.0 / pvp.h;
+
+    for( std::vector< PixelViewport >::const_iterator i = tiles.begin();
+         i != tiles.end(); ++i )
+    {
+        const PixelViewport& tilePVP = *i;
         const Viewport tileVP( tilePVP.x * xFraction, tilePVP.y * yFraction,
                                tilePVP.w * xFraction, tilePVP.h * yFraction );
 
@@ -241,10 +269,6 @@ void CompoundUpdateOutputVisitor::_addTilesToQueue( TileQueue* queue,
             TileTaskPacket packet;
             packet.pvp = tilePVP;
             packet.vp = tileVP;
-
-            compound->computeTileFrustum( packet.frustum, eye, packet.vp,
-                                          false );
-            compound->computeTileFrustum( packet.ortho, eye, packet.vp, true );
             queue->addTile( packet, eye );
         }
     }
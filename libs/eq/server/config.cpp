@@ -43,7 +43,9 @@
 #include <eq/fabric/paths.h>
 #include <eq/fabric/serverPackets.h>
 #include <co/command.h>
-#include <lunchbox/sleep.h>
+#include <lunchbox/atomic.h>
+#include <lunchbox/scopedMutex.h>
+#include <lunchbox/thread.h>
 
 #include "channelStopFrameVisitor.h"
 #include "configDeregistrator.h"
@@ -547,41 +549,112 @@ bool Config::_updateRunning()
     return result;
 }
 
+namespace
+{
+typedef std::vector< uint8_t > Results;
+
+/** Connect or launch the next unprocessed nodes until all are done. */
+void _connectNext( const Nodes& nodes, lunchbox::a_int32_t& next,
+                   Results& results )
+{
+    for( int32_t i = ++next - 1; i < int32_t( nodes.size( )); i = ++next - 1 )
+        results[ i ] = nodes[ i ]->connect();
+}
+
+class NodeConnector : public lunchbox::Thread
+{
+public:
+    NodeConnector( const Nodes& nodes, lunchbox::a_int32_t& next,
+                   Results& results )
+            : _nodes( nodes ), _next( next ), _results( results ) {}
+
+    virtual ~NodeConnector() {}
+
+protected:
+    virtual void run() { _connectNext( _nodes, _next, _results ); }
+
+private:
+    const Nodes& _nodes;
+    lunchbox::a_int32_t& _next;
+    Results& _results;
+};
+}
+
 bool Config::_connectNodes()
 {
-    bool success = true;
     lunchbox::Clock clock;
-    const Nodes& nodes = getNodes();
-    for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
+    Nodes nodes;
+    size_t nPending = 0; // not yet connected
+    const Nodes& allNodes = getNodes();
+    for( Nodes::const_iterator i = allNodes.begin(); i != allNodes.end(); ++i )
     {
         Node* node = *i;
         if( !node->isActive( ))
             continue;
+        nodes.push_back( node );
+        if( !node->getNode( ))
+            ++nPending;
+    }
 
-        if( !node->connect( ))
+    // Connecting and launching blocks on connection timeouts and the remote
+    // shell, do it concurrently with up to IATTR_LAUNCH_CONCURRENCY threads.
+    const int32_t concurrency = getIAttribute( IATTR_LAUNCH_CONCURRENCY );
+    size_t nThreads = nPending;
+    if( concurrency >= 0 ) // AUTO: all nodes at once
+        nThreads = LB_MIN( nThreads, size_t( LB_MAX( concurrency, 1 )));
+
+    Results results( nodes.size(), false );
+    lunchbox::a_int32_t next( 0 );
+    std::vector< NodeConnector* > connectors;
+    for( size_t i = 1; i < nThreads; ++i )
+    {
+        NodeConnector* connector = new NodeConnector( nodes, next, results );
+        if( !connector->start( ))
         {
-            setError( node->getError( ));
-            success = false;
+            LBWARN << "Can't start node connector thread" << std::endl;
+            delete connector;
             break;
         }
+        connectors.push_back( connector );
     }
 
-    for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
+    _connectNext( nodes, next, results ); // the calling thread helps out
+    for( std::vector< NodeConnector* >::const_iterator i = connectors.begin();
+         i != connectors.end(); ++i )
     {
-        Node* node = *i;
-        if( node->isActive() && !node->syncLaunch( clock ))
+        NodeConnector* connector = *i;
+        connector->join();
+        delete connector;
+    }
+    const int64_t connectTime = clock.getTime64();
+
+    bool success = true;
+    for( size_t i = 0; i < nodes.size(); ++i )
+    {
+        Node* node = nodes[i];
+        if( !results[i] )
+            node->setError( ERROR_NODE_LAUNCH );
+
+        // all launches are pending, total wait is the slowest launch
+        if( !results[i] || !node->syncLaunch( clock ))
         {
             setError( node->getError( ));
             success = false;
         }
     }
 
+    if( nPending > 0 )
+        LBLOG( LOG_INIT ) << "Connected " << nPending << " nodes using "
+                          << connectors.size() + 1 << " threads in "
+                          << connectTime << " ms, synced launch after "
+                          << clock.getTime64() << " ms" << std::endl;
     return success;
 }
 
 void Config::_startNodes()
 {
     // start up newly running nodes
+    lunchbox::Clock clock;
     std::vector< uint32_t > requests;
     const Nodes& nodes = getNodes();
     for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
@@ -606,6 +679,11 @@ void Config::_startNodes()
     {
         getLocalNode()->waitRequest( *i );
     }
+
+    if( !requests.empty( ))
+        LBLOG( LOG_INIT ) << "Created config on " << requests.size()
+                          << " nodes in " << clock.getTime64() << " ms"
+                          << std::endl;
 }
 
 void Config::_updateCanvases()
@@ -622,6 +700,7 @@ void Config::_updateCanvases()
 void Config::_stopNodes()
 {
     // wait for the nodes to stop, destroy entities, disconnect
+    lunchbox::Clock clock;
     Nodes stoppingNodes;
     const Nodes& nodes = getNodes();
     for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
@@ -655,8 +734,9 @@ void Config::_stopNodes()
         netNode->send( clientExitPacket );
     }
 
-    // now wait that the render clients disconnect
-    uint32_t nSleeps = 50; // max 5 seconds for all clients
+    // now wait that the render clients disconnect, woken up by disconnects
+    ServerPtr server = getServer();
+    const int64_t timeOut = 5000; // max 5 seconds for all clients
     for( Nodes::const_iterator i = stoppingNodes.begin();
          i != stoppingNodes.end(); ++i )
     {
@@ -664,9 +744,14 @@ void Config::_stopNodes()
         co::NodePtr netNode = node->getNode();
         node->setNode( 0 );
 
-        if( nSleeps )
-            while( netNode->isConnected() && --nSleeps )
-                lunchbox::sleep( 100 ); // ms
+        for( uint32_t events = server->getNodeEvents();
+             netNode->isConnected(); events = server->getNodeEvents( ))
+        {
+            const int64_t time = clock.getTime64();
+            if( time >= timeOut )
+                break;
+            server->waitNodeEvents( events + 1, uint32_t( timeOut - time ));
+        }
 
         if( netNode->isConnected( ))
         {
@@ -680,6 +765,11 @@ void Config::_stopNodes()
 
         LBLOG( LOG_INIT ) << "Disconnected node" << std::endl;
     }
+
+    if( !stoppingNodes.empty( ))
+        LBLOG( LOG_INIT ) << "Stopped " << stoppingNodes.size()
+                          << " nodes in " << clock.getTime64() << " ms"
+                          << std::endl;
 }
 
 bool Config::_updateNodes()
@@ -882,7 +972,7 @@ void Config::_verifyFrameFinished( const uint32_t frameNumber )
     {
         Node* node = *i;
         if( node->isRunning() && 
-            node->getFinishedFrame() + getLatency() < frameNumber )
+            node->getFinishedFrame() + node->getFrameCredits() < frameNumber )
         {
             NodeFailedVisitor nodeFailedVisitor;
             node->accept( nodeFailedVisitor );
@@ -892,26 +982,36 @@ void Config::_verifyFrameFinished( const uint32_t frameNumber )
 
 void Config::notifyNodeFrameFinished( const uint32_t frameNumber )
 {
+    // called from the main and the command thread, keep the finish packets in
+    // order for the application
+    lunchbox::ScopedWrite mutex( _finishLock );
     if( _finishedFrame >= frameNumber ) // node finish already done
         return;
 
+    // Nodes with frame credits release frames they still render
+    uint32_t finishedFrame = frameNumber;
     const Nodes& nodes = getNodes();
     for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
     {
         const Node* node = *i;
-        if( node->isRunning() && node->getFinishedFrame() < frameNumber )
+        if( !node->isRunning( ))
+            continue;
+
+        const uint32_t releasedFrame = node->getReleasedFrame();
+        if( releasedFrame <= _finishedFrame )
         {
             LBASSERT( _needsFinish || node->isActive( ));
             return;
         }
+        finishedFrame = LB_MIN( finishedFrame, releasedFrame );
     }
 
-    _finishedFrame = frameNumber;
+    _finishedFrame = finishedFrame;
 
-    // All nodes have finished the frame. Notify the application's config that
-    // the frame is finished
+    // All nodes have finished or released the frame. Notify the application's
+    // config that the frame is finished
     ConfigFrameFinishPacket packet;
-    packet.frameNumber = frameNumber;
+    packet.frameNumber = finishedFrame;
 
     // do not use send/_bufferedTasks, not thread-safe!
     send( findApplicationNetNode(), packet );
@@ -935,6 +1035,16 @@ void Config::_flushAllFrames()
     LBLOG( lunchbox::LOG_ANY ) << "--- Flush All Frames -- " << std::endl;
 }
 
+uint32_t Config::getFrameWindow() const
+{
+    uint32_t credits = 0;
+    const Nodes& nodes = getNodes();
+    for( Nodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i )
+        credits = LB_MAX( credits, (*i)->getFrameCredits( ));
+
+    return getLatency() + credits;
+}
+
 void Config::changeLatency( const uint32_t latency )
 {
     if( getLatency() == latency )
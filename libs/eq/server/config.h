@@ -26,6 +26,7 @@
 #include "visitorResult.h" // enum
 
 #include <eq/fabric/config.h> // base class
+#include <lunchbox/lock.h>    // member
 #include <lunchbox/monitor.h> // member
 
 #include <iostream>
@@ -143,6 +144,14 @@ namespace server
         /** Notify that a node of this config has finished a frame. */
         void notifyNodeFrameFinished( const uint32_t frameNumber );
 
+        /**
+         * @return the number of frames a render node may still use the
+         *         distributed frame data, the latency plus the maximum frame
+         *         credits of all nodes.
+         * @internal
+         */
+        uint32_t getFrameWindow() const;
+
         // Used by Server::releaseConfig() to make sure config is exited
         bool exit();
 
@@ -172,6 +181,9 @@ namespace server
         /** @internal @return the last finished frame */
         uint32_t getFinishedFrame() const { return _finishedFrame.get(); }
 
+        /** @internal @return the last started frame */
+        uint32_t getCurrentFrame() const { return _currentFrame; }
+
         /** @internal */
         virtual VisitorResult _acceptCompounds( ConfigVisitor& visitor );
         /** @internal */
@@ -212,6 +224,9 @@ namespace server
         /** The last finished frame, or 0. */
         lunchbox::Monitor< uint32_t > _finishedFrame;
 
+        /** Orders the frame finish packets of the main and command thread. */
+        lunchbox::Lock _finishLock;
+
         State _state;
 
         bool _needsFinish; //!< true after runtime changes
@@ -123,11 +123,12 @@ void Frame::cycleData( const uint32_t frameNumber, const Compound* compound )
         }
 
         // reuse unused frame data
+        // the auto obsolete count covers the frames in flight on all nodes
         FrameData*     data    = _datas.empty() ? 0 : _datas.back();
-        const uint32_t latency = getAutoObsolete();
+        const uint32_t window  = getAutoObsolete();
         const uint32_t dataAge = data ? data->getFrameNumber() : 0;
 
-        if( data && dataAge < frameNumber-latency && frameNumber > latency )
+        if( data && dataAge < frameNumber-window && frameNumber > window )
             // not used anymore
             _datas.pop_back();
         else // still used - allocate new data
@@ -66,6 +66,7 @@ void Global::_setupDefaults()
 
     _configFAttributes[Config::FATTR_EYE_BASE]         = 0.05f;
     _configIAttributes[Config::IATTR_ROBUSTNESS]       = fabric::AUTO;
+    _configIAttributes[Config::IATTR_LAUNCH_CONCURRENCY] = fabric::AUTO;
 
     // node
     for( uint32_t i=0; i < Node::CATTR_ALL; ++i )
@@ -75,6 +76,7 @@ void Global::_setupDefaults()
 
     _nodeIAttributes[Node::IATTR_LAUNCH_TIMEOUT] = 60000; // ms
     _nodeIAttributes[Node::IATTR_HINT_AFFINITY] = AUTO;
+    _nodeIAttributes[Node::IATTR_FRAME_CREDITS] = AUTO;
     _nodeSAttributes[Node::SATTR_LAUNCH_COMMAND] =
         "ssh -n %h %c --eq-logfile %q%d/%h.%n.log%q";
 #ifdef WIN32
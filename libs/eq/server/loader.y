@@ -113,6 +113,7 @@
 %token EQTOKEN_CONFIG_FATTR_EYE_BASE
 %token EQTOKEN_CONFIG_FATTR_FOCUS_DISTANCE
 %token EQTOKEN_CONFIG_IATTR_ROBUSTNESS
+%token EQTOKEN_CONFIG_IATTR_LAUNCH_CONCURRENCY
 %token EQTOKEN_CONFIG_IATTR_FOCUS_MODE
 %token EQTOKEN_NODE_SATTR_LAUNCH_COMMAND
 %token EQTOKEN_NODE_CATTR_LAUNCH_COMMAND_QUOTE
@@ -120,6 +121,7 @@
 %token EQTOKEN_NODE_IATTR_HINT_AFFINITY
 %token EQTOKEN_NODE_IATTR_HINT_STATISTICS
 %token EQTOKEN_NODE_IATTR_LAUNCH_TIMEOUT
+%token EQTOKEN_NODE_IATTR_FRAME_CREDITS
 %token EQTOKEN_PIPE_IATTR_HINT_CUDA_GL_INTEROP
 %token EQTOKEN_PIPE_IATTR_HINT_THREAD
 %token EQTOKEN_PIPE_IATTR_HINT_AFFINITY
@@ -219,6 +221,7 @@
 %token EQTOKEN_LAUNCH_COMMAND
 %token EQTOKEN_LAUNCH_COMMAND_QUOTE
 %token EQTOKEN_LAUNCH_TIMEOUT
+%token EQTOKEN_FRAME_CREDITS
 %token EQTOKEN_PORT
 %token EQTOKEN_FILENAME
 %token EQTOKEN_TASK
@@ -227,6 +230,7 @@
 %token EQTOKEN_FOCUS_DISTANCE
 %token EQTOKEN_FOCUS_MODE
 %token EQTOKEN_ROBUSTNESS
+%token EQTOKEN_LAUNCH_CONCURRENCY
 %token EQTOKEN_THREAD_MODEL
 %token EQTOKEN_ASYNC
 %token EQTOKEN_DRAW_SYNC
@@ -292,6 +296,12 @@
 %token EQTOKEN_INTEGER
 %token EQTOKEN_UNSIGNED
 %token EQTOKEN_SIZE
+%token EQTOKEN_STRATEGY
+%token EQTOKEN_RASTER
+%token EQTOKEN_SPIRAL
+%token EQTOKEN_SQUARE
+%token EQTOKEN_ZIGZAG
+%token EQTOKEN_COST
 %token EQTOKEN_CORE
 %token EQTOKEN_SOCKET
 
@@ -369,6 +379,11 @@ global:
          eq::server::Global::instance()->setConfigIAttribute(
              eq::server::Config::IATTR_ROBUSTNESS, $2 );
      }
+     | EQTOKEN_CONFIG_IATTR_LAUNCH_CONCURRENCY IATTR
+     {
+         eq::server::Global::instance()->setConfigIAttribute(
+             eq::server::Config::IATTR_LAUNCH_CONCURRENCY, $2 );
+     }
      | EQTOKEN_NODE_SATTR_LAUNCH_COMMAND STRING
      {
          eq::server::Global::instance()->setNodeSAttribute(
@@ -394,6 +409,11 @@ global:
          eq::server::Global::instance()->setNodeIAttribute(
              eq::server::Node::IATTR_LAUNCH_TIMEOUT, $2 );
      }
+     | EQTOKEN_NODE_IATTR_FRAME_CREDITS IATTR
+     {
+         eq::server::Global::instance()->setNodeIAttribute(
+             eq::server::Node::IATTR_FRAME_CREDITS, $2 );
+     }
      | EQTOKEN_NODE_IATTR_HINT_STATISTICS IATTR
      {
          LBWARN << "Ignoring deprecated attribute Node::IATTR_HINT_STATISTICS"
@@ -572,6 +592,8 @@ configAttribute:
                              eq::server::Config::FATTR_EYE_BASE, $2 ); }
     | EQTOKEN_ROBUSTNESS IATTR { config->setIAttribute( 
                                  eq::server::Config::IATTR_ROBUSTNESS, $2 ); }
+    | EQTOKEN_LAUNCH_CONCURRENCY IATTR { config->setIAttribute(
+                         eq::server::Config::IATTR_LAUNCH_CONCURRENCY, $2 ); }
 
 node: appNode | renderNode
 renderNode: EQTOKEN_NODE '{' {
@@ -621,6 +643,8 @@ nodeAttribute:
         { node->setIAttribute( eq::server::Node::IATTR_THREAD_MODEL, $2 ); }
     | EQTOKEN_LAUNCH_TIMEOUT IATTR 
         { node->setIAttribute( eq::server::Node::IATTR_LAUNCH_TIMEOUT, $2 ); }
+    | EQTOKEN_FRAME_CREDITS IATTR
+        { node->setIAttribute( eq::server::Node::IATTR_FRAME_CREDITS, $2 ); }
     | EQTOKEN_HINT_STATISTICS IATTR
         {
             LBWARN
@@ -1285,6 +1309,19 @@ tileQueueField:
     EQTOKEN_NAME STRING { tileQueue->setName( $2 ); }
     | EQTOKEN_SIZE '[' UNSIGNED UNSIGNED ']' 
         { tileQueue->setTileSize( eq::Vector2i( $3, $4 )); }
+    | EQTOKEN_STRATEGY tileQueueStrategy
+
+tileQueueStrategy:
+    EQTOKEN_RASTER
+        { tileQueue->setStrategy( eq::server::TileQueue::STRATEGY_RASTER ); }
+    | EQTOKEN_SPIRAL
+        { tileQueue->setStrategy( eq::server::TileQueue::STRATEGY_SPIRAL ); }
+    | EQTOKEN_SQUARE
+        { tileQueue->setStrategy( eq::server::TileQueue::STRATEGY_SQUARE ); }
+    | EQTOKEN_ZIGZAG
+        { tileQueue->setStrategy( eq::server::TileQueue::STRATEGY_ZIGZAG ); }
+    | EQTOKEN_COST
+        { tileQueue->setStrategy( eq::server::TileQueue::STRATEGY_COST ); }
 
 compoundAttributes: /*null*/ | compoundAttributes compoundAttribute
 compoundAttribute:
@@ -27,6 +27,7 @@
 #include "server.h"
 #include "window.h"
 
+#include <eq/client/configEvent.h>
 #include <eq/client/configPackets.h>
 #include <eq/client/error.h>
 #include <eq/client/nodePackets.h>
@@ -38,7 +39,10 @@
 #include <lunchbox/clock.h>
 #include <lunchbox/launcher.h>
 #include <lunchbox/os.h>
-#include <lunchbox/sleep.h>
+
+#ifdef _MSC_VER
+#  define snprintf _snprintf
+#endif
 
 namespace eq
 {
@@ -62,6 +66,8 @@ Node::Node( Config* parent )
     , _active( 0 )
     , _finishedFrame( 0 )
     , _flushedFrame( 0 )
+    , _throttledFrame( 0 )
+    , _throttleTime( 0 )
     , _state( STATE_STOPPED )
     , _lastDrawPipe( 0 )
 {
@@ -259,7 +265,6 @@ bool Node::launch()
             return true;
     }
 
-    setError( ERROR_NODE_LAUNCH );
     return false;
 }
 
@@ -274,23 +279,27 @@ bool Node::syncLaunch( const lunchbox::Clock& clock )
         return true;
 
     LBASSERT( !isApplicationNode( ));
-    co::LocalNodePtr localNode = getLocalNode();
-    LBASSERT( localNode.isValid( ));
+    ServerPtr server = getServer();
+    LBASSERT( server.isValid( ));
 
-    const int32_t timeOut = getIAttribute( IATTR_LAUNCH_TIMEOUT );
+    const int64_t timeOut = getIAttribute( IATTR_LAUNCH_TIMEOUT );
 
     while( true )
     {
-        co::NodePtr node = localNode->getNode( _node->getNodeID( ));
+        const uint32_t events = server->getNodeEvents();
+        co::NodePtr node = server->getNode( _node->getNodeID( ));
         if( node.isValid() && node->isConnected( ))
         {
             LBASSERT( _node->getRefCount() == 1 );
             _node = node; // Use co::Node already connected
             return true;
         }
-        
-        lunchbox::sleep( 100 /*ms*/ );
-        if( clock.getTime64() > timeOut )
+
+        // woken up by any node connect, re-check ours
+        const int64_t time = clock.getTime64();
+        if( time < timeOut )
+            server->waitNodeEvents( events + 1, uint32_t( timeOut - time ));
+        else
         {
             LBASSERT( _node->getRefCount() == 1 );
             _node = 0;
@@ -455,6 +464,7 @@ void Node::configInit( const uint128_t& initID, const uint32_t frameNumber )
     const Config* config = getConfig();
     _flushedFrame  = config->getFinishedFrame();
     _finishedFrame = config->getFinishedFrame();
+    _throttledFrame = 0;
     _frameIDs.clear();
 
     LBLOG( LOG_INIT ) << "Create node" << std::endl;
@@ -568,6 +578,7 @@ void Node::update( const uint128_t& frameID, const uint32_t frameNumber )
 
     _finish( frameNumber );
     flushSendBuffer();
+    _updateThrottle( frameNumber );
 }
 
 uint32_t Node::_getFinishLatency() const
@@ -622,6 +633,72 @@ void Node::_finish( const uint32_t currentFrame )
     flushFrames( currentFrame );
 }
 
+uint32_t Node::getFrameCredits() const
+{
+    const uint32_t latency = getConfig()->getLatency();
+    const int32_t credits = getIAttribute( IATTR_FRAME_CREDITS );
+
+    if( isApplicationNode() || credits <= int32_t( latency ))
+        return latency;
+    return credits;
+}
+
+uint32_t Node::getReleasedFrame() const
+{
+    const Config* config = getConfig();
+    const uint32_t latency = config->getLatency();
+    const uint32_t credits = getFrameCredits();
+    const uint32_t finishedFrame = _finishedFrame;
+    // Called from the command thread, a stale current frame only releases less
+    const uint32_t currentFrame = config->getCurrentFrame();
+
+    if( credits == latency || finishedFrame >= currentFrame )
+        return finishedFrame;
+
+    // never release the current frame, finishAllFrames waits for the nodes
+    return LB_MIN( finishedFrame + credits - latency, currentFrame - 1 );
+}
+
+void Node::_updateThrottle( const uint32_t currentFrame )
+{
+    if( isApplicationNode( )) // see Statistic::CONFIG_WAIT_FINISH_FRAME
+        return;
+
+    Config* config = getConfig();
+    const int64_t time = getServer()->getTime();
+
+    if( _throttledFrame > 0 )
+    {
+        ConfigEvent event;
+        event.data.type                  = Event::STATISTIC;
+        event.data.serial                = getSerial();
+        event.data.originator            = getID();
+        event.data.statistic.type        = Statistic::NODE_FRAME_CREDITS;
+        event.data.statistic.frameNumber = _throttledFrame;
+        event.data.statistic.startTime   = _throttleTime;
+        event.data.statistic.endTime     = time;
+        snprintf( event.data.statistic.resourceName, 32, "%s",
+                  getName().c_str( ));
+        event.data.statistic.resourceName[31] = 0;
+
+        config->send( config->findApplicationNetNode(), event );
+        _throttledFrame = 0;
+    }
+
+    // The application will wait for frame currentFrame - latency, which is
+    // released by this node only within its frame credits.
+    const uint32_t latency = config->getLatency();
+    if( currentFrame > latency &&
+        getReleasedFrame() < currentFrame - latency )
+    {
+        LBLOG( LOG_TASKS ) << "Node " << getName() << " out of credits, "
+                           << currentFrame - _finishedFrame
+                           << " frames in flight" << std::endl;
+        _throttledFrame = currentFrame;
+        _throttleTime = time;
+    }
+}
+
 void Node::flushFrames( const uint32_t frameNumber )
 {
     LBLOG( LOG_TASKS ) << "Flush frames including " << frameNumber << std::endl;
@@ -709,6 +786,8 @@ bool Node::removeConnectionDescription( co::ConnectionDescriptionPtr cd )
 
 void Node::flushSendBuffer()
 {
+    LBLOG( LOG_TASKS ) << "Flush " << _bufferedTasks.getSize()
+                       << " bytes of tasks to " << getName() << std::endl;
     _bufferedTasks.sendBuffer( _node->getConnection( ));
 }
 
@@ -744,7 +823,7 @@ bool Node::_cmdFrameFinishReply( co::Command& command )
     LBVERB << "handle frame finish reply " << packet << std::endl;
     
     _finishedFrame = packet->frameNumber;
-    getConfig()->notifyNodeFrameFinished( packet->frameNumber );
+    getConfig()->notifyNodeFrameFinished( getReleasedFrame( ));
 
     return true;
 }
@@ -822,6 +901,7 @@ void Node::output( std::ostream& os ) const
         os << ( i== Node::IATTR_LAUNCH_TIMEOUT ? "launch_timeout       " :
                 i== Node::IATTR_THREAD_MODEL   ? "thread_model         " :
                 i== Node::IATTR_HINT_AFFINITY  ? "hint_affinity        " :
+                i== Node::IATTR_FRAME_CREDITS  ? "frame_credits        " :
                 "ERROR" )
            << static_cast< fabric::IAttribute >( value ) << std::endl;
     }
@@ -95,16 +95,38 @@ namespace server
 
         /** @return the number of the last finished frame. @internal */
         uint32_t getFinishedFrame() const { return _finishedFrame; }
+
+        /**
+         * @return the maximum number of frames in flight on this node.
+         *
+         * Nodes with more frame credits than the config latency do not hold
+         * back the application until they lag more than their credits
+         * behind. The application node always uses the config latency.
+         * @internal
+         */
+        uint32_t getFrameCredits() const;
+
+        /**
+         * @return the last frame the application does not have to wait for
+         *         on this node. @internal
+         */
+        uint32_t getReleasedFrame() const;
         //@}
 
         /**
          * @name Operations
          */
         //@{
-        /** Connect the render slave node process. */
+        /**
+         * Connect the render slave node process.
+         *
+         * May be called concurrently for different nodes. Does not set the
+         * error on failure, since this would modify the config from
+         * multiple threads.
+         */
         bool connect();
 
-        /** Launch the render slave node process. */
+        /** Launch the render slave node process, see connect(). */
         bool launch();
 
         /** Synchronize the connection of a render slave launch. */
@@ -271,6 +293,12 @@ namespace server
         /** The number of the last flushed frame (frame finish packet sent). */
         uint32_t _flushedFrame;
 
+        /** The frame during which this node throttled the application. */
+        uint32_t _throttledFrame;
+
+        /** The start time of the throttling. */
+        int64_t _throttleTime;
+
         /** The current state for state change synchronization. */
         lunchbox::Monitor< State > _state;
             
@@ -299,6 +327,9 @@ namespace server
         uint32_t _getFinishLatency() const;
         void _finish( const uint32_t currentFrame );
 
+        /** Report and detect the throttling of the application. */
+        void _updateThrottle( const uint32_t currentFrame );
+
         /** flush cached barriers. */
         void _flushBarriers();
 
@@ -63,6 +63,7 @@ typedef fabric::Server< co::Node, Server, Config, NodeFactory, co::LocalNode,
 
 Server::Server()
         : Super( &_nf )
+        , _nodeEvents( 0 )
         , _running( false )
 {
     lunchbox::Log::setClock( &_clock );
@@ -152,6 +153,16 @@ bool Server::dispatchCommand( co::Command& command )
     }
 }
 
+void Server::notifyConnect( co::NodePtr node )
+{
+    ++_nodeEvents;
+}
+
+void Server::notifyDisconnect( co::NodePtr node )
+{
+    ++_nodeEvents;
+}
+
 
 void Server::handleCommands()
 {
@@ -26,6 +26,7 @@
 #include <co/command.h>      // used in inline method
 #include <co/commandQueue.h> // member
 #include <lunchbox/clock.h>   // member
+#include <lunchbox/monitor.h> // member
 
 namespace eq
 {
@@ -73,11 +74,30 @@ namespace server
         /** @return the global time in milliseconds. */
         int64_t getTime() const { return _clock.getTime64(); }
 
+        /** @return the number of node connections and disconnections. */
+        uint32_t getNodeEvents() const { return _nodeEvents.get(); }
+
+        /**
+         * Wait for node connections or disconnections.
+         *
+         * @param events the event count to wait for, see getNodeEvents().
+         * @param timeout the maximum time to wait in milliseconds.
+         * @return true if the event count was reached, false on timeout.
+         */
+        bool waitNodeEvents( const uint32_t events, const uint32_t timeout )
+            { return _nodeEvents.timedWaitGE( events, timeout ); }
+
     protected:
         virtual ~Server();
 
         /** @sa co::Node::dispatchCommand */
         virtual bool dispatchCommand( co::Command& command );
+
+        /** @sa co::LocalNode::notifyConnect */
+        virtual void notifyConnect( co::NodePtr node );
+
+        /** @sa co::LocalNode::notifyDisconnect */
+        virtual void notifyDisconnect( co::NodePtr node );
         
     private:
         /** The receiver->main command queue. */
@@ -88,6 +108,9 @@ namespace server
 
         co::Nodes _admins; //!< connected admin clients
 
+        /** Counts node connects and disconnects to wake up launch/exit. */
+        lunchbox::Monitor< uint32_t > _nodeEvents;
+
         /** The current state. */
         bool _running;
 
@@ -31,9 +31,15 @@ TileQueue::TileQueue()
         , _compound( 0 )
         , _name()
         , _size( 0, 0 )
+        , _strategy( STRATEGY_ZIGZAG )
+        , _grid( 0, 0 )
+        , _costFrame( 0 )
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
+    {
         _queueMaster[i] = 0;
+        _outputQueue[i] = 0;
+    }
 }
 
 TileQueue::TileQueue( const TileQueue& from )
@@ -41,9 +47,15 @@ TileQueue::TileQueue( const TileQueue& from )
         , _compound( 0 )
         , _name( from._name )
         , _size( from._size )
+        , _strategy( from._strategy )
+        , _grid( 0, 0 )
+        , _costFrame( 0 )
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
+    {
         _queueMaster[i] = 0;
+        _outputQueue[i] = 0;
+    }
 }
 
 TileQueue::~TileQueue()
@@ -58,6 +70,59 @@ void TileQueue::addTile( const TileTaskPacket& tile, const fabric::Eye eye )
     _queueMaster[index]->_queue.push( tile );
 }
 
+bool TileQueue::addTileCosts( const UUID& queueID, const uint32_t nCosts,
+                              const TileCost* costs )
+{
+    const LatencyQueue* queue = 0;
+    for( std::deque< LatencyQueue* >::const_iterator i = _queues.begin();
+         i != _queues.end() && !queue; ++i )
+    {
+        if( (*i)->_queue.getID() == queueID )
+            queue = *i;
+    }
+    if( !queue )
+        return false;
+
+    const uint32_t frameNumber = queue->_frameNumber;
+    const size_t nTiles = _grid.x() * _grid.y();
+    if( frameNumber < _costFrame || nTiles == 0 ||
+        _size.x() <= 0 || _size.y() <= 0 )
+    {
+        return true; // outdated
+    }
+
+    if( frameNumber > _costFrame )
+    {
+        if( _costFrame > 0 )
+            _costs.swap( _nextCosts );
+        _nextCosts.assign( nTiles, 0.f );
+        _costFrame = frameNumber;
+    }
+
+    // Split tiles are accounted to their originating grid tile
+    for( uint32_t i = 0; i < nCosts; ++i )
+    {
+        const PixelViewport& pvp = costs[i].pvp;
+        const int32_t x = pvp.x / _size.x();
+        const int32_t y = pvp.y / _size.y();
+        if( x < _grid.x() && y < _grid.y( ))
+            _nextCosts[ y * _grid.x() + x ] += costs[i].time;
+    }
+    return true;
+}
+
+const std::vector< float >& TileQueue::getTileCosts( const Vector2i& grid )
+{
+    if( grid != _grid )
+    {
+        _grid = grid;
+        _costs.clear();
+        _nextCosts.clear();
+        _costFrame = 0;
+    }
+    return _costs;
+}
+
 void TileQueue::cycleData( const uint32_t frameNumber, const Compound* compound)
 {
     for( unsigned i = 0; i < NUM_EYES; ++i )
@@ -157,9 +222,23 @@ std::ostream& operator << ( std::ostream& os, const TileQueue* tileQueue )
     if( size != Vector2i::ZERO )
         os << "size      " << size << std::endl;
 
+    const TileQueue::Strategy strategy = tileQueue->getStrategy();
+    if( strategy != TileQueue::STRATEGY_ZIGZAG )
+        os << "strategy  " << strategy << std::endl;
+
     os << lunchbox::exdent << "}" << std::endl << lunchbox::enableFlush;
     return os;
 }
 
+std::ostream& operator << ( std::ostream& os,
+                            const TileQueue::Strategy strategy )
+{
+    os << ( strategy == TileQueue::STRATEGY_RASTER ? "RASTER" :
+            strategy == TileQueue::STRATEGY_SPIRAL ? "SPIRAL" :
+            strategy == TileQueue::STRATEGY_SQUARE ? "SQUARE" :
+            strategy == TileQueue::STRATEGY_COST   ? "COST" : "ZIGZAG" );
+    return os;
+}
+
 }
 }
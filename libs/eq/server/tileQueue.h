@@ -33,6 +33,20 @@ namespace server
     class TileQueue : public co::Object
     {
     public:
+        /** The order in which tiles are generated. */
+        enum Strategy
+        {
+            STRATEGY_RASTER,
+            STRATEGY_SPIRAL,
+            STRATEGY_SQUARE,
+            STRATEGY_ZIGZAG,
+            /**
+             * Most expensive tiles of the last frame first, splitting tiles
+             * which are significantly more expensive than the average.
+             */
+            STRATEGY_COST
+        };
+
         /** 
          * Constructs a new TileQueue.
          */
@@ -60,6 +74,32 @@ namespace server
         /** @return the tile size. */
         const Vector2i& getTileSize() const { return _size; }
 
+        /** Set the tile generation strategy. */
+        void setStrategy( const Strategy strategy ) { _strategy = strategy; }
+
+        /** @return the tile generation strategy. */
+        Strategy getStrategy() const { return _strategy; }
+
+        /**
+         * Add the measured tile render times from a queue master.
+         *
+         * Costs are accumulated per tile of the given grid for the frame of
+         * the queue master. Costs of outdated or unknown queues are ignored.
+         *
+         * @param queueID the identifier of the queue master.
+         * @param nCosts the number of tile costs.
+         * @param costs the tile costs.
+         * @return true if the queue master belongs to this tile queue.
+         */
+        bool addTileCosts( const UUID& queueID, const uint32_t nCosts,
+                           const TileCost* costs );
+
+        /**
+         * @return the per-tile costs of the last completely reported frame,
+         *         or an empty vector if none are known for the grid.
+         */
+        const std::vector< float >& getTileCosts( const Vector2i& grid );
+
         /** Add a tile to the queue. */
         void addTile( const TileTaskPacket& tile, const Eye eye );
 
@@ -76,6 +116,8 @@ namespace server
         void setOutputQueue( TileQueue* queue, const Compound* compound );
         const TileQueue* getOutputQueue( const Eye eye ) const
             { return _outputQueue[ lunchbox::getIndexOfLastBit( eye ) ]; }
+        TileQueue* getOutputQueue( const Eye eye )
+            { return _outputQueue[ lunchbox::getIndexOfLastBit( eye ) ]; }
 
         /**
          * @name Operations
@@ -113,6 +155,21 @@ namespace server
         /** The size of each tile in the queue. */
         Vector2i _size;
 
+        /** The tile generation strategy. */
+        Strategy _strategy;
+
+        /** The tile grid of the cost data. */
+        Vector2i _grid;
+
+        /** The tile costs of the last frame used for tile generation. */
+        std::vector< float > _costs;
+
+        /** The tile costs of the frame currently being reported. */
+        std::vector< float > _nextCosts;
+
+        /** The frame number of _nextCosts. */
+        uint32_t _costFrame;
+
         /** The collage queue pool. */
         std::deque< LatencyQueue* > _queues;
 
@@ -124,6 +181,7 @@ namespace server
     };
 
     std::ostream& operator << ( std::ostream& os, const TileQueue* frame );
+    std::ostream& operator << ( std::ostream& os, const TileQueue::Strategy );
 }
 }
 #endif // EQSERVER_TILEQUEUE_H
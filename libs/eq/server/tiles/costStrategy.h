@@ -0,0 +1,137 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef EQSERVER_TILES_COSTSTRATEGY_H
+#define EQSERVER_TILES_COSTSTRATEGY_H
+
+#include "../types.h"
+
+#include <algorithm>
+
+namespace eq
+{
+namespace server
+{
+namespace tiles
+{
+    /**
+     * Orders tiles by decreasing cost of the last frame.
+     *
+     * Tiles more expensive than SPLIT_FACTOR times the average tile are split
+     * into four quadrants, as long as the quadrants are not smaller than
+     * MIN_SIZE pixels. Since the decision is re-evaluated each frame on the
+     * accumulated cost of the grid tile, split tiles are merged again once
+     * their cost drops. Tiles of unknown cost are assumed to be average.
+     */
+    class CostStrategy
+    {
+    public:
+        enum
+        {
+            SPLIT_FACTOR = 2,
+            MIN_SIZE = 16
+        };
+
+        /** @param costs the per-tile costs of the last frame, or empty. */
+        explicit CostStrategy( const std::vector< float >& costs )
+            : _costs( costs ) {}
+
+        /**
+         * Reorder and split the given tiles.
+         *
+         * @param tiles the tiles of the grid, in raster coordinates.
+         * @param dim the dimensions of the tile grid.
+         * @param tileSize the size of a grid tile.
+         */
+        void operator()( std::vector< PixelViewport >& tiles,
+                         const Vector2i& dim, const Vector2i& tileSize )
+        {
+            const size_t nTiles = dim.x() * dim.y();
+            if( _costs.size() != nTiles || nTiles == 0 )
+                return;
+
+            float sum = 0.f;
+            size_t nKnown = 0;
+            for( size_t i = 0; i < nTiles; ++i )
+            {
+                if( _costs[i] <= 0.f )
+                    continue;
+                sum += _costs[i];
+                ++nKnown;
+            }
+            if( nKnown == 0 )
+                return;
+
+            const float average = sum / float( nKnown );
+            std::vector< Tile > costTiles;
+            costTiles.reserve( tiles.size( ));
+
+            for( std::vector< PixelViewport >::const_iterator i =tiles.begin();
+                 i != tiles.end(); ++i )
+            {
+                const PixelViewport& pvp = *i;
+                const size_t index = pvp.y / tileSize.y() * dim.x() +
+                                     pvp.x / tileSize.x();
+                const float cost = _costs[ index ] > 0.f ? _costs[ index ] :
+                                                           average;
+
+                if( cost > average * SPLIT_FACTOR &&
+                    pvp.w >= 2 * MIN_SIZE && pvp.h >= 2 * MIN_SIZE )
+                {
+                    const int32_t w = pvp.w / 2;
+                    const int32_t h = pvp.h / 2;
+                    const float quarter = cost * .25f;
+
+                    costTiles.push_back(
+                        Tile( PixelViewport( pvp.x, pvp.y, w, h ), quarter ));
+                    costTiles.push_back(
+                        Tile( PixelViewport( pvp.x + w, pvp.y, pvp.w - w, h ),
+                              quarter ));
+                    costTiles.push_back(
+                        Tile( PixelViewport( pvp.x, pvp.y + h, w, pvp.h - h ),
+                              quarter ));
+                    costTiles.push_back(
+                        Tile( PixelViewport( pvp.x + w, pvp.y + h, pvp.w - w,
+                                             pvp.h - h ), quarter ));
+                }
+                else
+                    costTiles.push_back( Tile( pvp, cost ));
+            }
+
+            std::stable_sort( costTiles.begin(), costTiles.end(),
+                              _moreExpensive );
+
+            tiles.clear();
+            for( std::vector< Tile >::const_iterator i = costTiles.begin();
+                 i != costTiles.end(); ++i )
+            {
+                tiles.push_back( i->first );
+            }
+        }
+
+    private:
+        typedef std::pair< PixelViewport, float > Tile;
+        const std::vector< float >& _costs;
+
+        static bool _moreExpensive( const Tile& a, const Tile& b )
+            { return a.second > b.second; }
+    };
+}
+}
+}
+
+#endif // EQSERVER_TILES_COSTSTRATEGY_H
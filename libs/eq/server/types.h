@@ -104,6 +104,7 @@ using fabric::Matrix4f;
 using fabric::PixelViewport;
 using fabric::Projection;
 using fabric::RenderContext;
+using fabric::TileCost;
 using fabric::TileTaskPacket;
 using fabric::SwapBarrier;
 using fabric::SwapBarrierPtr;
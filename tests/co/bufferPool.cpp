@@ -0,0 +1,113 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Commits a medium-sized object many times and reports the commit time and
+// the number of buffer allocations with and without the buffer pool.
+
+#include <test.h>
+
+#include <co/bufferPool.h>
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/global.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+
+#include <iostream>
+
+#define SIZE     LB_1MB
+#define NCOMMITS 10000
+
+namespace
+{
+class Object : public co::Object
+{
+public:
+    Object() : data( SIZE ) {}
+
+    std::vector< uint8_t > data;
+
+protected:
+    virtual ChangeType getChangeType() const { return INSTANCE; }
+    virtual void getInstanceData( co::DataOStream& os ) { os << data; }
+    virtual void applyInstanceData( co::DataIStream& is ) { is >> data; }
+};
+
+float _commit( co::LocalNodePtr node, const int32_t poolSize,
+               uint64_t& nAllocations )
+{
+    co::BufferPool::clear();
+    co::Global::setIAttribute( co::Global::IATTR_OBJECT_BUFFER_POOL_SIZE,
+                               poolSize );
+    const uint64_t misses = co::BufferPool::getStatistics().misses;
+
+    Object object;
+    TEST( node->registerObject( &object ));
+
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < NCOMMITS; ++i )
+    {
+        object.data[ i % SIZE ] = uint8_t( i );
+        object.commit();
+    }
+    const float time = clock.getTimef();
+
+    TESTINFO( object.getVersion() == NCOMMITS + 1, object.getVersion( ));
+    node->deregisterObject( &object );
+
+    nAllocations = co::BufferPool::getStatistics().misses - misses;
+    return time;
+}
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    lunchbox::RNG rng;
+    co::LocalNodePtr node = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = (rng.get<uint16_t>() % 60000) + 1024;
+    connDesc->setHostname( "localhost" );
+    node->addConnectionDescription( connDesc );
+    TEST( node->listen( ));
+
+    uint64_t unpooled = 0;
+    uint64_t pooled = 0;
+    const float unpooledTime = _commit( node, 0, unpooled );
+    const float pooledTime = _commit( node, 64, pooled );
+
+    std::cout << NCOMMITS << " commits of " << SIZE / LB_1MB << " MB took "
+              << unpooledTime << " ms with " << unpooled << " allocations, "
+              << pooledTime << " ms with " << pooled << " pooled allocations"
+              << std::endl << co::BufferPool::getStatistics() << std::endl;
+
+    TESTINFO( unpooled >= NCOMMITS, unpooled );
+    TESTINFO( pooled < 10, pooled );
+
+    TEST( node->close( ));
+    TESTINFO( node->getRefCount() == 1, node->getRefCount( ));
+    node = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests DataIStream views and reports the time to deserialize a large float
+// array with and without copying.
+
+#include <test.h>
+
+#include <co/command.h>
+#include <co/commandCache.h>
+#include <co/dataIStream.h>
+#include <co/init.h>
+#include <co/packets.h>
+#include <co/plugins/compressor.h>
+#include <lunchbox/clock.h>
+
+#include <iostream>
+
+#define NFLOATS ( LB_100MB / sizeof( float ))
+#define NLOOPS  10
+
+namespace
+{
+struct DataPacket : public co::Packet
+{
+    uint64_t dataSize;
+    uint32_t compressorName;
+    uint32_t nChunks;
+    LB_ALIGN8( uint64_t last ); // pad and align to multiple-of-eight
+    LB_ALIGN8( uint8_t data[8] );
+};
+
+class DataIStream : public co::DataIStream
+{
+public:
+    DataIStream( co::Command& command ) : _command( command ), _read( false ) {}
+
+    virtual size_t nRemainingBuffers() const { return _read ? 0 : 1; }
+    virtual lunchbox::uint128_t getVersion() const { return co::VERSION_NONE;}
+    virtual co::NodePtr getMaster() { return 0; }
+    virtual void reset() { co::DataIStream::reset(); _read = false; }
+
+protected:
+    virtual bool getNextBuffer( uint32_t* compressor, uint32_t* nChunks,
+                                const void** chunkData, uint64_t* size )
+        {
+            if( _read )
+                return false;
+
+            const DataPacket* packet = _command.get< DataPacket >();
+            *compressor = packet->compressorName;
+            *nChunks = packet->nChunks;
+            *size = packet->dataSize;
+            *chunkData = packet->data;
+            _read = true;
+            return true;
+        }
+
+    virtual co::Command* getCurrentCommand() { return &_command; }
+
+private:
+    co::Command& _command;
+    bool _read;
+};
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    // serialized std::vector< float >: element count followed by the items
+    const uint64_t dataSize = sizeof( uint64_t ) + NFLOATS * sizeof( float );
+    co::CommandCache commandCache;
+    co::Command& command = commandCache.alloc( 0, 0, sizeof( DataPacket ) - 8 +
+                                                     dataSize );
+    command.retain();
+
+    DataPacket* packet = command.getModifiable< DataPacket >();
+    packet->command = 2;
+    packet->dataSize = dataSize;
+    packet->compressorName = EQ_COMPRESSOR_NONE;
+    packet->nChunks = 1;
+    packet->last = true;
+
+    *reinterpret_cast< uint64_t* >( packet->data ) = NFLOATS;
+    float* floats = reinterpret_cast< float* >( packet->data + 8 );
+    for( size_t i = 0; i < NFLOATS; ++i )
+        floats[ i ] = float( i );
+
+    DataIStream stream( command );
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < NLOOPS; ++i )
+    {
+        std::vector< float > values;
+        stream >> values;
+        TEST( values.size() == NFLOATS );
+        TEST( values.back() == float( NFLOATS - 1 ));
+        stream.reset();
+    }
+    const float copyTime = clock.getTimef() / NLOOPS;
+
+    clock.reset();
+    for( size_t i = 0; i < NLOOPS; ++i )
+    {
+        co::DataIStream::View< float > view;
+        stream >> view;
+        TEST( view.getSize() == NFLOATS );
+        TEST( view.getData() == floats );
+        TEST( view[ NFLOATS - 1 ] == float( NFLOATS - 1 ));
+        stream.reset();
+    }
+    const float viewTime = clock.getTimef() / NLOOPS;
+
+    std::cout << "Deserialized " << ( NFLOATS * sizeof( float )) / LB_1MB
+              << " MB of floats in " << copyTime << " ms with copying, "
+              << viewTime << " ms without" << std::endl;
+
+    // the view retains the command beyond the lifetime of the stream read
+    co::DataIStream::View< float > view;
+    stream >> view;
+    stream.reset();
+    command.release();
+    TEST( !command.isFree( ));
+    TEST( view[ 42 ] == 42.f );
+
+    view.clear();
+    TEST( command.isFree( ));
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
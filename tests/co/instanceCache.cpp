@@ -1,5 +1,5 @@
 
-/* Copyright (c) 2009-2011, Stefan Eilemann <eile@equalizergraphics.com> 
+/* Copyright (c) 2009-2012, Stefan Eilemann <eile@equalizergraphics.com> 
  *
  * This library is free software; you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 2.1 as published
@@ -34,7 +34,7 @@
 
 // Tests the functionality of the instance cache
 
-#define N_READER 1
+#define N_READER 4
 #define RUNTIME 5000
 #ifdef NDEBUG
 #  define PACKET_SIZE 4096
@@ -146,6 +146,10 @@ int main( int argc, char **argv )
     }
 
     std::cout << cache << std::endl;
+    const co::InstanceCache::Statistics statistics = cache.getStatistics();
+    TEST( statistics.reads > 0 );
+    TEST( statistics.readHits <= statistics.reads );
+    TEST( statistics.writeHits <= statistics.writes );
 
     for( lunchbox::UUID key; key.low() < 65536; ++key ) // Fill cache
     {
@@ -164,6 +168,44 @@ int main( int argc, char **argv )
     std::cout << cache << std::endl;
 
     TESTINFO( cache.getSize() == 0, cache.getSize( ));
+
+    // LRU eviction honors the maximum size and keeps the recent items
+    {
+        co::InstanceCache small( 256 * PACKET_SIZE );
+        for( lunchbox::UUID key; key.low() < 4096; ++key )
+            TEST( small.add( co::ObjectVersion( key, 1 ), 1, command ));
+
+        TESTINFO( small.getSize() <= small.getMaxSize(), small );
+        TESTINFO( small.getStatistics().evictions > 0, small );
+
+        const lunchbox::UUID last( 0, 4095 );
+        TEST( small[ last ] != co::InstanceCache::Data::NONE );
+        TEST( small.release( last, 1 ));
+        std::cout << small << std::endl;
+    }
+    TEST( command.isFree( ));
+
+    // an item larger than a shard's share of the default size is kept
+    {
+        co::InstanceCache large;
+        const uint64_t size = large.getMaxSize() / 8;
+        co::Command& bigCommand = commandCache.alloc( node, node, size );
+        co::ObjectInstancePacket* bigPacket =
+            bigCommand.getModifiable< co::ObjectInstancePacket >();
+        memcpy( bigPacket, &pkg, sizeof( pkg ));
+        bigPacket->dataSize = size;
+
+        const lunchbox::UUID big( 1, 0 );
+        TEST( large.add( co::ObjectVersion( big, 1 ), 1, bigCommand ));
+        for( lunchbox::UUID key; key.low() < 256; ++key )
+            TEST( large.add( co::ObjectVersion( key, 1 ), 1, command ));
+
+        TESTINFO( large.getSize() >= size, large );
+        TESTINFO( large.getStatistics().evictions == 0, large );
+        TEST( large[ big ] != co::InstanceCache::Data::NONE );
+        TEST( large.release( big, 1 ));
+        std::cout << large << std::endl;
+    }
     TEST( command.isFree( ));
 
     TEST( co::exit( ));
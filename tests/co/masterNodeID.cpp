@@ -0,0 +1,137 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Maps objects without a known master node in a cluster of local nodes and
+// reports the mapping time with a cold and a warm master node cache.
+
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+
+#include <iostream>
+
+#define NNODES   32
+#define NOBJECTS 1000
+
+namespace
+{
+class Object : public co::Object
+{
+public:
+    Object() : value( 0 ) {}
+    uint32_t value;
+
+protected:
+    virtual void getInstanceData( co::DataOStream& os ) { os << value; }
+    virtual void applyInstanceData( co::DataIStream& is ) { is >> value; }
+};
+
+float _mapObjects( co::LocalNodePtr node, Object* masters )
+{
+    Object* slaves = new Object[ NOBJECTS ];
+    lunchbox::Clock clock;
+
+    for( size_t i = 0; i < NOBJECTS; ++i )
+    {
+        TEST( node->mapObject( &slaves[i], masters[i].getID( )));
+        TEST( slaves[i].value == masters[i].value );
+    }
+
+    const float time = clock.getTimef();
+    for( size_t i = 0; i < NOBJECTS; ++i )
+        node->unmapObject( &slaves[i] );
+    delete [] slaves;
+    return time;
+}
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    lunchbox::RNG rng;
+    const uint16_t port = (rng.get<uint16_t>() % 60000) + 1024;
+
+    co::LocalNodePtr client = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+    client->addConnectionDescription( connDesc );
+    TEST( client->listen( ));
+
+    co::LocalNodePtr servers[ NNODES ];
+    co::NodePtr proxies[ NNODES ];
+    for( size_t i = 0; i < NNODES; ++i )
+    {
+        connDesc = new co::ConnectionDescription;
+        connDesc->type = co::CONNECTIONTYPE_TCPIP;
+        connDesc->port = port + i;
+        connDesc->setHostname( "localhost" );
+
+        servers[i] = new co::LocalNode;
+        servers[i]->addConnectionDescription( connDesc );
+        TEST( servers[i]->listen( ));
+
+        proxies[i] = new co::Node;
+        proxies[i]->addConnectionDescription( connDesc );
+        TEST( client->connect( proxies[i] ));
+    }
+
+    // masters on the last connected node
+    co::LocalNodePtr master = servers[ NNODES - 1 ];
+    Object* masters = new Object[ NOBJECTS ];
+    for( size_t i = 0; i < NOBJECTS; ++i )
+    {
+        masters[i].value = uint32_t( i );
+        TEST( master->registerObject( &masters[i] ));
+    }
+
+    const float cold = _mapObjects( client, masters );
+    const float warm = _mapObjects( client, masters );
+    std::cout << "Mapped " << NOBJECTS << " objects from " << NNODES
+              << " nodes in " << cold << " ms, cached master nodes "
+              << warm << " ms" << std::endl;
+
+    for( size_t i = 0; i < NOBJECTS; ++i )
+        master->deregisterObject( &masters[i] );
+    delete [] masters;
+    master = 0;
+
+    for( size_t i = 0; i < NNODES; ++i )
+    {
+        TEST( client->disconnect( proxies[i] ));
+        TEST( servers[i]->close( ));
+        TESTINFO( proxies[i]->getRefCount() == 1, proxies[i]->getRefCount( ));
+        TESTINFO( servers[i]->getRefCount() == 1, servers[i]->getRefCount( ));
+        proxies[i] = 0;
+        servers[i] = 0;
+    }
+
+    TEST( client->close( ));
+    TESTINFO( client->getRefCount() == 1, client->getRefCount( ));
+    client = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,181 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Sends object commands to a slave instance while other objects are mapped
+// and unmapped concurrently, and reports the dispatch throughput.
+
+#include <test.h>
+
+#include <co/command.h>
+#include <co/commandFunc.h>
+#include <co/connectionDescription.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <co/packets.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/rng.h>
+#include <lunchbox/thread.h>
+
+#include <iostream>
+
+#define NPACKETS 200000
+#define NCHURN   10
+
+namespace
+{
+lunchbox::Monitor< uint32_t > _received( 0 );
+
+struct Packet : public co::ObjectPacket
+{
+    Packet()
+        {
+            command = co::CMD_OBJECT_CUSTOM;
+            size = sizeof( Packet );
+        }
+};
+
+class Object : public co::Object
+{
+public:
+    Object()
+        {
+            registerCommand( co::CMD_OBJECT_CUSTOM,
+                             co::CommandFunc< Object >( this, &Object::_cmd ),
+                             0 );
+        }
+
+protected:
+    virtual void getInstanceData( co::DataOStream& ) {}
+    virtual void applyInstanceData( co::DataIStream& ) {}
+
+private:
+    bool _cmd( co::Command& )
+        {
+            ++_received;
+            return true;
+        }
+};
+
+class Churn : public lunchbox::Thread
+{
+public:
+    Churn( co::LocalNodePtr node, const Object* masters )
+        : _node( node ), _masters( masters ), nMappings( 0 ), done( false ) {}
+
+    virtual void run()
+        {
+            while( !done )
+            {
+                Object slaves[ NCHURN ];
+                for( size_t i = 0; i < NCHURN; ++i )
+                    TEST( _node->mapObject( &slaves[i], _masters[i].getID( )));
+                for( size_t i = 0; i < NCHURN; ++i )
+                    _node->unmapObject( &slaves[i] );
+                nMappings += NCHURN;
+            }
+        }
+
+private:
+    co::LocalNodePtr _node;
+    const Object* const _masters;
+
+public:
+    size_t nMappings;
+    bool done;
+};
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    lunchbox::RNG rng;
+    const uint16_t port = (rng.get<uint16_t>() % 60000) + 1024;
+
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = port;
+    connDesc->setHostname( "localhost" );
+    server->addConnectionDescription( connDesc );
+    TEST( server->listen( ));
+
+    co::NodePtr serverProxy = new co::Node;
+    serverProxy->addConnectionDescription( connDesc );
+
+    connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+
+    co::LocalNodePtr client = new co::LocalNode;
+    client->addConnectionDescription( connDesc );
+    TEST( client->listen( ));
+    TEST( client->connect( serverProxy ));
+
+    Object master;
+    Object churnMasters[ NCHURN ];
+    TEST( server->registerObject( &master ));
+    for( size_t i = 0; i < NCHURN; ++i )
+        TEST( server->registerObject( &churnMasters[i] ));
+
+    Object slave;
+    TEST( client->mapObject( &slave, master.getID( )));
+    co::NodePtr clientProxy = server->getNode( client->getNodeID( ));
+    TEST( clientProxy );
+
+    Churn churn( client, churnMasters );
+    TEST( churn.start( ));
+
+    Packet packet;
+    packet.instanceID = slave.getInstanceID();
+
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < NPACKETS; ++i )
+        master.send( clientProxy, packet );
+    _received.waitEQ( NPACKETS );
+    const float time = clock.getTimef();
+
+    churn.done = true;
+    TEST( churn.join( ));
+
+    std::cout << NPACKETS << " object commands dispatched in " << time
+              << " ms (" << NPACKETS / time << " commands/ms) during "
+              << churn.nMappings << " object mappings" << std::endl;
+
+    client->unmapObject( &slave );
+    for( size_t i = 0; i < NCHURN; ++i )
+        server->deregisterObject( &churnMasters[i] );
+    server->deregisterObject( &master );
+    clientProxy = 0;
+
+    TEST( client->disconnect( serverProxy ));
+    TEST( client->close( ));
+    TEST( server->close( ));
+
+    TESTINFO( serverProxy->getRefCount() == 1, serverProxy->getRefCount( ));
+    TESTINFO( client->getRefCount() == 1, client->getRefCount( ));
+    TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+
+    serverProxy = 0;
+    client      = 0;
+    server      = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Maps the entries of an object map one by one, in bulk and on sync, and
+// reports the mapping times.
+
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <co/objectFactory.h>
+#include <co/objectMap.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+
+#include <iostream>
+
+#define NOBJECTS 1000
+
+namespace
+{
+class Object : public co::Object
+{
+public:
+    Object() : value( 0 ) {}
+    uint32_t value;
+
+protected:
+    virtual void getInstanceData( co::DataOStream& os ) { os << value; }
+    virtual void applyInstanceData( co::DataIStream& is ) { is >> value; }
+};
+
+class Factory : public co::ObjectFactory
+{
+public:
+    virtual co::Object* createObject( const uint32_t type )
+    {
+        TEST( type == co::OBJECTTYPE_CUSTOM );
+        return new Object;
+    }
+};
+
+Factory _factory;
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    lunchbox::RNG rng;
+    const uint16_t port = (rng.get<uint16_t>() % 60000) + 1024;
+
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = port;
+    connDesc->setHostname( "localhost" );
+    server->addConnectionDescription( connDesc );
+    TEST( server->listen( ));
+
+    co::NodePtr serverProxy = new co::Node;
+    serverProxy->addConnectionDescription( connDesc );
+
+    connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+
+    co::LocalNodePtr client = new co::LocalNode;
+    client->addConnectionDescription( connDesc );
+    TEST( client->listen( ));
+    TEST( client->connect( serverProxy ));
+
+    Object* masters = new Object[ NOBJECTS ];
+    std::vector< co::uint128_t > identifiers;
+    {
+        co::ObjectMap masterMap( *server, _factory );
+        TEST( server->registerObject( &masterMap ));
+
+        // maps the entries added by the master on sync
+        co::ObjectMap syncMap( *client, _factory );
+        syncMap.setMapOnSync( true );
+        TEST( syncMap.isMapOnSync( ));
+        TEST( client->mapObject( &syncMap, masterMap.getID( )));
+
+        for( size_t i = 0; i < NOBJECTS; ++i )
+        {
+            masters[i].value = uint32_t( i );
+            TEST( masterMap.register_( &masters[i], co::OBJECTTYPE_CUSTOM ));
+            identifiers.push_back( masters[i].getID( ));
+        }
+        masterMap.commit();
+
+        co::ObjectMap serialMap( *client, _factory );
+        co::ObjectMap bulkMap( *client, _factory );
+        TEST( client->mapObject( &serialMap, masterMap.getID( )));
+        TEST( client->mapObject( &bulkMap, masterMap.getID( )));
+
+        lunchbox::Clock clock;
+        for( size_t i = 0; i < NOBJECTS; ++i )
+        {
+            const Object* object =
+                static_cast< Object* >( serialMap.get( identifiers[i] ));
+            TEST( object );
+            TEST( object->value == i );
+        }
+        const float serialTime = clock.resetTimef();
+
+        co::Objects objects;
+        TEST( bulkMap.get( identifiers, objects ));
+        const float bulkTime = clock.resetTimef();
+
+        syncMap.sync( masterMap.getVersion( ));
+        const float syncTime = clock.getTimef();
+        for( size_t i = 0; i < NOBJECTS; ++i )
+        {
+            const Object* object =
+                static_cast< Object* >( syncMap.get( identifiers[i] ));
+            TEST( object );
+            TEST( object->value == i );
+        }
+
+        TEST( objects.size() == NOBJECTS );
+        for( size_t i = 0; i < NOBJECTS; ++i )
+        {
+            const Object* object = static_cast< Object* >( objects[i] );
+            TEST( object );
+            TEST( object->value == i );
+        }
+
+        std::cout << "Mapped " << NOBJECTS << " objects one by one in "
+                  << serialTime << " ms, in bulk in " << bulkTime
+                  << " ms, on sync in " << syncTime << " ms" << std::endl;
+
+        client->unmapObject( &syncMap );
+        client->unmapObject( &serialMap );
+        client->unmapObject( &bulkMap );
+        server->deregisterObject( &masterMap );
+    }
+    delete [] masters;
+
+    TEST( client->disconnect( serverProxy ));
+    TEST( client->close( ));
+    TEST( server->close( ));
+
+    TESTINFO( serverProxy->getRefCount() == 1, serverProxy->getRefCount( ));
+    TESTINFO( client->getRefCount() == 1, client->getRefCount( ));
+    TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+
+    serverProxy = 0;
+    client      = 0;
+    server      = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,163 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Commits an object map with a varying fraction of dirty masters and reports
+// the serial and concurrent commit times. Checks that masters reporting their
+// changes only through isDirty() are committed.
+
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/objectFactory.h>
+#include <co/objectMap.h>
+#include <co/serializable.h>
+#include <lunchbox/clock.h>
+
+#include <iostream>
+
+#define NOBJECTS 10000
+#define NFRAMES  10
+
+namespace
+{
+class Object : public co::Serializable
+{
+public:
+    Object() : value( 0 ) {}
+
+    void setValue( const uint32_t v ) { value = v; setDirty( DIRTY_VALUE ); }
+    uint32_t value;
+
+protected:
+    enum DirtyBits
+    {
+        DIRTY_VALUE = co::Serializable::DIRTY_CUSTOM << 0
+    };
+
+    virtual void serialize( co::DataOStream& os, const uint64_t )
+        { os << value; }
+    virtual void deserialize( co::DataIStream& is, const uint64_t )
+        { is >> value; }
+};
+
+// Reports changes of its child through isDirty(), like eq::fabric::Object does
+// for its user data
+class Parent : public Object
+{
+public:
+    Object child;
+
+protected:
+    virtual bool isDirty() const
+        { return Object::isDirty() || child.value != value; }
+    virtual bool isDirtyTracked() const { return false; }
+    virtual void serialize( co::DataOStream& os, const uint64_t dirtyBits )
+        {
+            value = child.value;
+            Object::serialize( os, dirtyBits );
+        }
+};
+
+class Factory : public co::ObjectFactory
+{
+public:
+    virtual co::Object* createObject( const uint32_t ) { return new Object; }
+};
+
+Factory _factory;
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    co::LocalNodePtr node = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+    node->addConnectionDescription( connDesc );
+    TEST( node->listen( ));
+
+    Object* objects = new Object[ NOBJECTS ];
+    Parent parent;
+    {
+        co::ObjectMap map( *node, _factory );
+        TEST( node->registerObject( &map ));
+
+        for( size_t i = 0; i < NOBJECTS; ++i )
+            TEST( map.register_( &objects[i], co::OBJECTTYPE_CUSTOM ));
+        map.commit();
+        TEST( !map.isDirty( ));
+
+        TEST( map.register_( &parent, co::OBJECTTYPE_CUSTOM ));
+        map.commit();
+        TEST( !map.isDirty( ));
+
+        const co::uint128_t parentVersion = parent.getVersion();
+        parent.child.value = 42;
+        TEST( map.isDirty( ));
+        map.commit();
+        TEST( !map.isDirty( ));
+        TEST( parent.getVersion() > parentVersion );
+        TEST( parent.value == 42 );
+
+        static const size_t percentages[] = { 1, 10, 100 };
+        for( size_t i = 0; i < 6; ++i )
+        {
+            const size_t step = 100 / percentages[ i % 3 ];
+            const bool concurrent = i >= 3;
+            map.setConcurrentCommit( concurrent );
+            TEST( map.isConcurrentCommit() == concurrent );
+            lunchbox::Clock clock;
+
+            for( uint32_t frame = 0; frame < NFRAMES; ++frame )
+            {
+                for( size_t j = 0; j < NOBJECTS; j += step )
+                    objects[j].setValue( frame );
+
+                TEST( map.isDirty( ));
+                const co::uint128_t version = objects[0].getVersion();
+                map.commit();
+                TEST( !map.isDirty( ));
+                TEST( objects[0].getVersion() > version );
+                if( step > 1 )
+                    TEST( objects[1].getVersion() == co::VERSION_FIRST );
+            }
+
+            std::cout << ( concurrent ? "Concurrently committed " :
+                                        "Committed " )
+                      << NOBJECTS / step << " of " << NOBJECTS
+                      << " dirty objects in "
+                      << clock.getTimef() / float( NFRAMES ) << " ms"
+                      << std::endl;
+        }
+
+        node->deregisterObject( &map );
+    }
+    delete [] objects;
+
+    TEST( node->close( ));
+    TESTINFO( node->getRefCount() == 1, node->getRefCount( ));
+    node = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Maps a large object concurrently on a varying number of nodes and reports
+// the distribution time with and without relaying the instance data through
+// the slave nodes. Checks that a mapping is served by a relaying slave.
+
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/global.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+#include <lunchbox/thread.h>
+
+#include <iostream>
+
+// Relaying slaves pin the instance data in their cache, the release object
+// exceeds the default IATTR_INSTANCE_CACHE_SIZE
+#ifdef NDEBUG
+#  define SIZE      ( uint64_t( 1 ) << 27 ) // 128MB
+#  define MAX_NODES 64
+#else
+#  define SIZE      ( uint64_t( 1 ) << 24 ) // 16MB
+#  define MAX_NODES 8
+#endif
+
+namespace
+{
+class Object : public co::Object
+{
+public:
+    Object() : size( 0 ), last( 0 ) {}
+
+    std::vector< uint8_t > data;
+    uint64_t size;
+    uint8_t last;
+
+protected:
+    virtual ChangeType getChangeType() const { return INSTANCE; }
+    virtual void getInstanceData( co::DataOStream& os ) { os << data; }
+    virtual void applyInstanceData( co::DataIStream& is )
+        {
+            is >> data;
+            size = data.size();
+            last = data.empty() ? 0 : data.back();
+            std::vector< uint8_t >().swap( data ); // keep memory usage low
+        }
+};
+
+class Mapper : public lunchbox::Thread
+{
+public:
+    Mapper( co::ConnectionDescriptionPtr serverDesc )
+        {
+            node = new co::LocalNode;
+            co::ConnectionDescriptionPtr connDesc =
+                new co::ConnectionDescription;
+            connDesc->type = co::CONNECTIONTYPE_TCPIP;
+            connDesc->setHostname( "localhost" );
+            node->addConnectionDescription( connDesc );
+            TEST( node->listen( ));
+
+            server = new co::Node;
+            server->addConnectionDescription( serverDesc );
+            TEST( node->connect( server ));
+        }
+
+    ~Mapper()
+        {
+            node->unmapObject( &slave );
+            TEST( node->disconnect( server ));
+            TEST( node->close( ));
+            TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+        }
+
+    virtual void run() { TEST( node->mapObject( &slave, id )); }
+
+    co::LocalNodePtr node;
+    co::NodePtr server;
+    Object slave;
+    co::UUID id;
+};
+
+float _distribute( co::LocalNodePtr server,
+                   co::ConnectionDescriptionPtr serverDesc,
+                   const size_t nNodes, const bool relay )
+{
+    co::Global::setIAttribute( co::Global::IATTR_INSTANCE_RELAY, relay );
+
+    Object master;
+    master.data.resize( SIZE );
+    master.data.back() = 42;
+    TEST( server->registerObject( &master ));
+
+    std::vector< Mapper* > mappers;
+    for( size_t i = 0; i < nNodes; ++i )
+    {
+        mappers.push_back( new Mapper( serverDesc ));
+        mappers.back()->id = master.getID();
+    }
+
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < nNodes; ++i )
+        TEST( mappers[i]->start( ));
+    for( size_t i = 0; i < nNodes; ++i )
+        TEST( mappers[i]->join( ));
+    const float time = clock.getTimef();
+
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    for( size_t i = 0; i < nNodes; ++i )
+    {
+        TEST( mappers[i]->slave.size == SIZE );
+        TEST( mappers[i]->slave.last == 42 );
+        hits += mappers[i]->node->getRelayHits();
+        misses += mappers[i]->node->getRelayMisses();
+        delete mappers[i];
+    }
+
+    if( relay )
+        std::cout << nNodes << " nodes: " << hits << " relay hits, " << misses
+                  << " misses" << std::endl;
+    else
+        TESTINFO( hits == 0 && misses == 0, hits << " " << misses );
+
+    server->deregisterObject( &master );
+    return time;
+}
+
+// Maps the object sequentially on two nodes, the first slave has to relay the
+// instance data to the second slave even though it exceeds its instance cache.
+void _testRelay( co::LocalNodePtr server,
+                 co::ConnectionDescriptionPtr serverDesc )
+{
+    co::Global::setIAttribute( co::Global::IATTR_INSTANCE_RELAY, true );
+    const int32_t cacheSize =
+        co::Global::getIAttribute( co::Global::IATTR_INSTANCE_CACHE_SIZE );
+    co::Global::setIAttribute( co::Global::IATTR_INSTANCE_CACHE_SIZE, 1 );
+
+    Object master;
+    master.data.resize( SIZE );
+    master.data.back() = 42;
+    TEST( server->registerObject( &master ));
+
+    Mapper first( serverDesc );
+    Mapper second( serverDesc );
+    first.id = master.getID();
+    second.id = master.getID();
+
+    first.run();
+    second.run();
+
+    TEST( second.slave.size == SIZE );
+    TEST( second.slave.last == 42 );
+    TESTINFO( first.node->getRelayHits() == 0, first.node->getRelayHits( ));
+    TESTINFO( first.node->getRelayMisses() == 0,
+              first.node->getRelayMisses( ));
+    TESTINFO( second.node->getRelayHits() == 1, second.node->getRelayHits( ));
+    TESTINFO( second.node->getRelayMisses() == 0,
+              second.node->getRelayMisses( ));
+
+    server->deregisterObject( &master );
+    co::Global::setIAttribute( co::Global::IATTR_INSTANCE_CACHE_SIZE,
+                               cacheSize );
+}
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+
+    lunchbox::RNG rng;
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = (rng.get<uint16_t>() % 60000) + 1024;
+    connDesc->setHostname( "localhost" );
+    server->addConnectionDescription( connDesc );
+    TEST( server->listen( ));
+
+    _testRelay( server, connDesc );
+    for( size_t nNodes = 2; nNodes <= MAX_NODES; nNodes <<= 1 )
+    {
+        const float direct = _distribute( server, connDesc, nNodes, false );
+        const float relayed = _distribute( server, connDesc, nNodes, true );
+        std::cout << "Distributed " << ( SIZE >> 20 ) << " MB to " << nNodes
+                  << " nodes in " << direct << " ms, relayed in " << relayed
+                  << " ms" << std::endl;
+    }
+
+    TEST( server->close( ));
+    TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+    server = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
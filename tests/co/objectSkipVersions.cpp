@@ -0,0 +1,180 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Lets a slave instance fall behind by many versions and reports the time to
+// catch up with and without skipping queued versions.
+
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/global.h>
+#include <co/init.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/rng.h>
+#include <lunchbox/sleep.h>
+
+#include <iostream>
+
+#define NVERSIONS 1000
+#define SIZE      LB_64KB
+
+namespace
+{
+class Object : public co::Object
+{
+public:
+    Object( const ChangeType type, const bool skip )
+        : value( 0 ), nApplied( 0 ), _type( type ), _skip( skip )
+        , _data( SIZE ) {}
+
+    uint32_t value;
+    uint32_t nApplied;
+
+protected:
+    virtual ChangeType getChangeType() const { return _type; }
+    virtual bool canSkipVersions() const { return _skip; }
+
+    virtual void getInstanceData( co::DataOStream& os )
+        { os << value << _data; }
+    virtual void applyInstanceData( co::DataIStream& is )
+        { is >> value >> _data; ++nApplied; }
+
+    virtual void pack( co::DataOStream& os )
+        {
+            if( _type == INSTANCE )
+                getInstanceData( os );
+            else
+                os << value;
+        }
+    virtual void unpack( co::DataIStream& is )
+        {
+            if( _type == INSTANCE )
+                applyInstanceData( is );
+            else
+            {
+                is >> value;
+                ++nApplied;
+            }
+        }
+
+private:
+    const ChangeType _type;
+    const bool _skip;
+    std::vector< uint8_t > _data;
+};
+
+float _catchUp( co::LocalNodePtr server, co::LocalNodePtr client,
+                const co::Object::ChangeType type, const bool skip,
+                uint32_t& nApplied )
+{
+    Object master( type, false );
+    TEST( client->registerObject( &master ));
+
+    Object slave( type, skip );
+    TEST( server->mapObject( &slave, master.getID( )));
+    slave.nApplied = 0;
+
+    for( size_t i = 0; i < NVERSIONS; ++i )
+    {
+        ++master.value;
+        master.commit();
+    }
+
+    while( slave.getHeadVersion() < master.getVersion( ))
+        lunchbox::sleep( 1 );
+
+    lunchbox::Clock clock;
+    slave.sync();
+    const float time = clock.getTimef();
+
+    TESTINFO( slave.getVersion() == master.getVersion(), slave.getVersion( ));
+    TESTINFO( slave.value == NVERSIONS, slave.value );
+    nApplied = slave.nApplied;
+
+    server->unmapObject( &slave );
+    client->deregisterObject( &master );
+    return time;
+}
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+    lunchbox::RNG rng;
+
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = (rng.get<uint16_t>() % 60000) + 1024;
+    connDesc->setHostname( "localhost" );
+    server->addConnectionDescription( connDesc );
+    TEST( server->listen( ));
+
+    co::NodePtr serverProxy = new co::Node;
+    serverProxy->addConnectionDescription( connDesc );
+
+    connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+
+    co::LocalNodePtr client = new co::LocalNode;
+    client->addConnectionDescription( connDesc );
+    TEST( client->listen( ));
+    TEST( client->connect( serverProxy ));
+
+    uint32_t nApplied = 0;
+    float time = _catchUp( server, client, co::Object::INSTANCE, false,
+                           nApplied );
+    TESTINFO( nApplied == NVERSIONS, nApplied );
+    std::cout << "Caught up " << NVERSIONS << " instance versions in " << time
+              << " ms applying all versions, ";
+
+    time = _catchUp( server, client, co::Object::INSTANCE, true, nApplied );
+    TESTINFO( nApplied == 1, nApplied );
+    std::cout << time << " ms skipping versions" << std::endl;
+
+    time = _catchUp( server, client, co::Object::DELTA, false, nApplied );
+    TESTINFO( nApplied == NVERSIONS, nApplied );
+    std::cout << "Caught up " << NVERSIONS << " delta versions in " << time
+              << " ms applying all versions, ";
+
+    co::Global::setIAttribute( co::Global::IATTR_OBJECT_SNAPSHOT_THRESHOLD,
+                               NVERSIONS / 10 );
+    time = _catchUp( server, client, co::Object::DELTA, true, nApplied );
+    TESTINFO( nApplied <= NVERSIONS, nApplied );
+    std::cout << time << " ms using a snapshot, applied " << nApplied
+              << " versions" << std::endl;
+
+    TEST( client->disconnect( serverProxy ));
+    TEST( client->close( ));
+    TEST( server->close( ));
+
+    TESTINFO( serverProxy->getRefCount() == 1, serverProxy->getRefCount( ));
+    TESTINFO( client->getRefCount() == 1, client->getRefCount( ));
+    TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+
+    serverProxy = 0;
+    client      = 0;
+    server      = 0;
+
+    co::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,184 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Maps a large object from a restarted client node and reports the mapping
+// time with a cold and a warm persistent instance cache. The warm mapping has
+// to be served from the instance data loaded from disk, which is split into
+// many packets and has to arrive unchanged.
+
+#include <test.h>
+
+#include <co/connectionDescription.h>
+#include <co/dataIStream.h>
+#include <co/dataOStream.h>
+#include <co/global.h>
+#include <co/init.h>
+#include <co/instanceCache.h>
+#include <co/node.h>
+#include <co/object.h>
+#include <lunchbox/clock.h>
+#include <lunchbox/file.h>
+#include <lunchbox/rng.h>
+
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#ifdef _WIN32
+#  include <direct.h>
+#else
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+// fits into the default instance cache size (IATTR_INSTANCE_CACHE_SIZE)
+#define SIZE ( uint64_t( 1 ) << 26 ) // 64MB
+
+namespace
+{
+class Object : public co::Object
+{
+public:
+    std::vector< uint8_t > data;
+
+protected:
+    virtual void getInstanceData( co::DataOStream& os ) { os << data; }
+    virtual void applyInstanceData( co::DataIStream& is ) { is >> data; }
+};
+
+// Creates a new, empty directory for the instance cache files
+std::string _createDirectory()
+{
+    const co::UUID id( true );
+#ifdef _WIN32
+    const char* temp = getenv( "TEMP" );
+    std::ostringstream name;
+    name << ( temp ? temp : "." ) << "\\persistentInstanceCache." << id;
+    TEST( ::_mkdir( name.str().c_str( )) == 0 );
+#else
+    std::ostringstream name;
+    name << "/tmp/persistentInstanceCache." << id;
+    TEST( ::mkdir( name.str().c_str(), S_IRWXU ) == 0 );
+#endif
+    return name.str();
+}
+
+void _removeDirectory( const std::string& directory )
+{
+    const lunchbox::Strings files = lunchbox::searchDirectory( directory,
+                                                               "*" );
+    for( lunchbox::StringsCIter i = files.begin(); i != files.end(); ++i )
+        if( *i != "." && *i != ".." )
+            ::remove( ( directory + '/' + *i ).c_str( ));
+#ifdef _WIN32
+    TEST( ::_rmdir( directory.c_str( )) == 0 );
+#else
+    TEST( ::rmdir( directory.c_str( )) == 0 );
+#endif
+}
+
+// Starts a new client node, maps the object and returns the mapping time and
+// the instance cache statistics of the client
+float _mapObject( co::ConnectionDescriptionPtr serverDesc, const Object& master,
+                  float& startTime, co::InstanceCache::Statistics& statistics )
+{
+    lunchbox::Clock clock;
+    co::LocalNodePtr client = new co::LocalNode; // loads the instance cache
+    startTime = clock.getTimef();
+
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->setHostname( "localhost" );
+    client->addConnectionDescription( connDesc );
+    TEST( client->listen( ));
+
+    co::NodePtr serverProxy = new co::Node;
+    serverProxy->addConnectionDescription( serverDesc );
+    TEST( client->connect( serverProxy ));
+
+    Object slave;
+    clock.reset();
+    TEST( client->mapObject( &slave, master.getID( )));
+    const float time = clock.getTimef();
+
+    const co::InstanceCache* cache = client->getInstanceCache();
+    TEST( cache );
+    statistics = cache->getStatistics();
+
+    TEST( slave.data.size() == SIZE );
+    TEST( slave.data == master.data );
+
+    client->unmapObject( &slave );
+    TEST( client->disconnect( serverProxy ));
+    TEST( client->close( )); // writes the instance cache
+
+    TESTINFO( serverProxy->getRefCount() == 1, serverProxy->getRefCount( ));
+    TESTINFO( client->getRefCount() == 1, client->getRefCount( ));
+    return time;
+}
+}
+
+int main( int argc, char **argv )
+{
+    co::init( argc, argv );
+    const std::string directory = _createDirectory();
+    co::Global::setInstanceCacheDirectory( directory );
+
+    lunchbox::RNG rng;
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = (rng.get<uint16_t>() % 60000) + 1024;
+    connDesc->setHostname( "localhost" );
+    server->addConnectionDescription( connDesc );
+    TEST( server->listen( ));
+
+    Object master;
+    // position-dependent content, reordered or overwritten packets differ
+    const uint8_t seed = rng.get< uint8_t >();
+    master.data.resize( SIZE );
+    for( uint64_t i = 0; i < SIZE; ++i )
+        master.data[i] = uint8_t( seed + i * 131 + ( i >> 16 ));
+    TEST( server->registerObject( &master ));
+
+    float coldStart = 0.f;
+    float warmStart = 0.f;
+    co::InstanceCache::Statistics coldStats;
+    co::InstanceCache::Statistics warmStats;
+    const float cold = _mapObject( connDesc, master, coldStart, coldStats );
+    const float warm = _mapObject( connDesc, master, warmStart, warmStats );
+
+    std::cout << "Mapped " << ( SIZE >> 20 ) << " MB object in " << cold
+              << " ms with a cold, " << warm << " ms with a warm instance "
+              << "cache loaded in " << warmStart << " ms" << std::endl
+              << "Cold cache: " << coldStats << std::endl
+              << "Warm cache: " << warmStats << std::endl;
+
+    // the cold client had nothing to map from, the warm client found the data
+    // written by the first client and used it instead of the master's data
+    TESTINFO( coldStats.readHits == 0, coldStats );
+    TESTINFO( warmStats.readHits > 0, warmStats );
+    TESTINFO( warmStats.evictions == 0, warmStats );
+
+    server->deregisterObject( &master ); // removes the cache files
+    TEST( server->close( ));
+    TESTINFO( server->getRefCount() == 1, server->getRefCount( ));
+    server = 0;
+
+    co::exit();
+    _removeDirectory( directory );
+    return EXIT_SUCCESS;
+}
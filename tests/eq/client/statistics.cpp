@@ -0,0 +1,148 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Injects synthetic channel statistics batched per node into the
+// application-side statistics store from a receiver thread and reports the
+// ingestion rate.
+
+#include <test.h>
+#include <eq/client/detail/statisticsStore.h>
+
+#include <lunchbox/clock.h>
+#include <lunchbox/monitor.h>
+#include <lunchbox/thread.h>
+
+#include <iostream>
+
+#define NNODES    20
+#define NCHANNELS 200 // in total, evenly distributed to the nodes
+#define NTYPES    20
+#define NFRAMES   250
+#define LATENCY   1
+
+using eq::detail::StatisticsStore;
+
+namespace
+{
+StatisticsStore _store( 4096 );
+lunchbox::Monitor< uint32_t > _startedFrame( 0 );
+size_t _nOverflow = 0;
+
+class Receiver : public lunchbox::Thread
+{
+public:
+    virtual void run()
+    {
+        for( uint32_t frame = 1; frame <= NFRAMES; ++frame )
+        {
+            _startedFrame.waitGE( frame );
+
+            for( uint32_t node = 0; node < NNODES; ++node )
+            {
+                StatisticsStore::Record* record = new StatisticsStore::Record;
+                std::vector< eq::Event >& events = record->events;
+
+                for( uint32_t channel = node + 1; channel <= NCHANNELS;
+                     channel += NNODES )
+                {
+                    for( size_t i = 0; i < NTYPES; ++i )
+                    {
+                        eq::Event event;
+                        event.type = eq::Event::STATISTIC;
+                        event.serial = channel;
+
+                        eq::Statistic& statistic = event.statistic;
+                        statistic.type = eq::Statistic::Type( i % 10 + 1 );
+                        statistic.frameNumber = frame;
+                        statistic.startTime = i;
+                        statistic.endTime = i + 1;
+                        events.push_back( event );
+                    }
+                }
+
+                if( !_store.push( record ))
+                    ++_nOverflow;
+            }
+            frames = frame;
+        }
+    }
+
+    lunchbox::Monitor< uint32_t > frames;
+};
+}
+
+int main( int argc, char **argv )
+{
+    Receiver receiver;
+    lunchbox::Clock clock;
+    TEST( receiver.start( ));
+
+    for( uint32_t frame = 1; frame <= NFRAMES + LATENCY; ++frame )
+    {
+        // startFrame, then wait for the frame within latency like finishFrame
+        if( frame <= NFRAMES )
+            _startedFrame = frame;
+        if( frame <= LATENCY )
+            continue;
+
+        const uint32_t finished = frame - LATENCY;
+        receiver.frames.waitGE( finished );
+        _store.update( finished, 3, LATENCY );
+
+        // sort the batches like eq::Config::handleEvent() for each event
+        StatisticsStore::Record* record = 0;
+        while( _store.pop( record ))
+        {
+            const std::vector< eq::Event >& events = record->events;
+            for( std::vector< eq::Event >::const_iterator i = events.begin();
+                 i != events.end(); ++i )
+            {
+                _store.add( i->serial, &i->statistic, 1 );
+            }
+            delete record;
+        }
+
+        std::vector< eq::FrameStatistics > statistics;
+        _store.get( statistics );
+        TEST( !statistics.empty( ));
+        TESTINFO( statistics.size() <= 3, statistics.size( ));
+
+        for( std::vector< eq::FrameStatistics >::const_iterator i =
+                 statistics.begin(); i != statistics.end(); ++i )
+        {
+            TEST( i->first <= finished );
+            TESTINFO( i->second.size() == NCHANNELS,
+                      i->second.size() << " originators in frame "<< i->first );
+            for( eq::SortedStatistics::const_iterator j = i->second.begin();
+                 j != i->second.end(); ++j )
+            {
+                TEST( j->second.size() == NTYPES );
+            }
+        }
+    }
+
+    const float time = clock.getTimef();
+    TEST( receiver.join( ));
+
+    const float nSamples = float( NFRAMES * NCHANNELS * NTYPES );
+    const float rate = nSamples / time * 1000.f;
+    std::cout << nSamples << " statistics in " << time << " ms: " << rate
+              << " samples/s, " << _nOverflow << " of "
+              << NFRAMES * NNODES << " batches queued in the overflow list"
+              << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,183 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Tests the delta encoding of render contexts and reports the encoded size
+// and the server-side encoding time against sending full contexts
+
+#include <test.h>
+#include <eq/fabric/renderContext.h>
+
+#include <lunchbox/clock.h>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#define NFRAMES 100
+#define NCHANNELS 64
+#define NTASKS 8 // per channel and frame, using two distinct contexts
+
+using eq::fabric::RenderContext;
+
+namespace
+{
+size_t _transmit( const RenderContext& context, RenderContext& server,
+                  RenderContext& client )
+{
+    const uint32_t fields = context.getDelta( server );
+    std::vector< uint8_t > data;
+    context.serializeDelta( fields, data );
+    TEST( RenderContext::getDeltaSize( fields ) == data.size( ));
+
+    const size_t size = data.empty() ? 0 :
+                        client.deserializeDelta( fields, &data[0] );
+    TESTINFO( size == data.size(), size << " != " << data.size( ));
+    server = context;
+
+    TEST( context.getDelta( client ) == 0 );
+    return size;
+}
+
+// Per-channel server state, mirrors eq::server::Channel::sendContext
+struct Sender
+{
+    Sender() : nContexts( 0 ) {}
+
+    size_t send( const RenderContext& context )
+    {
+        for( size_t i = nContexts; i > 0; --i )
+            if( context.getDelta( contexts[ i - 1 ] ) == 0 )
+                return 0;
+
+        RenderContext& previous = contexts[ nContexts++ ];
+        const uint32_t fields = context.getDelta( previous );
+        if( fields == 0 )
+            return 0;
+
+        data.clear();
+        context.serializeDelta( fields, data );
+        previous = context;
+        return data.size();
+    }
+
+    RenderContext contexts[ 2 ];
+    size_t nContexts;
+    std::vector< uint8_t > data;
+};
+
+void _benchmark( const RenderContext& base )
+{
+    std::vector< RenderContext > contexts( NCHANNELS * 2, base );
+    for( size_t i = 0; i < contexts.size(); ++i )
+    {
+        contexts[i].pvp.x = int32_t( i );
+        contexts[i].eye = ( i % 2 ) ? eq::fabric::EYE_RIGHT :
+                                      eq::fabric::EYE_LEFT;
+    }
+
+    // before: each task packet carried a full render context
+    std::vector< uint8_t > buffer( sizeof( RenderContext ));
+    lunchbox::Clock clock;
+    size_t fullBytes = 0;
+    for( size_t i = 0; i < NFRAMES; ++i )
+        for( size_t j = 0; j < NCHANNELS * NTASKS; ++j )
+        {
+            RenderContext& context = contexts[ j / NTASKS * 2 + j % 2 ];
+            context.frameID = eq::fabric::uint128_t( uint64_t( i ));
+            ::memcpy( &buffer[0], &context, sizeof( RenderContext ));
+            fullBytes += sizeof( RenderContext );
+        }
+    const float fullTime = clock.getTimef();
+
+    // after: one delta per distinct context and channel
+    std::vector< Sender > senders( NCHANNELS );
+    clock.reset();
+    size_t deltaBytes = 0;
+    for( size_t i = 0; i < NFRAMES; ++i )
+    {
+        for( size_t j = 0; j < NCHANNELS; ++j )
+            senders[j].nContexts = 0;
+
+        for( size_t j = 0; j < NCHANNELS * NTASKS; ++j )
+        {
+            RenderContext& context = contexts[ j / NTASKS * 2 + j % 2 ];
+            context.frameID = eq::fabric::uint128_t( uint64_t( i ));
+            deltaBytes += senders[ j / NTASKS ].send( context );
+        }
+    }
+    const float deltaTime = clock.getTimef();
+
+    std::cout << NCHANNELS << " channels, " << NTASKS << " tasks: full "
+              << fullBytes / NFRAMES << " bytes, "
+              << fullTime / float( NFRAMES ) << " ms per frame; delta "
+              << deltaBytes / NFRAMES << " bytes, "
+              << deltaTime / float( NFRAMES ) << " ms per frame" << std::endl;
+    TEST( deltaBytes < fullBytes / 4 );
+}
+}
+
+int main( int argc, char **argv )
+{
+    RenderContext server;
+    RenderContext client;
+
+    // unchanged context
+    TEST( server.getDelta( client ) == 0 );
+    TEST( _transmit( server, server, client ) == 0 );
+    TEST( RenderContext::getDeltaSize( 0 ) == 0 );
+    TEST( RenderContext::getDeltaSize( 0xffffffffu ) ==
+          std::numeric_limits< size_t >::max( ));
+
+    // first frame: all modified fields
+    RenderContext context;
+    context.pvp = eq::fabric::PixelViewport( 0, 0, 1920, 1200 );
+    context.vp = eq::fabric::Viewport( 0.f, 0.f, .5f, 1.f );
+    context.range = eq::fabric::Range( .25f, .5f );
+    context.taskID = 42;
+    context.eye = eq::fabric::EYE_LEFT;
+    context.frustum.left() = -2.f;
+    context.headTransform.array[ 12 ] = 1.f;
+
+    size_t full = _transmit( context, server, client );
+    TEST( full > 0 );
+    TEST( client.pvp == context.pvp );
+    TEST( client.range == context.range );
+    TEST( client.taskID == 42 );
+
+    // following frames: new frame ID, moving head every tenth frame
+    size_t total = 0;
+    for( size_t i = 1; i <= NFRAMES; ++i )
+    {
+        context.frameID = eq::fabric::uint128_t( uint64_t( i ));
+        if( i % 10 == 0 )
+        {
+            context.headTransform.array[ 12 ] = float( i );
+            context.frustum.left() = -2.f - float( i ) * .01f;
+        }
+
+        const size_t size = _transmit( context, server, client );
+        TEST( size >= sizeof( context.frameID ));
+        total += size;
+    }
+
+    std::cout << "Render context " << sizeof( RenderContext ) << " bytes, "
+              << "first delta " << full << " bytes, average delta "
+              << float( total ) / float( NFRAMES ) << " bytes" << std::endl;
+    TEST( total < NFRAMES * sizeof( RenderContext ) / 4 );
+
+    _benchmark( context );
+    return EXIT_SUCCESS;
+}
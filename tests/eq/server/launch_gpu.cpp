@@ -0,0 +1,135 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Launches configs with an increasing number of local render client processes
+// and reports the config init and exit time versus the node count.
+
+#include <test.h>
+#include <eq/eq.h>
+
+#include <cstdio>
+#include <fstream>
+
+#define MAX_NODES 16
+#define FILENAME "launch_gpu.tmp"
+
+namespace
+{
+void _writeConfig( const size_t nNodes )
+{
+    std::ofstream file( FILENAME );
+    file << "#Equalizer 1.0 ascii" << std::endl
+         << "global" << std::endl
+         << "{" << std::endl
+         << "    EQ_NODE_SATTR_LAUNCH_COMMAND \"%c\"" << std::endl
+         << "    EQ_WINDOW_IATTR_HINT_DRAWABLE FBO" << std::endl
+         << "}" << std::endl
+         << "server" << std::endl
+         << "{" << std::endl
+         << "    connection { hostname \"127.0.0.1\" }" << std::endl
+         << "    config" << std::endl
+         << "    {" << std::endl
+         << "        appNode { pipe { window { channel { name \"app\" }}}}"
+         << std::endl;
+
+    for( size_t i = 0; i < nNodes; ++i )
+        file << "        node { connection { hostname \"127.0.0.1\" } "
+             << "pipe { window { channel { name \"channel" << i << "\" }}}}"
+             << std::endl;
+
+    file << "        compound" << std::endl
+         << "        {" << std::endl
+         << "            channel \"app\"" << std::endl
+         << "            wall {}" << std::endl;
+
+    for( size_t i = 0; i < nNodes; ++i )
+        file << "            compound { channel \"channel" << i << "\" }"
+             << std::endl;
+
+    file << "        }" << std::endl
+         << "    }" << std::endl
+         << "}" << std::endl;
+}
+
+void _testLaunch( eq::ClientPtr client, const size_t nNodes,
+                  float& initTime, float& exitTime )
+{
+    _writeConfig( nNodes );
+
+    eq::ServerPtr server = new eq::Server;
+    eq::Global::setConfigFile( FILENAME );
+    TEST( client->connectServer( server ));
+
+    eq::ConfigParams configParams;
+    eq::Config* config = server->chooseConfig( configParams );
+    TEST( config );
+    TEST( config->getNodes().size() == nNodes + 1 );
+
+    lunchbox::Clock clock;
+    TESTINFO( config->init( 0 ), nNodes << " nodes: " << config->getError( ));
+    initTime = clock.getTimef();
+
+    config->startFrame( 0 );
+    config->finishAllFrames();
+
+    clock.reset();
+    TEST( config->exit( ));
+    exitTime = clock.getTimef();
+
+    server->releaseConfig( config );
+    client->disconnectServer( server );
+    ::remove( FILENAME );
+}
+}
+
+int main( const int argc, char** argv )
+{
+    // render clients are launched using this executable
+    eq::NodeFactory nodeFactory;
+    if( !eq::init( argc, argv, &nodeFactory ))
+    {
+        LBERROR << "Equalizer init failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    eq::ClientPtr client = new eq::Client;
+    TEST( client->initLocal( argc, argv ));
+
+    float singleInit = 0.f;
+    for( size_t nNodes = 1; nNodes <= MAX_NODES; nNodes <<= 1 )
+    {
+        float initTime = 0.f;
+        float exitTime = 0.f;
+        _testLaunch( client, nNodes, initTime, exitTime );
+
+        std::cout << nNodes << " nodes: init " << initTime << " ms, exit "
+                  << exitTime << " ms" << std::endl;
+
+        if( nNodes == 1 )
+            singleInit = initTime;
+        else // launches are concurrent, startup has to scale sub-linearly
+            TESTINFO( initTime < singleInit * float( nNodes ),
+                      nNodes << " nodes init in " << initTime << " ms, one in "
+                      << singleInit << " ms" );
+    }
+
+    client->exitLocal();
+    TESTINFO( client->getRefCount() == 1, client );
+
+    eq::exit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+
+/* Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// Simulates pull-based tile rendering with a hot spot and compares the frame
+// time of the zigzag and the cost-ordered tile strategies.
+
+#include <test.h>
+
+#include <eq/server/tiles/costStrategy.h>
+#include <eq/server/tiles/zigzagStrategy.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#define WIDTH    1920
+#define HEIGHT   1200
+#define TILESIZE 64
+#define NWORKERS 8
+
+using eq::server::PixelViewport;
+using eq::server::Vector2i;
+
+namespace
+{
+typedef std::vector< PixelViewport > PixelViewports;
+
+// per-pixel render cost: constant background plus an expensive hot spot
+float _getCost( const int32_t x, const int32_t y )
+{
+    const float dx = float( x - WIDTH / 3 ) / 120.f;
+    const float dy = float( y - HEIGHT / 2 ) / 120.f;
+    return .001f + 2.f * std::exp( -( dx*dx + dy*dy ));
+}
+
+float _getCost( const PixelViewport& pvp )
+{
+    float cost = 0.f;
+    for( int32_t y = pvp.y; y < pvp.y + pvp.h; y += 4 )
+        for( int32_t x = pvp.x; x < pvp.x + pvp.w; x += 4 )
+            cost += _getCost( x, y );
+    return cost;
+}
+
+// greedy pull: each tile goes to the first worker becoming idle
+float _simulate( const PixelViewports& tiles, float& total )
+{
+    std::vector< float > workers( NWORKERS, 0.f );
+    total = 0.f;
+    for( PixelViewports::const_iterator i = tiles.begin(); i != tiles.end();
+         ++i )
+    {
+        const float cost = _getCost( *i );
+        std::vector< float >::iterator worker =
+            std::min_element( workers.begin(), workers.end( ));
+        *worker += cost;
+        total += cost;
+    }
+    return *std::max_element( workers.begin(), workers.end( ));
+}
+
+PixelViewports _generate( const Vector2i& dim )
+{
+    std::vector< Vector2i > tiles;
+    eq::server::tiles::ZigzagStrategy()( tiles, dim );
+
+    PixelViewports pvps;
+    for( std::vector< Vector2i >::const_iterator i = tiles.begin();
+         i != tiles.end(); ++i )
+    {
+        PixelViewport pvp( i->x() * TILESIZE, i->y() * TILESIZE,
+                           TILESIZE, TILESIZE );
+        pvp.w = std::min( pvp.w, WIDTH - pvp.x );
+        pvp.h = std::min( pvp.h, HEIGHT - pvp.y );
+        pvps.push_back( pvp );
+    }
+    return pvps;
+}
+
+void _testCoverage( const PixelViewports& tiles )
+{
+    std::vector< uint8_t > covered( WIDTH * HEIGHT, 0 );
+    for( PixelViewports::const_iterator i = tiles.begin(); i != tiles.end();
+         ++i )
+    {
+        for( int32_t y = i->y; y < i->y + i->h; ++y )
+            for( int32_t x = i->x; x < i->x + i->w; ++x )
+                ++covered[ y * WIDTH + x ];
+    }
+    for( size_t i = 0; i < covered.size(); ++i )
+        TESTINFO( covered[i] == 1, "pixel " << i << " covered " <<
+                  int( covered[i] ) << " times" );
+}
+}
+
+int main( int argc, char **argv )
+{
+    const Vector2i dim( (WIDTH + TILESIZE - 1) / TILESIZE,
+                        (HEIGHT + TILESIZE - 1) / TILESIZE );
+
+    // frame 1: no costs known, regular zigzag order
+    const PixelViewports zigzag = _generate( dim );
+    float total = 0.f;
+    const float zigzagTime = _simulate( zigzag, total );
+
+    // feed back the measured costs per grid tile
+    std::vector< float > costs( dim.x() * dim.y(), 0.f );
+    for( PixelViewports::const_iterator i = zigzag.begin(); i != zigzag.end();
+         ++i )
+    {
+        costs[ i->y / TILESIZE * dim.x() + i->x / TILESIZE ] = _getCost( *i );
+    }
+
+    // frame 2: unknown costs leave the order untouched
+    PixelViewports unchanged = _generate( dim );
+    const std::vector< float > noCosts;
+    eq::server::tiles::CostStrategy noCostStrategy( noCosts );
+    noCostStrategy( unchanged, dim, Vector2i( TILESIZE, TILESIZE ));
+    TEST( unchanged == zigzag );
+
+    // frame 2: cost-ordered with splitting of expensive tiles
+    PixelViewports costOrdered = _generate( dim );
+    eq::server::tiles::CostStrategy costStrategy( costs );
+    costStrategy( costOrdered, dim, Vector2i( TILESIZE, TILESIZE ));
+
+    TEST( costOrdered.size() > zigzag.size( ));
+    _testCoverage( costOrdered );
+
+    const float costTime = _simulate( costOrdered, total );
+    const float optimum = total / float( NWORKERS );
+
+    std::cout << NWORKERS << " workers, " << zigzag.size() << " tiles: "
+              << "zigzag " << zigzagTime << " (tail " << zigzagTime - optimum
+              << "), cost " << costOrdered.size() << " tiles " << costTime
+              << " (tail " << costTime - optimum << "), optimum " << optimum
+              << std::endl;
+
+    TEST( costTime <= zigzagTime );
+    return EXIT_SUCCESS;
+}
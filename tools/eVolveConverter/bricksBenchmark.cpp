@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2012, Stefan Eilemann <eile@eyescale.ch>
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 2.1 as published
+ * by the Free Software Foundation.
+ *  
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ * details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ 
+ */
+
+// Measures the throughput of assembling depth slabs, as used by eVolve for
+// each DB range, from a bricked volume with a cold and a warm brick cache.
+
+#include <brickCache.h>
+
+#include <lunchbox/clock.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "eVolveConverter.h"
+
+namespace eVolve
+{
+namespace
+{
+uint32_t _getPow2( const uint32_t value )
+{
+    uint32_t pow2 = 1;
+    while( pow2 < value )
+        pow2 <<= 1;
+    return pow2;
+}
+
+// Assembles the volume in nSlabs depth slabs, returns the time in ms
+float _assemble( BrickCache& cache, const uint32_t nSlabs )
+{
+    const BrickHeader& header = cache.getHeader();
+    const uint32_t tW = _getPow2( header.w );
+    const uint32_t tH = _getPow2( header.h );
+    const uint32_t depth = ( header.d + nSlabs - 1 ) / nSlabs;
+    std::vector< uint8_t > data;
+
+    lunchbox::Clock clock;
+    for( uint32_t start = 0; start < header.d; start += depth )
+    {
+        const uint32_t slabDepth = LB_MIN( depth, header.d - start );
+        data.assign( size_t( tW ) * tH * _getPow2( slabDepth ) * header.bytes,
+                     0 );
+        cache.readSlab( start, slabDepth, tW, tH, &data[0] );
+    }
+    return clock.getTimef();
+}
+
+// Assembles the volume in nSlabs depth slabs using row-wise reads from the
+// raw volume, as eVolve does without a bricked volume
+float _read( const std::string& filename, const BrickHeader& header,
+             const uint32_t nSlabs )
+{
+    std::ifstream file( filename.c_str(), std::ifstream::in |
+                                          std::ifstream::binary );
+    if( !file.is_open( ))
+        return 0.f;
+
+    const uint32_t tW = _getPow2( header.w );
+    const uint32_t tH = _getPow2( header.h );
+    const uint32_t depth = ( header.d + nSlabs - 1 ) / nSlabs;
+    const size_t rowSize = size_t( header.w ) * header.bytes;
+    std::vector< char > data;
+
+    lunchbox::Clock clock;
+    for( uint32_t start = 0; start < header.d; start += depth )
+    {
+        const uint32_t slabDepth = LB_MIN( depth, header.d - start );
+        data.assign( size_t( tW ) * tH * _getPow2( slabDepth ) * header.bytes,
+                     0 );
+        for( uint32_t z = 0; z < slabDepth; ++z )
+            for( uint32_t y = 0; y < header.h; ++y )
+                file.read( &data[ ( size_t( z ) * tH + y ) * tW *
+                                  header.bytes ], rowSize );
+    }
+    return clock.getTimef();
+}
+}
+
+int RawConverter::BenchmarkBricks( const std::string& src )
+{
+    static const size_t cacheSize = 512 * LB_1MB;
+    BrickCachePtr cache = new BrickCache( src, cacheSize );
+    if( !cache->isValid( ))
+    {
+        std::cerr << "Can't open bricked volume " << src << std::endl;
+        return 1;
+    }
+
+    const BrickHeader header = cache->getHeader();
+    const float volumeSize = float( header.w ) * header.h * header.d *
+                             header.bytes / LB_1MB;
+    const std::string rawName = src.substr( 0, src.rfind( ".bricks" ));
+
+    std::cout << src << ": " << header.w << "x" << header.h << "x" << header.d
+              << "x" << header.bytes << ", " << volumeSize << " MB"
+              << std::endl;
+
+    for( uint32_t nSlabs = 1; nSlabs <= 16 && nSlabs <= header.d;
+         nSlabs <<= 1 )
+    {
+        cache = new BrickCache( src, cacheSize );
+        const float cold = _assemble( *cache, nSlabs );
+        const float warm = _assemble( *cache, nSlabs );
+        const float rows = _read( rawName, header, nSlabs );
+
+        std::cout << nSlabs << " slabs: " << volumeSize * 1000.f / cold
+                  << " MB/s cold, " << volumeSize * 1000.f / warm
+                  << " MB/s warm cache, ";
+        if( rows > 0.f )
+            std::cout << volumeSize * 1000.f / rows << " MB/s row-wise reads";
+        else
+            std::cout << "no raw volume for row-wise reads";
+        std::cout << ", " << cache->getHits() << " hits, "
+                  << cache->getMisses() << " misses" << std::endl;
+    }
+    return 0;
+}
+}
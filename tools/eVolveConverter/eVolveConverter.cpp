@@ -18,7 +18,10 @@
 
 #include "ddsbase.h"
 
+#include <brickFile.h>
+
 #include <math.h>
+#include <string.h>
 #ifndef _MSC_VER
 #  include <stdint.h>
 #endif
@@ -32,6 +35,8 @@
 #include "eVolveConverter.h"
 #include "hlp.h"
 
+#include <lunchbox/clock.h>
+
 
 int main( int argc, char** argv )
 {
@@ -99,6 +104,13 @@ int RawConverter::parseArguments( int argc, char** argv )
         TCLAP::SwitchArg pvmArg( 
             "p", "pvm", "pvm[+sav] -> raw+derivatives+vhf", command, false );
 
+        TCLAP::SwitchArg brkArg(
+            "b", "bricks", "raw[+derivatives] -> bricked raw", command, false );
+
+        TCLAP::SwitchArg bnchArg(
+            "t", "benchmark", "benchmark slab assembly from bricked raw "
+            "(dst is ignored)", command, false );
+
         TCLAP::ValueArg<string> dstArg(
             "d", "dst", "destination file",
             true, "Bucky32x32x32_d.raw"  , "string", command );
@@ -135,6 +147,13 @@ int RawConverter::parseArguments( int argc, char** argv )
             return RawConverter::CompareTwoRawDerVhf( 
                         srcArg.getValue( ), dstArg.getValue( ));
 
+        if( brkArg.isSet() ) // raw -> bricked raw
+            return RawConverter::RawToBricksConverter(
+                        srcArg.getValue( ), dstArg.getValue( ));
+
+        if( bnchArg.isSet() ) // bricked raw slab assembly throughput
+            return RawConverter::BenchmarkBricks( srcArg.getValue( ));
+
         if( recArg.isSet() ) // recalculate derivatives
             return RawConverter::RecalculateDerivatives( 
                         srcArg.getValue( ), dstArg.getValue( ));
@@ -190,6 +209,41 @@ static void getPredefinedHeaderParameters
 static void CreateTransferFunc( int t, unsigned char *transfer );
 
 
+namespace
+{
+/** Reads consecutive slices of the 8-bit volume used for derivatives. */
+class SliceReader
+{
+public:
+    /** Read the slices from a volume in memory. */
+    SliceReader( const unsigned char* volume, const size_t sliceSize )
+        : _volume( volume ), _file( 0 ), _sliceSize( sliceSize )
+        , _components( 1 ) {}
+
+    /** Read the slices from a raw (1 component) or raw+der (4) file. */
+    SliceReader( ifstream& file, const size_t sliceSize,
+                 const unsigned components )
+        : _volume( 0 ), _file( &file ), _sliceSize( sliceSize )
+        , _components( components ) {}
+
+    /** Read the next nSlices slices, missing data is set to zero. */
+    void read( unsigned char* slices, const unsigned nSlices );
+
+private:
+    const unsigned char* _volume;
+    ifstream* _file;
+    const size_t _sliceSize;
+    const unsigned _components;
+    vector<unsigned char> _buffer;
+};
+}
+
+static int calculateAndSaveDerivatives( const string& dst,
+                                        SliceReader& reader,
+                                        const unsigned w,
+                                        const unsigned h,
+                                        const unsigned d  );
+
 static int calculateAndSaveDerivatives( const string& dst,
                                         unsigned char *volume,
                                         const unsigned w,
@@ -338,6 +392,96 @@ static int writeVHF( const string&  filename,
     return 0;
 }
 
+int RawConverter::RawToBricksConverter( const string& src,
+                                        const string& dst )
+{
+    unsigned w, h, d;
+//read header
+    {
+        string configFileName = src;
+        hFile info( fopen( configFileName.append( ".vhf" ).c_str(), "rb" ) );
+        FILE* file = info.f;
+
+        if( file==NULL ) return lFailed( "Can't open header file" );
+
+        readDimensionsFromSav( file, w, h, d );
+    }
+
+    const size_t fNameLen = src.length();
+    const unsigned bytes =
+        ( fNameLen >= 6 && src.substr( fNameLen-6, 6 ) == "_d.raw" ) ? 4 : 1;
+
+    LBWARN << "Bricking model: " << src << " " << w << " x " << h << " x "
+           << d << " x " << bytes << endl;
+
+    const unsigned size = BRICK_SIZE;
+    const unsigned nX = ( w + size - 1 ) / size;
+    const unsigned nY = ( h + size - 1 ) / size;
+    const unsigned nZ = ( d + size - 1 ) / size;
+
+    ifstream in( src.c_str(), ifstream::in | ifstream::binary );
+    if( !in.is_open() )
+        return lFailed( "Can't open volume file" );
+
+    ofstream out( dst.c_str(), ofstream::out | ofstream::binary |
+                               ofstream::trunc );
+    if( !out.is_open() )
+        return lFailed( "Can't open destination volume file" );
+
+//write header, padded to the page-aligned brick data
+    {
+        BrickHeader header;
+        memcpy( header.magic, BRICK_MAGIC, sizeof( BRICK_MAGIC ));
+        header.version   = BRICK_VERSION;
+        header.w         = w;
+        header.h         = h;
+        header.d         = d;
+        header.bytes     = bytes;
+        header.brickSize = size;
+
+        vector<char> page( BRICK_DATA_OFFSET, 0 );
+        memcpy( &page[0], &header, sizeof( header ));
+        out.write( &page[0], page.size() );
+    }
+
+//read one layer of bricks at a time and write its bricks
+    const size_t sliceSize = size_t( w ) * h * bytes;
+    vector<char> slab( sliceSize * size );
+    vector<char> brick( size_t( size ) * size * size * bytes );
+
+    for( unsigned bz = 0; bz < nZ; ++bz )
+    {
+        const unsigned depth = min( size, d - bz*size );
+        if( !in.read( &slab[0], sliceSize * depth ))
+            return lFailed( "Can't read volume file" );
+
+        for( unsigned by = 0; by < nY; ++by )
+        {
+            const unsigned height = min( size, h - by*size );
+            for( unsigned bx = 0; bx < nX; ++bx )
+            {
+                const size_t width = min( size, w - bx*size ) * bytes;
+                memset( &brick[0], 0, brick.size() );
+
+                for( unsigned z = 0; z < depth; ++z )
+                    for( unsigned y = 0; y < height; ++y )
+                        memcpy( &brick[ (( z*size + y )*size )*bytes ],
+                                &slab[ z*sliceSize +
+                                       ( size_t( by*size + y )*w +
+                                         bx*size )*bytes ],
+                                width );
+
+                out.write( &brick[0], brick.size() );
+            }
+        }
+    }
+
+    if( !out.good() )
+        return lFailed( "Can't write destination volume file" );
+    return 0;
+}
+
+
 int RawConverter::CompareTwoRawDerVhf( const string& src1,
                                        const string& src2 )
 {
@@ -478,30 +622,17 @@ int RawConverter::RawToRawPlusDerivativesConverter( const string& src,
     LBWARN << "Creating derivatives for raw model: " 
            << src << " " << w << " x " << h << " x " << d << endl;
 
-//read model
-    vector<unsigned char> volume( w*h*d, 0 );
-
-    LBWARN << "Reading model" << endl;
+//calculate and save derivatives, streaming the model
+    if( src == dst )
+        return lFailed( "Source and destination must be different files" );
     {
-        ifstream file( src.c_str(), 
-                       ifstream::in | ifstream::binary | ifstream::ate );
+        ifstream file( src.c_str(), ifstream::in | ifstream::binary );
 
         if( !file.is_open() )
             return lFailed( "Can't open volume file" );
 
-        ifstream::pos_type size;
-
-        size = min( (int)file.tellg(), (int)volume.size() );
-
-        file.seekg( 0, ios::beg );
-        file.read( (char*)( &volume[0] ), size );
-
-        file.close();
-    }
-    
-//calculate and save derivatives
-    {
-        int result = calculateAndSaveDerivatives( dst, &volume[0], w,  h, d );
+        SliceReader reader( file, size_t( w )*h, 1 );
+        int result = calculateAndSaveDerivatives( dst, reader, w, h, d );
 
         if( result ) return result;
     }
@@ -527,42 +658,17 @@ int RawConverter::RecalculateDerivatives( const string& src,
     LBWARN << "Creating derivatives for raw model: " 
            << src << " " << w << " x " << h << " x " << d << endl;
 
-//read model    
-    vector<unsigned char> volume( w*h*d*4, 0 );
-
-    LBWARN << "Reading model" << endl;
+//calculate and save derivatives, streaming the model
+    if( src == dst )
+        return lFailed( "Source and destination must be different files" );
     {
-        ifstream file( src.c_str(),
-                       ifstream::in | ifstream::binary | ifstream::ate );
+        ifstream file( src.c_str(), ifstream::in | ifstream::binary );
 
         if( !file.is_open() )
             return lFailed( "Can't open volume file" );
 
-        ifstream::pos_type size;
-
-        size = min( (int)file.tellg(), (int)volume.size() );
-
-        file.seekg( 0, ios::beg );
-        file.read( (char*)( &volume[0] ), size );
-
-        file.close();
-    }
-//remove derivatives
-    {
-        unsigned char* sr = &volume[3];
-        unsigned char* ds = &volume[0];
-        for( unsigned i = 3; i < w*h*d*4; i+=4 )
-        {
-            *ds = *sr;
-            sr += 4;
-            ++ds;
-        }
-        volume.resize( w*h*d );
-    }
-
-//calculate and save derivatives
-    {
-        int result = calculateAndSaveDerivatives( dst, &volume[0], w, h, d );
+        SliceReader reader( file, size_t( w )*h, 4 );
+        int result = calculateAndSaveDerivatives( dst, reader, w, h, d );
 
         if( result ) return result;
     }
@@ -947,11 +1053,130 @@ int RawConverter::ScaleRawDerFile(                  const string& src,
 }
 
 
+void SliceReader::read( unsigned char* slices, const unsigned nSlices )
+{
+    const size_t size = _sliceSize * nSlices;
+    if( _volume )
+    {
+        memcpy( slices, _volume, size );
+        _volume += size;
+        return;
+    }
+
+    if( _components == 1 )
+    {
+        _file->read( (char*)( slices ), size );
+        const size_t nRead = _file->gcount();
+        memset( slices + nRead, 0, size - nRead );
+        return;
+    }
+
+    // keep the alpha of each raw+derivatives voxel
+    _buffer.resize( size * _components );
+    _file->read( (char*)( &_buffer[0] ), _buffer.size() );
+    const size_t nRead = _file->gcount();
+    memset( &_buffer[nRead], 0, _buffer.size() - nRead );
+
+    const unsigned char* src = &_buffer[ _components-1 ];
+    for( size_t i = 0; i < size; ++i, src += _components )
+        slices[i] = *src;
+}
+
+
 static int calculateAndSaveDerivatives( const string& dst, 
                                         unsigned char *volume,
                                         const unsigned w,
                                         const unsigned h,
                                         const unsigned d  )
+{
+    SliceReader reader( volume, size_t( w )*h );
+    return calculateAndSaveDerivatives( dst, reader, w, h, d );
+}
+
+
+/** Computes the gradients and alpha of the voxels 1..w-2 of one row. */
+static void calculateRowDerivatives( const unsigned char* curPy,
+                                     const int wh,
+                                     const int ws,
+                                     const unsigned w,
+                                     int* gxRow, int* gyRow, int* gzRow,
+                                     unsigned char* GxGyGzA )
+{
+    // integer Sobel sums in one loop per component, so that the compiler can
+    // vectorize them without too many aliasing checks
+    for( unsigned x=1; x<w-1; x++ )
+    {
+        const unsigned char * curP = curPy +  x;
+        const unsigned char * prvP = curP  - wh;
+        const unsigned char * nxtP = curP  + wh;
+        gxRow[x] = 
+              nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
+            3*nxtP[     1 ]+ 6*curP[     1 ]+ 3*prvP[     1 ]+
+              nxtP[ -ws+1 ]+ 3*curP[ -ws+1 ]+   prvP[ -ws+1 ]-
+
+              nxtP[  ws-1 ]- 3*curP[  ws-1 ]-   prvP[  ws-1 ]-
+            3*nxtP[    -1 ]- 6*curP[    -1 ]- 3*prvP[    -1 ]-
+              nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
+    }
+
+    for( unsigned x=1; x<w-1; x++ )
+    {
+        const unsigned char * curP = curPy +  x;
+        const unsigned char * prvP = curP  - wh;
+        const unsigned char * nxtP = curP  + wh;
+        gyRow[x] = 
+              nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
+            3*nxtP[  ws   ]+ 6*curP[  ws   ]+ 3*prvP[  ws   ]+
+              nxtP[  ws-1 ]+ 3*curP[  ws-1 ]+   prvP[  ws-1 ]-
+
+              nxtP[ -ws+1 ]- 3*curP[ -ws+1 ]-   prvP[ -ws+1 ]-
+            3*nxtP[ -ws   ]- 6*curP[ -ws   ]- 3*prvP[ -ws   ]-
+              nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
+    }
+
+    for( unsigned x=1; x<w-1; x++ )
+    {
+        const unsigned char * nxtP = curPy + x + wh;
+        const unsigned char * prvP = curPy + x - wh;
+        gzRow[x] = 
+              nxtP[  ws+1 ]+ 3*nxtP[    1 ]+   nxtP[ -ws+1 ]+
+            3*nxtP[  ws   ]+ 6*nxtP[    0 ]+ 3*nxtP[ -ws   ]+
+              nxtP[  ws-1 ]+ 3*nxtP[   -1 ]+   nxtP[ -ws-1 ]-
+
+              prvP[  ws+1 ]- 3*prvP[    1 ]-   prvP[ -ws+1 ]-
+            3*prvP[  ws   ]- 6*prvP[    0 ]- 3*prvP[ -ws   ]-
+              prvP[  ws-1 ]- 3*prvP[   -1 ]-   prvP[ -ws-1 ];
+    }
+
+    // normalization; the quotients are small enough for the double division
+    // to truncate exactly like the integer division
+    for( unsigned x=1; x<w-1; x++ )
+    {
+        const int gx = gxRow[x];
+        const int gy = gyRow[x];
+        const int gz = gzRow[x];
+        const double length = double( static_cast<int>(
+                                    sqrt(double((gx*gx+gy*gy+gz*gz))+1)));
+
+        GxGyGzA[x*4   ] = static_cast<unsigned char>(
+                            ( static_cast<int>( gx*255/length ) + 255 )/2 );
+        GxGyGzA[x*4 +1] = static_cast<unsigned char>(
+                            ( static_cast<int>( gy*255/length ) + 255 )/2 );
+        GxGyGzA[x*4 +2] = static_cast<unsigned char>(
+                            ( static_cast<int>( gz*255/length ) + 255 )/2 );
+        GxGyGzA[x*4 +3] = curPy[x];
+    }
+}
+
+
+/** Input bytes of a slab of slices processed at once */
+#define SLAB_SIZE ( 64 * 1024 * 1024 )
+
+static int calculateAndSaveDerivatives( const string& dst,
+                                        SliceReader& reader,
+                                        const unsigned w,
+                                        const unsigned h,
+                                        const unsigned d  )
 {
     LBWARN << "Calculating derivatives" << endl;
     ofstream file ( dst.c_str(),
@@ -960,76 +1185,68 @@ static int calculateAndSaveDerivatives( const string& dst,
     if( !file.is_open() )
         return lFailed( "Can't open destination volume file" );
 
-    const int wh = w*h;
+    const size_t wh = size_t( w )*h;
+    const unsigned slabDepth = min( d, max( 1u, unsigned( SLAB_SIZE / wh )));
 
-    const int ws = static_cast<int>( w );
+    // slices z0-1 .. z0+slabDepth of the current slab, slot 0 is slice z0-1
+    vector<unsigned char> slices( wh*( slabDepth+2 ), 0 );
+    vector<unsigned char> GxGyGzA( wh*slabDepth*4 );
+    unsigned next = 0; // next slice to read
 
-    vector<unsigned char> GxGyGzA( wh*d*4, 0 );
-
-    for( unsigned z=1; z<d-1; z++ )
+    for( unsigned z0 = 0; z0 < d; z0 += slabDepth )
     {
-        const int zwh = z*wh;
+        const unsigned z1 = min( d, z0 + slabDepth );
+        lunchbox::Clock clock;
 
-        const unsigned char *curPz = &volume[0] + zwh;
+        // read up to the halo slice after the slab
+        const unsigned last = min( z1+1, d );
+        if( next < last )
+        {
+            reader.read( &slices[ ( next-z0+1 )*wh ], last-next );
+            next = last;
+        }
+        const float readTime = clock.getTimef();
+        clock.reset();
 
-        for( unsigned y=1; y<h-1; y++ )
+        const ssize_t nRows = ssize_t( z1-z0 )*h;
+#pragma omp parallel
         {
-            const int zwh_y = zwh + y*w;
-            const unsigned char * curPy = curPz + y*w;
-            for( unsigned x=1; x<w-1; x++ )
+            vector<int> gx( w ), gy( w ), gz( w );
+
+#pragma omp for
+            for( ssize_t i = 0; i < nRows; ++i )
             {
-                const unsigned char * curP = curPy +  x;
-                const unsigned char * prvP = curP  - wh;
-                const unsigned char * nxtP = curP  + wh;
-                int gx = 
-                      nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
-                    3*nxtP[     1 ]+ 6*curP[     1 ]+ 3*prvP[     1 ]+
-                      nxtP[ -ws+1 ]+ 3*curP[ -ws+1 ]+   prvP[ -ws+1 ]-
-
-                      nxtP[  ws-1 ]- 3*curP[  ws-1 ]-   prvP[  ws-1 ]-
-                    3*nxtP[    -1 ]- 6*curP[    -1 ]- 3*prvP[    -1 ]-
-                      nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
-
-                int gy = 
-                      nxtP[  ws+1 ]+ 3*curP[  ws+1 ]+   prvP[  ws+1 ]+
-                    3*nxtP[  ws   ]+ 6*curP[  ws   ]+ 3*prvP[  ws   ]+
-                      nxtP[  ws-1 ]+ 3*curP[  ws-1 ]+   prvP[  ws-1 ]-
-
-                      nxtP[ -ws+1 ]- 3*curP[ -ws+1 ]-   prvP[ -ws+1 ]-
-                    3*nxtP[ -ws   ]- 6*curP[ -ws   ]- 3*prvP[ -ws   ]-
-                      nxtP[ -ws-1 ]- 3*curP[ -ws-1 ]-   prvP[ -ws-1 ];
-
-                int gz = 
-                      nxtP[  ws+1 ]+ 3*nxtP[    1 ]+   nxtP[ -ws+1 ]+
-                    3*nxtP[  ws   ]+ 6*nxtP[    0 ]+ 3*nxtP[ -ws   ]+
-                      nxtP[  ws-1 ]+ 3*nxtP[   -1 ]+   nxtP[ -ws-1 ]-
-
-                      prvP[  ws+1 ]- 3*prvP[    1 ]-   prvP[ -ws+1 ]-
-                    3*prvP[  ws   ]- 6*prvP[    0 ]- 3*prvP[ -ws   ]-
-                      prvP[  ws-1 ]- 3*prvP[   -1 ]-   prvP[ -ws-1 ];
-
-                int length = static_cast<int>(
-                                        sqrt(double((gx*gx+gy*gy+gz*gz))+1));
-
-                gx = ( gx*255/length + 255 )/2; 
-                gy = ( gy*255/length + 255 )/2;
-                gz = ( gz*255/length + 255 )/2;
-
-                GxGyGzA[(zwh_y + x)*4   ] = static_cast<unsigned char>( gx );
-                GxGyGzA[(zwh_y + x)*4 +1] = static_cast<unsigned char>( gy );
-                GxGyGzA[(zwh_y + x)*4 +2] = static_cast<unsigned char>( gz );
-                GxGyGzA[(zwh_y + x)*4 +3] = curP[0];
+                const unsigned z = z0 + unsigned( i / h );
+                const unsigned y = unsigned( i % h );
+                unsigned char* out = &GxGyGzA[ i*w*4 ];
+
+                // the border voxels have no derivatives
+                memset( out, 0, w*4 );
+                if( z==0 || z>=d-1 || y==0 || y>=h-1 || w<3 )
+                    continue;
+
+                const unsigned char* curPy = &slices[ ( z-z0+1 )*wh + y*w ];
+                calculateRowDerivatives( curPy, int( wh ), int( w ), w,
+                                         &gx[0], &gy[0], &gz[0], out );
             }
         }
-    }
+        const float calcTime = clock.getTimef();
+        clock.reset();
 
-    LBWARN << "Writing derivatives: " 
-           << dst.c_str() << " " << GxGyGzA.size() << " bytes" <<endl;
+        file.write( (char*)( &GxGyGzA[0] ), size_t( z1-z0 )*wh*4 );
+        if( !file.good() )
+            return lFailed( "Can't write destination volume file" );
 
-    file.write( (char*)( &GxGyGzA[0] ), GxGyGzA.size() );
+        LBWARN << "Slices " << z0 << ".." << z1-1 << ": read " << readTime
+               << " ms, derivatives " << calcTime << " ms, write "
+               << clock.getTimef() << " ms" << endl;
 
-    file.close();
+        // keep the last slice of the slab and the halo for the next slab
+        if( z1 < d )
+            memmove( &slices[0], &slices[ ( z1-z0 )*wh ], 2*wh );
+    }
 
+    file.close();
     return 0;
 }
 
@@ -37,6 +37,11 @@ namespace eVolve
                                                            double scaleY,
                                                            double scaleZ  );
 
+        static int RawToBricksConverter(             const string& src,
+                                                     const string& dst  );
+
+        static int BenchmarkBricks(                  const string& src  );
+
         static int parseArguments( int argc, char** argv );
     };
 }
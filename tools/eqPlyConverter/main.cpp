@@ -27,7 +27,18 @@
  */
 
 #include <eq/eq.h>
+#include <vertexBufferDist.h>
 #include <vertexBufferRoot.h>
+#include <vertexData.h>
+#include <lunchbox/rng.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#ifdef _OPENMP
+#  include <omp.h>
+#endif
 
 namespace
 {
@@ -44,27 +55,713 @@ static bool _isPlyfile( const std::string& filename )
     }
     return true;
 }
+
+/* Gives access to the serialized tree to compare parallel builds. */
+class Model : public mesh::VertexBufferRoot
+{
+public:
+    std::string serialize()
+    {
+        std::ostringstream os;
+        toStream( os );
+        return os.str();
+    }
+};
+
+/* Loads the given model, builds its kd-tree with 1..N threads and reports the
+   load throughput, the construction time for each run, the time to map the
+   written binary kd-tree and the size and vertex cache efficiency of the
+   plain and the optimized vertex data. The efficiency is simulated for the
+   LRU cache the optimizer targets. */
+static int _benchmark( const std::string& filename )
+{
+    mesh::VertexData data;
+    lunchbox::Clock clock;
+    if( !data.readPlyFile( filename ))
+    {
+        LBWARN << "Can't load model: " << filename << std::endl;
+        return EXIT_FAILURE;
+    }
+    const float loadTime = clock.getTimef();
+
+    lunchbox::MemoryMap file;
+    const float size = file.map( filename ) ? float( file.getSize( )) : 0.f;
+    std::cout << filename << ": loaded " << size / LB_1MB << " MB in "
+              << loadTime << " ms, " << size / LB_1MB / loadTime * 1000.f
+              << " MB/s" << std::endl;
+
+    data.calculateNormals();
+    data.scale( 2.0f );
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+#else
+    const int maxThreads = 1;
+#endif
+
+    std::vector< int > threads;
+    for( int nThreads = 1; nThreads < maxThreads; nThreads <<= 1 )
+        threads.push_back( nThreads );
+    threads.push_back( maxThreads );
+
+    std::string reference;
+    bool identical = true;
+    for( size_t i = 0; i < threads.size(); ++i )
+    {
+        const int nThreads = threads[i];
+#ifdef _OPENMP
+        omp_set_num_threads( nThreads );
+#endif
+        mesh::VertexData copy( data );
+        Model model;
+
+        clock.reset();
+        model.setupTree( copy );
+        const float time = clock.getTimef();
+
+        const std::string tree = model.serialize();
+        if( reference.empty( ))
+            reference = tree;
+        const bool same = ( tree == reference );
+        identical = identical && same;
+
+        std::cout << filename << ": " << data.triangles.size()
+                  << " triangles, kd-tree built with " << nThreads
+                  << " threads in " << time << " ms"
+                  << ( same ? "" : ", output differs" ) << std::endl;
+
+        if( i == threads.size() - 1 && !model.writeToFile( filename ))
+            return EXIT_FAILURE;
+    }
+
+    // the binary kd-tree is mapped, its data is paged in on first use
+    Model model;
+    clock.reset();
+    if( !model.readFromFile( filename ))
+        return EXIT_FAILURE;
+    const float mapTime = clock.getTimef();
+
+    const bool same = ( model.serialize() == reference );
+    identical = identical && same;
+    std::cout << filename << ": binary kd-tree mapped in " << mapTime << " ms"
+              << ( same ? "" : ", output differs" ) << std::endl;
+
+    // reorder the triangles for the vertex cache and quantize the vertices
+    mesh::VertexData copy( data );
+    Model optimized;
+    optimized.useOptimizedData();
+    clock.reset();
+    optimized.setupTree( copy );
+    const float optimizeTime = clock.getTimef();
+
+    const float nTriangles = float( data.triangles.size( ));
+    std::cout << filename << ": " << model.getDataSize() / nTriangles
+              << " bytes/triangle, ACMR "
+              << model.getACMR( mesh::VERTEX_CACHE_SIZE )
+              << ", optimized in " << optimizeTime << " ms to "
+              << optimized.getDataSize() / nTriangles
+              << " bytes/triangle, ACMR "
+              << optimized.getACMR( mesh::VERTEX_CACHE_SIZE )
+              << std::endl;
+
+    return identical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#define N_CLIENTS 16
+
+/* Maps a distributed model on one in-process client node. */
+class Client : public lunchbox::Thread
+{
+public:
+    Client( co::ConnectionDescriptionPtr serverDesc )
+        : model( 0 )
+    {
+        node = new co::LocalNode;
+        co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+        connDesc->type = co::CONNECTIONTYPE_TCPIP;
+        connDesc->setHostname( "localhost" );
+        node->addConnectionDescription( connDesc );
+        LBCHECK( node->listen( ));
+
+        server = new co::Node;
+        server->addConnectionDescription( serverDesc );
+        LBCHECK( node->connect( server ));
+    }
+
+    ~Client()
+    {
+        delete model;
+        node->disconnect( server );
+        node->close();
+    }
+
+    virtual void run()
+    {
+        model = dist.loadModel( server, node, id );
+        if( model )
+            dist.loadRange( server, node, eq::Range::ALL, 0 );
+    }
+
+    co::LocalNodePtr node;
+    co::NodePtr server;
+    eqPly::VertexBufferDist dist;
+    mesh::VertexBufferRoot* model;
+    eq::uint128_t id;
+};
+
+/* Distributes the given model to N_CLIENTS in-process client nodes and
+   reports the distribution time. */
+static int _distribute( const int argc, char** argv,
+                        const std::string& filename )
+{
+    mesh::VertexBufferRoot model;
+    if( !model.readFromFile( filename ))
+    {
+        LBWARN << "Can't load model: " << filename << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    co::init( argc, argv );
+
+    lunchbox::RNG rng;
+    co::LocalNodePtr server = new co::LocalNode;
+    co::ConnectionDescriptionPtr connDesc = new co::ConnectionDescription;
+    connDesc->type = co::CONNECTIONTYPE_TCPIP;
+    connDesc->port = (rng.get<uint16_t>() % 60000) + 1024;
+    connDesc->setHostname( "localhost" );
+    server->addConnectionDescription( connDesc );
+    LBCHECK( server->listen( ));
+
+    eqPly::VertexBufferDist dist( &model );
+    dist.registerTree( server );
+
+    std::vector< Client* > clients;
+    for( size_t i = 0; i < N_CLIENTS; ++i )
+    {
+        clients.push_back( new Client( connDesc ));
+        clients.back()->id = dist.getID();
+    }
+
+    lunchbox::Clock clock;
+    for( size_t i = 0; i < N_CLIENTS; ++i )
+        clients[i]->start();
+    for( size_t i = 0; i < N_CLIENTS; ++i )
+        clients[i]->join();
+    const float time = clock.getTimef();
+
+    bool result = true;
+    for( size_t i = 0; i < N_CLIENTS; ++i )
+    {
+        result = result && clients[i]->model;
+        delete clients[i];
+    }
+
+    std::cout << filename << ": distributed to " << N_CLIENTS << " clients in "
+              << time << " ms" << std::endl;
+
+    dist.deregisterTree();
+    server->close();
+    server = 0;
+    co::exit();
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#define CULL_SMALL_DEPTH 10 // levels stay below the culler's parallel size
+#define CULL_LARGE_DEPTH 20 // levels exceed the culler's parallel size
+#define CULL_MIN_THREADS 4  // exercise the parallel culling on any machine
+#define CULL_LOOPS 10
+
+/* Node of a synthetic kd-tree subdividing a box along its longest axis. */
+class SyntheticNode : public mesh::VertexBufferBase
+{
+public:
+    SyntheticNode( const mesh::BoundingBox& box, const size_t depth,
+                   const size_t firstLeaf, const size_t nLeaves )
+        : _left( 0 ), _right( 0 )
+    {
+        const mesh::Vertex center = ( box[0] + box[1] ) * .5f;
+        const mesh::Vertex extent = box[1] - box[0];
+        _boundingSphere = mesh::BoundingSphere( center.x(), center.y(),
+                                                center.z(),
+                                                extent.length() * .5f );
+
+        const size_t leaves = nLeaves >> depth;
+        _range[0] = float( firstLeaf ) / float( nLeaves );
+        _range[1] = float( firstLeaf + leaves ) / float( nLeaves );
+        if( leaves == 1 )
+            return;
+
+        const size_t axis = extent.x() >= extent.y() ?
+            ( extent.x() >= extent.z() ? 0 : 2 ) :
+            ( extent.y() >= extent.z() ? 1 : 2 );
+        mesh::BoundingBox left = box;
+        mesh::BoundingBox right = box;
+        left[1][ axis ] = center[ axis ];
+        right[0][ axis ] = center[ axis ];
+        _left = new SyntheticNode( left, depth + 1, firstLeaf, nLeaves );
+        _right = new SyntheticNode( right, depth + 1, firstLeaf + leaves / 2,
+                                    nLeaves );
+    }
+
+    virtual ~SyntheticNode() { delete _left; delete _right; }
+
+    virtual void draw( mesh::VertexBufferState& ) const {}
+    virtual mesh::Index getNumberOfVertices() const { return 0; }
+    virtual const mesh::VertexBufferBase* getLeft() const { return _left; }
+    virtual const mesh::VertexBufferBase* getRight() const { return _right; }
+    virtual const mesh::BoundingSphere& updateBoundingSphere()
+        { return _boundingSphere; }
+
+protected:
+    virtual void setupTree( mesh::VertexData&, const mesh::Index,
+                            const mesh::Index, const mesh::Axis,
+                            const size_t, mesh::VertexBufferData& ) {}
+    virtual void collectLeaves( std::vector< mesh::VertexBufferLeaf* >& ) {}
+    virtual void updateRange() {}
+
+private:
+    SyntheticNode* _left;
+    SyntheticNode* _right;
+};
+
+/* The depth-first traversal formerly used by VertexBufferRoot::cullDraw().
+   Counts the nodes tested on each level, which the flattened culler
+   classifies together. */
+static void _traverse( const mesh::VertexBufferBase* root,
+                       const mesh::Matrix4f& pmv, const mesh::Range& range,
+                       mesh::DrawList& drawList, std::vector< size_t >& levels )
+{
+    drawList.clear();
+    levels.clear();
+    vmml::frustum_culler< float > culler;
+    culler.setup( pmv );
+
+    std::vector< const mesh::VertexBufferBase* > candidates;
+    std::vector< size_t > depths;
+    candidates.push_back( root );
+    depths.push_back( 0 );
+    while( !candidates.empty( ))
+    {
+        const mesh::VertexBufferBase* node = candidates.back();
+        const size_t depth = depths.back();
+        candidates.pop_back();
+        depths.pop_back();
+
+        if( depth >= levels.size( ))
+            levels.resize( depth + 1, 0 );
+        ++levels[ depth ];
+
+        if( node->getRange()[0] >= range[1] || node->getRange()[1] < range[0] )
+            continue;
+
+        const vmml::Visibility visibility =
+            culler.test_sphere( node->getBoundingSphere( ));
+        if( visibility == vmml::VISIBILITY_NONE )
+            continue;
+        if( visibility == vmml::VISIBILITY_FULL &&
+            node->getRange()[0] >= range[0] && node->getRange()[1] < range[1] )
+        {
+            drawList.push_back( node );
+            continue;
+        }
+
+        const mesh::VertexBufferBase* left  = node->getLeft();
+        const mesh::VertexBufferBase* right = node->getRight();
+        if( !left && !right )
+        {
+            if( node->getRange()[0] >= range[0] )
+                drawList.push_back( node );
+            continue;
+        }
+        if( left )
+        {
+            candidates.push_back( left );
+            depths.push_back( depth + 1 );
+        }
+        if( right )
+        {
+            candidates.push_back( right );
+            depths.push_back( depth + 1 );
+        }
+    }
+}
+
+/* Culls a synthetic kd-tree of the given depth for a partially visible view
+   and a sort-last range, and reports the culled nodes per millisecond of
+   the depth-first traversal and of the flattened culler with 1..N threads.
+   @return true if all culling results match the traversal. */
+static bool _benchmarkCulling( const size_t depth )
+{
+    mesh::BoundingBox box;
+    box[0] = mesh::Vertex( -1.f, -1.f, -1.f );
+    box[1] = mesh::Vertex( 1.f, 1.f, 1.f );
+    const size_t nLeaves = size_t( 1 ) << depth;
+    const SyntheticNode root( box, 0, 0, nLeaves );
+
+    mesh::VertexBufferCuller culler;
+    lunchbox::Clock clock;
+    culler.setup( &root );
+    const float setupTime = clock.getTimef();
+    const float nNodes = float( culler.getNumberOfNodes( ));
+    std::cout << "Flattened synthetic kd-tree of " << nNodes << " nodes in "
+              << setupTime << " ms" << std::endl;
+
+    // camera inside the model, looking at a corner
+    const eq::Frustumf frustum( -.5f, .5f, -.4f, .4f, .5f, 10.f );
+    mesh::Matrix4f view = mesh::Matrix4f::IDENTITY;
+    view.set_translation( mesh::Vertex( -.3f, .2f, -1.2f ));
+    const mesh::Matrix4f pmv = frustum.compute_matrix() * view;
+
+    const float sortLast[2] = { .25f, .75f };
+    const mesh::Range range( sortLast );
+    mesh::DrawList reference;
+    std::vector< size_t > levels;
+    clock.reset();
+    for( size_t i = 0; i < CULL_LOOPS; ++i )
+        _traverse( &root, pmv, range, reference, levels );
+    const float traverseTime = clock.getTimef() / CULL_LOOPS;
+    std::cout << "Depth-first traversal: " << reference.size()
+              << " nodes to draw, " << nNodes / traverseTime << " nodes/ms"
+              << std::endl;
+
+    const size_t widest = *std::max_element( levels.begin(), levels.end( ));
+    const size_t parallelSize = mesh::VertexBufferCuller::getParallelSize();
+    std::cout << "Widest level of " << widest << " nodes, classified "
+              << ( widest > parallelSize ? "in parallel" : "serially" )
+              << " (parallel above " << parallelSize << " nodes)"
+              << std::endl;
+
+#ifdef _OPENMP
+    // oversubscribe small machines to test the parallel classification
+    const int defaultThreads = omp_get_max_threads();
+    const int maxThreads = LB_MAX( defaultThreads, CULL_MIN_THREADS );
+#else
+    const int maxThreads = 1;
+#endif
+
+    std::vector< int > threads;
+    for( int nThreads = 1; nThreads < maxThreads; nThreads <<= 1 )
+        threads.push_back( nThreads );
+    threads.push_back( maxThreads );
+
+    bool identical = true;
+    for( size_t i = 0; i < threads.size(); ++i )
+    {
+        const int nThreads = threads[i];
+#ifdef _OPENMP
+        omp_set_num_threads( nThreads );
+#endif
+        mesh::DrawList drawList;
+        clock.reset();
+        for( size_t j = 0; j < CULL_LOOPS; ++j )
+            culler.cull( pmv, range, true, drawList );
+        const float time = clock.getTimef() / CULL_LOOPS;
+
+        // the culler orders the nodes by level, the traversal depth-first
+        std::vector< const mesh::VertexBufferBase* > sorted( drawList );
+        std::vector< const mesh::VertexBufferBase* > expected( reference );
+        std::sort( sorted.begin(), sorted.end( ));
+        std::sort( expected.begin(), expected.end( ));
+        const bool same = ( sorted == expected );
+        identical = identical && same;
+
+        std::cout << "Flattened culling with " << nThreads << " threads: "
+                  << drawList.size() << " nodes to draw, " << nNodes / time
+                  << " nodes/ms" << ( same ? "" : ", output differs" )
+                  << std::endl;
+    }
+#ifdef _OPENMP
+    omp_set_num_threads( defaultThreads );
+#endif
+
+    return identical;
+}
+
+/* Benchmarks culling with the serial and the parallel classification. */
+static int _benchmarkCulling()
+{
+    const bool small = _benchmarkCulling( CULL_SMALL_DEPTH );
+    const bool large = _benchmarkCulling( CULL_LARGE_DEPTH );
+    return small && large ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Estimated peak memory used to convert one byte of a PLY file */
+#define MEMORY_FACTOR 6
+
+/* FNV-1a hash of a file's content, zero if it can't be read. */
+static uint64_t _hashFile( const std::string& filename )
+{
+    lunchbox::MemoryMap file;
+    const uint8_t* bytes = static_cast< const uint8_t* >( file.map( filename ));
+    if( !bytes )
+        return 0;
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const size_t size = file.getSize();
+    for( size_t i = 0; i < size; ++i )
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/* Name of the file recording the PLY size, time stamp and content hash of a
+   binary kd-tree. */
+static std::string _getHashFilename( const std::string& filename )
+{
+    return mesh::getArchitectureFilename( filename ) + ".hash";
+}
+
+/* Converts a batch of models concurrently within a memory budget. */
+class Batch
+{
+public:
+    Batch( const uint64_t budget, const bool force, const bool optimize )
+        : _budget( budget ), _force( force ), _optimize( optimize )
+        , _used( 0 ), _next( 0 )
+        , _nConverted( 0 ), _nSkipped( 0 ), _nFailed( 0 ), _bytes( 0 ) {}
+
+    void add( const std::string& filename )
+    {
+        struct stat info;
+        if( ::stat( filename.c_str(), &info ) != 0 )
+        {
+            LBWARN << "Can't access model: " << filename << std::endl;
+            ++_nFailed;
+            return;
+        }
+        _files.push_back( File( filename, info.st_size, info.st_mtime ));
+    }
+
+    /* Converts all models using nThreads workers. */
+    bool run( const size_t nThreads )
+    {
+        // start with the largest models, the small ones fill the gaps
+        std::sort( _files.begin(), _files.end( ));
+
+        lunchbox::Clock clock;
+        std::vector< Worker* > workers;
+        for( size_t i = 0; i < nThreads; ++i )
+        {
+            workers.push_back( new Worker( *this, nThreads ));
+            workers.back()->start();
+        }
+
+        for( size_t i = 0; i < nThreads; ++i )
+        {
+            workers[i]->join();
+            delete workers[i];
+        }
+        const float time = clock.getTimef();
+        const float size = float( _bytes ) / LB_1MB;
+
+        std::cout << "Converted " << _nConverted << " models (" << size
+                  << " MB) in " << time << " ms, " << size / time * 1000.f
+                  << " MB/s, " << _nSkipped << " up to date, " << _nFailed
+                  << " failed" << std::endl;
+        return _nFailed == 0;
+    }
+
+private:
+    struct File
+    {
+        File( const std::string& name_, const uint64_t size_,
+              const time_t time_ )
+            : name( name_ ), size( size_ ), time( time_ ), hash( 0 ) {}
+
+        bool operator < ( const File& rhs ) const { return size > rhs.size; }
+
+        std::string name;
+        uint64_t size;
+        time_t time;
+        uint64_t hash; // of the content, computed only when needed
+    };
+
+    class Worker : public lunchbox::Thread
+    {
+    public:
+        Worker( Batch& batch, const size_t nWorkers )
+            : _batch( batch ), _nWorkers( nWorkers ) {}
+
+        virtual void run()
+        {
+#ifdef _OPENMP
+            // share the processors between the concurrent kd-tree builds
+            omp_set_num_threads( LB_MAX( 1, omp_get_num_procs() /
+                                            int( _nWorkers )));
+#endif
+            File* file = _batch._pop();
+            while( file )
+            {
+                _batch._convert( *file );
+                file = _batch._pop();
+            }
+        }
+
+    private:
+        Batch& _batch;
+        const size_t _nWorkers;
+    };
+
+    std::vector< File > _files;
+    const uint64_t _budget;
+    const bool _force;
+    const bool _optimize;
+
+    lunchbox::Monitor< uint64_t > _used; // memory used by the conversions
+    lunchbox::Lock _reserve;             // serializes waiting for memory
+
+    lunchbox::Lock _lock; // protects the members below
+    size_t _next;         // next file to convert
+    size_t _nConverted;
+    size_t _nSkipped;
+    size_t _nFailed;
+    uint64_t _bytes;     // size of the converted PLY files
+
+    File* _pop()
+    {
+        lunchbox::ScopedMutex<> mutex( _lock );
+        return _next < _files.size() ? &_files[ _next++ ] : 0;
+    }
+
+    /* @return true if the binary kd-tree was built from the PLY file. The
+       content is hashed only if its size matches the recorded one but its
+       time stamp does not. Without a record, the time stamps are compared. */
+    bool _isUpToDate( File& file ) const
+    {
+        struct stat info;
+        const std::string cache = mesh::getArchitectureFilename( file.name );
+        if( ::stat( cache.c_str(), &info ) != 0 || info.st_size == 0 )
+            return false;
+
+        std::ifstream hashFile( _getHashFilename( file.name ).c_str( ));
+        uint64_t size = 0;
+        int64_t time = 0;
+        uint64_t hash = 0;
+        if( !( hashFile >> size >> time >> std::hex >> hash ))
+            return info.st_mtime >= file.time;
+
+        if( size != file.size )
+            return false;
+        if( time == int64_t( file.time ))
+            return true;
+
+        // touched, but possibly unchanged
+        file.hash = _hashFile( file.name );
+        if( hash != file.hash )
+            return false;
+        _writeHash( file ); // skip hashing on the next run
+        return true;
+    }
+
+    /* Records the PLY size, time stamp and content hash of a converted
+       model. */
+    static bool _writeHash( const File& file )
+    {
+        std::ofstream hashFile( _getHashFilename( file.name ).c_str( ));
+        hashFile << file.size << " " << int64_t( file.time ) << " "
+                 << std::hex << file.hash << std::endl;
+        return hashFile.good();
+    }
+
+    void _convert( File& file )
+    {
+        if( !_force && _isUpToDate( file ))
+        {
+            lunchbox::ScopedMutex<> mutex( _lock );
+            ++_nSkipped;
+            std::cout << file.name << ": up to date" << std::endl;
+            return;
+        }
+
+        // wait for enough memory, an oversized model runs on its own
+        const uint64_t needed = file.size * MEMORY_FACTOR;
+        {
+            lunchbox::ScopedMutex<> mutex( _reserve );
+            _used.waitLE( needed < _budget ? _budget - needed : 0 );
+            _used += needed;
+        }
+
+        // rebuild stale binary kd-trees instead of reading them
+        ::remove( mesh::getArchitectureFilename( file.name ).c_str( ));
+        ::remove( _getHashFilename( file.name ).c_str( ));
+
+        lunchbox::Clock clock;
+        mesh::VertexBufferRoot* model = new mesh::VertexBufferRoot;
+        if( _optimize )
+            model->useOptimizedData();
+        bool result = model->readFromFile( file.name ) && _isUpToDate( file );
+        delete model;
+        if( result && file.hash == 0 )
+            file.hash = _hashFile( file.name );
+        if( result && file.hash != 0 )
+            result = _writeHash( file );
+        const float time = clock.getTimef();
+
+        _used -= needed;
+
+        lunchbox::ScopedMutex<> mutex( _lock );
+        if( result )
+        {
+            ++_nConverted;
+            _bytes += file.size;
+            const float size = float( file.size ) / LB_1MB;
+            std::cout << file.name << ": " << size << " MB in " << time
+                      << " ms, " << size / time * 1000.f << " MB/s"
+                      << std::endl;
+        }
+        else
+        {
+            ++_nFailed;
+            LBWARN << "Can't convert model: " << file.name << std::endl;
+        }
+    }
+};
 }
 
 int main( const int argc, char** argv )
 {
+    if( argc == 3 && std::string( argv[1] ) == "--benchmark" )
+        return _benchmark( argv[2] );
+    if( argc == 3 && std::string( argv[1] ) == "--distribute" )
+        return _distribute( argc, argv, argv[2] );
+    if( argc == 2 && std::string( argv[1] ) == "--cullBenchmark" )
+        return _benchmarkCulling();
+
+#ifdef _OPENMP
+    size_t nThreads = omp_get_num_procs();
+#else
+    size_t nThreads = 1;
+#endif
+    uint64_t budget = 4096; // MB
+    bool force = false;
+    bool optimize = false;
+
     eq::Strings filenames;
     for( int i=1; i < argc; ++i )
-        filenames.push_back( argv[i] );
+    {
+        const std::string arg = argv[i];
+        if( arg == "--threads" && i+1 < argc )
+            nThreads = LB_MAX( 1, atoi( argv[++i] ));
+        else if( arg == "--memory" && i+1 < argc )
+            budget = LB_MAX( 1, atoi( argv[++i] ));
+        else if( arg == "--force" )
+            force = true;
+        else if( arg == "--optimize" )
+            optimize = true;
+        else
+            filenames.push_back( arg );
+    }
 
+    Batch batch( budget * LB_1MB, force, optimize );
     while( !filenames.empty( ))
     {
         const std::string filename = filenames.back();
         filenames.pop_back();
      
         if( _isPlyfile( filename ))
-        {
-            mesh::VertexBufferRoot* model = new mesh::VertexBufferRoot;
-            if( !model->readFromFile( filename.c_str( )))
-                LBWARN << "Can't load model: " << filename << std::endl;
-
-            delete model;
-        }
+            batch.add( filename );
         else
         {
             const std::string basename = lunchbox::getFilename( filename );
@@ -79,4 +776,6 @@ int main( const int argc, char** argv )
                 filenames.push_back( filename + '/' + *i );
         }
     }
+
+    return batch.run( nThreads ) ? EXIT_SUCCESS : EXIT_FAILURE;
 }